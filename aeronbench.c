@@ -0,0 +1,926 @@
+/* aeronbench.c
+ * Measures the cost of dissecting Aeron frames, by feeding frames built in
+ * memory through the Ethernet/IPv4/UDP/Aeron dissectors without wiretap or
+ * any file I/O.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <config.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <locale.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifdef HAVE_GETOPT_H
+#include <getopt.h>
+#endif
+
+#ifndef HAVE_GETOPT_LONG
+#include "wsutil/wsgetopt.h"
+#endif
+
+#include <glib.h>
+
+#include <epan/epan-int.h>
+#include <epan/packet.h>
+#include <epan/epan.h>
+#include <epan/epan_dissect.h>
+#include <epan/dfilter/dfilter.h>
+#include <epan/timestamp.h>
+#include <epan/prefs.h>
+#include <epan/proto.h>
+#include <epan/tvbuff.h>
+#include <epan/wmem/wmem.h>
+#include <epan/wmem/wmem_allocator.h>
+
+#ifdef HAVE_PLUGINS
+#include <wsutil/plugins.h>
+#endif
+#include <wsutil/filesystem.h>
+#include <wsutil/privileges.h>
+#include <wsutil/report_err.h>
+
+#include <wiretap/wtap.h>
+
+#include "register.h"
+
+#ifdef AERONBENCH_NO_FILTER_SET
+/* Built by tools/aeronbench-compare.sh in a tree from before filter sets;
+   the filters can only be applied one by one there. */
+typedef void dfilter_set_t;
+#define dfilter_set_new()			NULL
+#define dfilter_set_add(set, df)
+#define dfilter_set_reset(set)
+#define dfilter_set_apply_edt(set, idx, edt)	((void)0)
+#define dfilter_set_free(set)
+#endif
+
+static void failure_message(const char *msg_format, va_list ap);
+static void open_failure_message(const char *filename, int err,
+    gboolean for_writing);
+static void read_failure_message(const char *filename, int err);
+static void write_failure_message(const char *filename, int err);
+
+/* The publisher is 10.0.0.1 and the receiver 10.0.0.2. The receiver's
+   port is registered with the Aeron dissector so that no heuristic is
+   involved. */
+#define BENCH_PUBLISHER_PORT	40124
+#define BENCH_RECEIVER_PORT	40123
+#define BENCH_SESSION_ID	0x1234
+#define BENCH_STREAM_ID		1
+#define BENCH_TERM_LENGTH	(64 * 1024)
+#define BENCH_MTU		4096
+#define BENCH_SM_WINDOW		(128 * 1024)
+#define BENCH_FRAGMENTS		3
+
+/* Applications of the display filters (-f) per frame; they are timed
+   together, as one application takes too little time to measure. */
+#define BENCH_FILTER_APPLICATIONS	100
+
+/* The display filters applied by -t, standing in for the tap listeners
+   (-z) of a typical tshark job; several of them load the same fields. */
+static const char *bench_tap_filters[] = {
+	"aeron",
+	"udp",
+	"ip.addr == 10.0.0.1",
+	"ip.addr == 10.0.0.2",
+	"udp.port == 40123",
+	"udp.port == 40124",
+	"aeron.data",
+	"aeron.pad",
+	"aeron.sm",
+	"aeron.nak",
+	"aeron.setup",
+	"aeron.data.session_id == 0x1234",
+	"aeron.data.stream_id == 1",
+	"aeron.data.session_id == 0x1234 && aeron.data.stream_id == 1",
+	"aeron.data.flags.b == 1 && aeron.data.flags.e == 1",
+	"aeron.data.frame_length > 64",
+	"aeron.sm.session_id == 0x1234",
+	"aeron.nak.session_id == 0x1234 && aeron.nak.length > 0",
+	"ip.src == 10.0.0.1 && udp.dstport == 40123 && aeron.data",
+	"frame.len > 100 && aeron"
+};
+
+#define BENCH_ETH_LEN		14
+#define BENCH_IP_LEN		20
+#define BENCH_UDP_LEN		8
+#define BENCH_HDR_LEN		(BENCH_ETH_LEN + BENCH_IP_LEN + BENCH_UDP_LEN)
+
+/* Frame types, as in plugins/aeron/packet-aeron.h, which older trees
+   compared with tools/aeronbench-compare.sh don't have */
+#define BENCH_HDR_TYPE_PAD	0x0000
+#define BENCH_HDR_TYPE_DATA	0x0001
+#define BENCH_HDR_TYPE_NAK	0x0002
+#define BENCH_HDR_TYPE_SM	0x0003
+#define BENCH_HDR_TYPE_SETUP	0x0005
+
+#define BENCH_FLAGS_BEGIN	0x80
+#define BENCH_FLAGS_END		0x40
+
+#define L_BENCH_DATA		24
+#define L_BENCH_NAK		28
+#define L_BENCH_SM		28
+#define L_BENCH_SETUP		36
+
+#define BENCH_ALIGN(len)	(((len) + 7) & ~7)
+#define BENCH_SRC_PORT(from_publisher)	((from_publisher) ? BENCH_PUBLISHER_PORT : BENCH_RECEIVER_PORT)
+#define BENCH_DST_PORT(from_publisher)	((from_publisher) ? BENCH_RECEIVER_PORT : BENCH_PUBLISHER_PORT)
+
+typedef enum {
+	BENCH_DATA,
+	BENCH_DATA_FRAGMENTED,
+	BENCH_PAD,
+	BENCH_SM,
+	BENCH_NAK,
+	BENCH_SETUP,
+	BENCH_TYPE_COUNT
+} bench_type_e;
+
+static const char *bench_type_names[BENCH_TYPE_COUNT] = {
+	"DATA",
+	"DATA (fragmented)",
+	"PAD",
+	"SM",
+	"NAK",
+	"SETUP"
+};
+
+/* Names of the frame types for -y */
+static const char *bench_type_options[BENCH_TYPE_COUNT] = {
+	"data",
+	"data-fragmented",
+	"pad",
+	"sm",
+	"nak",
+	"setup"
+};
+
+/* The analysis preferences of each measured configuration */
+typedef struct {
+	const char *name;
+	gboolean sequence_analysis;
+	gboolean stream_analysis;
+	gboolean reassemble_fragments;
+} bench_config_t;
+
+static const bench_config_t bench_configs[] = {
+	{ "none",	FALSE,	FALSE,	FALSE },
+	{ "seq",	TRUE,	FALSE,	FALSE },
+	{ "seq+stream",	TRUE,	TRUE,	FALSE },
+	{ "seq+stream+reasm",	TRUE,	TRUE,	TRUE }
+};
+
+/* A set of complete frames, built before anything is timed */
+typedef struct {
+	guint8	*data;
+	guint32	*offset;
+	guint32	*length;
+	guint	count;
+} bench_frames_t;
+
+typedef struct {
+	guint64	elapsed_ns;
+	guint64	allocs;
+	guint64	alloc_bytes;
+	guint64	file_bytes;	/* Part of alloc_bytes kept until the file is closed */
+	guint64	filter_ns;	/* Time spent applying the display filters one by one */
+	guint64	set_ns;		/* Time spent applying them as a filter set */
+	guint	matched;	/* Frames which passed any display filter */
+} bench_result_t;
+
+/*
+ * Allocation counting. The consumer functions of the packet and file
+ * scope allocators are interposed, so every wmem_alloc()/wmem_realloc()
+ * made while dissecting is counted; GLib allocations are not.
+ */
+#define BENCH_SCOPE_PACKET	0
+#define BENCH_SCOPE_FILE	1
+#define BENCH_SCOPE_COUNT	2
+
+static wmem_allocator_t *bench_scopes[BENCH_SCOPE_COUNT];
+static void *(*bench_scope_alloc[BENCH_SCOPE_COUNT])(void *private_data, const size_t size);
+static void *(*bench_scope_realloc[BENCH_SCOPE_COUNT])(void *private_data, void *ptr, const size_t size);
+static guint64 bench_allocs;
+static guint64 bench_alloc_bytes;
+static guint64 bench_file_bytes;
+
+static int
+bench_scope_index(void *private_data)
+{
+	return (private_data == bench_scopes[BENCH_SCOPE_PACKET]->private_data) ? BENCH_SCOPE_PACKET : BENCH_SCOPE_FILE;
+}
+
+static void *
+bench_counting_alloc(void *private_data, const size_t size)
+{
+	int scope = bench_scope_index(private_data);
+
+	bench_allocs++;
+	bench_alloc_bytes += size;
+	if (scope == BENCH_SCOPE_FILE)
+		bench_file_bytes += size;
+	return bench_scope_alloc[scope](private_data, size);
+}
+
+static void *
+bench_counting_realloc(void *private_data, void *ptr, const size_t size)
+{
+	int scope = bench_scope_index(private_data);
+
+	bench_allocs++;
+	bench_alloc_bytes += size;
+	if (scope == BENCH_SCOPE_FILE)
+		bench_file_bytes += size;
+	return bench_scope_realloc[scope](private_data, ptr, size);
+}
+
+static void
+bench_count_allocations(void)
+{
+	int idx;
+
+	bench_scopes[BENCH_SCOPE_PACKET] = wmem_packet_scope();
+	bench_scopes[BENCH_SCOPE_FILE] = wmem_file_scope();
+	for (idx = 0; idx < BENCH_SCOPE_COUNT; idx++) {
+		bench_scope_alloc[idx] = bench_scopes[idx]->alloc;
+		bench_scope_realloc[idx] = bench_scopes[idx]->realloc;
+		bench_scopes[idx]->alloc = bench_counting_alloc;
+		bench_scopes[idx]->realloc = bench_counting_realloc;
+	}
+}
+
+static guint64
+bench_now_ns(void)
+{
+	return (guint64)g_get_monotonic_time() * 1000;
+}
+
+/*
+ * Frame construction.
+ */
+static guint8 *
+bench_frame_add(bench_frames_t *frames, guint *used, guint aeron_length,
+    gboolean from_publisher)
+{
+	guint8 *frame = frames->data + *used;
+	guint16 ip_length = BENCH_IP_LEN + BENCH_UDP_LEN + aeron_length;
+	guint32 sum = 0;
+	int idx;
+
+	frames->offset[frames->count] = *used;
+	frames->length[frames->count] = BENCH_HDR_LEN + aeron_length;
+	frames->count++;
+	*used += BENCH_HDR_LEN + aeron_length;
+	memset(frame, 0, BENCH_HDR_LEN + aeron_length);
+
+	/* Ethernet */
+	frame[5] = from_publisher ? 0x02 : 0x01;
+	frame[11] = from_publisher ? 0x01 : 0x02;
+	frame[12] = 0x08;
+	frame[13] = 0x00;
+
+	/* IPv4 */
+	frame[14] = 0x45;
+	frame[16] = ip_length >> 8;
+	frame[17] = ip_length & 0xff;
+	frame[20] = 0x40;
+	frame[22] = 64;
+	frame[23] = 17;
+	frame[26] = 10;
+	frame[29] = from_publisher ? 1 : 2;
+	frame[30] = 10;
+	frame[33] = from_publisher ? 2 : 1;
+	for (idx = 0; idx < BENCH_IP_LEN; idx += 2)
+		sum += (frame[14 + idx] << 8) | frame[15 + idx];
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	frame[24] = (~sum >> 8) & 0xff;
+	frame[25] = ~sum & 0xff;
+
+	/* UDP, without a checksum */
+	frame[34] = BENCH_SRC_PORT(from_publisher) >> 8;
+	frame[35] = BENCH_SRC_PORT(from_publisher) & 0xff;
+	frame[36] = BENCH_DST_PORT(from_publisher) >> 8;
+	frame[37] = BENCH_DST_PORT(from_publisher) & 0xff;
+	frame[38] = (BENCH_UDP_LEN + aeron_length) >> 8;
+	frame[39] = (BENCH_UDP_LEN + aeron_length) & 0xff;
+
+	return (frame + BENCH_HDR_LEN);
+}
+
+static void
+bench_put_le16(guint8 *ptr, guint16 value)
+{
+	ptr[0] = value & 0xff;
+	ptr[1] = value >> 8;
+}
+
+static void
+bench_put_le32(guint8 *ptr, guint32 value)
+{
+	ptr[0] = value & 0xff;
+	ptr[1] = (value >> 8) & 0xff;
+	ptr[2] = (value >> 16) & 0xff;
+	ptr[3] = value >> 24;
+}
+
+static void
+bench_put_header(guint8 *aeron, guint8 flags, guint16 type, guint32 frame_length)
+{
+	aeron[1] = flags;
+	bench_put_le16(aeron + 2, type);
+	bench_put_le32(aeron + 4, frame_length);
+}
+
+/* Advance a term position by one aligned frame, moving to the next term
+   when the frame would not fit in the current one. */
+static void
+bench_advance(guint32 *term_id, guint32 *term_offset, guint32 length)
+{
+	*term_offset += BENCH_ALIGN(length);
+	if (*term_offset + BENCH_ALIGN(length) > BENCH_TERM_LENGTH) {
+		(*term_id)++;
+		*term_offset = 0;
+	}
+}
+
+static void
+bench_frames_build(bench_frames_t *frames, bench_type_e type, guint count,
+    guint payload_length)
+{
+	guint32 frame_length = L_BENCH_DATA + payload_length;
+	guint max_aeron = MAX(L_BENCH_SETUP, frame_length);
+	guint32 term_id = 0;
+	guint32 term_offset = 0;
+	guint used = 0;
+	guint8 *aeron;
+	guint idx;
+
+	frames->data = (guint8 *)g_malloc(count * (BENCH_HDR_LEN + max_aeron));
+	frames->offset = g_new(guint32, count);
+	frames->length = g_new(guint32, count);
+	frames->count = 0;
+
+	for (idx = 0; idx < count; idx++) {
+		switch (type) {
+		case BENCH_DATA:
+		case BENCH_DATA_FRAGMENTED:
+		case BENCH_PAD:
+			aeron = bench_frame_add(frames, &used, frame_length, TRUE);
+			if (type == BENCH_PAD) {
+				bench_put_header(aeron, 0, BENCH_HDR_TYPE_PAD, frame_length);
+			} else if (type == BENCH_DATA) {
+				bench_put_header(aeron, BENCH_FLAGS_BEGIN | BENCH_FLAGS_END, BENCH_HDR_TYPE_DATA, frame_length);
+			} else {
+				guint fragment = idx % BENCH_FRAGMENTS;
+				guint8 flags = 0;
+
+				/* Start each message at the beginning of a term
+				   if all its fragments do not fit in this one */
+				if ((fragment == 0) && (term_offset + BENCH_FRAGMENTS * BENCH_ALIGN(frame_length) > BENCH_TERM_LENGTH)) {
+					term_id++;
+					term_offset = 0;
+				}
+				if (fragment == 0)
+					flags |= BENCH_FLAGS_BEGIN;
+				if (fragment == BENCH_FRAGMENTS - 1)
+					flags |= BENCH_FLAGS_END;
+				bench_put_header(aeron, flags, BENCH_HDR_TYPE_DATA, frame_length);
+			}
+			bench_put_le32(aeron + 8, term_offset);
+			bench_put_le32(aeron + 12, BENCH_SESSION_ID);
+			bench_put_le32(aeron + 16, BENCH_STREAM_ID);
+			bench_put_le32(aeron + 20, term_id);
+			memset(aeron + L_BENCH_DATA, (int)(idx & 0xff), payload_length);
+			if (type == BENCH_DATA_FRAGMENTED) {
+				term_offset += BENCH_ALIGN(frame_length);
+			} else {
+				bench_advance(&term_id, &term_offset, frame_length);
+			}
+			break;
+
+		case BENCH_SM:
+			aeron = bench_frame_add(frames, &used, L_BENCH_SM, FALSE);
+			bench_put_header(aeron, 0, BENCH_HDR_TYPE_SM, L_BENCH_SM);
+			bench_put_le32(aeron + 8, BENCH_SESSION_ID);
+			bench_put_le32(aeron + 12, BENCH_STREAM_ID);
+			bench_put_le32(aeron + 16, term_id);
+			bench_put_le32(aeron + 20, term_offset);
+			bench_put_le32(aeron + 24, BENCH_SM_WINDOW);
+			bench_advance(&term_id, &term_offset, BENCH_MTU);
+			break;
+
+		case BENCH_NAK:
+			aeron = bench_frame_add(frames, &used, L_BENCH_NAK, FALSE);
+			bench_put_header(aeron, 0, BENCH_HDR_TYPE_NAK, L_BENCH_NAK);
+			bench_put_le32(aeron + 8, BENCH_SESSION_ID);
+			bench_put_le32(aeron + 12, BENCH_STREAM_ID);
+			bench_put_le32(aeron + 16, term_id);
+			bench_put_le32(aeron + 20, term_offset);
+			bench_put_le32(aeron + 24, BENCH_MTU);
+			bench_advance(&term_id, &term_offset, BENCH_MTU);
+			break;
+
+		case BENCH_SETUP:
+		default:
+			aeron = bench_frame_add(frames, &used, L_BENCH_SETUP, TRUE);
+			bench_put_header(aeron, 0, BENCH_HDR_TYPE_SETUP, L_BENCH_SETUP);
+			bench_put_le32(aeron + 8, term_offset);
+			bench_put_le32(aeron + 12, BENCH_SESSION_ID);
+			bench_put_le32(aeron + 16, BENCH_STREAM_ID);
+			bench_put_le32(aeron + 20, 0);
+			bench_put_le32(aeron + 24, term_id);
+			bench_put_le32(aeron + 28, BENCH_TERM_LENGTH);
+			bench_put_le32(aeron + 32, BENCH_MTU);
+			bench_advance(&term_id, &term_offset, BENCH_MTU);
+			break;
+		}
+	}
+}
+
+static void
+bench_frames_free(bench_frames_t *frames)
+{
+	g_free(frames->data);
+	g_free(frames->offset);
+	g_free(frames->length);
+}
+
+/*
+ * Dissection.
+ */
+static const nstime_t *
+bench_get_frame_ts(void *data _U_, guint32 frame_num _U_)
+{
+	return NULL;
+}
+
+static epan_t *
+bench_epan_new(void)
+{
+	epan_t *epan = epan_new();
+
+	epan->data = NULL;
+	epan->get_frame_ts = bench_get_frame_ts;
+	epan->get_interface_name = NULL;
+	epan->get_user_comment = NULL;
+
+	return epan;
+}
+
+static void
+bench_set_pref(const char *name, const char *value)
+{
+	char *prefarg = g_strdup_printf("aeron.%s:%s", name, value);
+
+	if (prefs_set_pref(prefarg) != PREFS_SET_OK) {
+		fprintf(stderr, "aeronbench: Can't set preference \"%s\".\n",
+			prefarg);
+		exit(1);
+	}
+	g_free(prefarg);
+}
+
+static void
+bench_configure(const bench_config_t *config)
+{
+	bench_set_pref("sequence_analysis", config->sequence_analysis ? "TRUE" : "FALSE");
+	bench_set_pref("stream_analysis", config->stream_analysis ? "TRUE" : "FALSE");
+	bench_set_pref("reassemble_fragments", config->reassemble_fragments ? "TRUE" : "FALSE");
+	prefs_apply_all();
+}
+
+/* Dissect every frame once, in a new session, as a first pass would.
+   With display filters, the tree is primed with their fields and the
+   filters are applied to every frame, both one by one, as separate
+   tap listeners used to be, and as a filter set. */
+static void
+bench_run(const bench_frames_t *frames, gboolean create_tree,
+    GPtrArray *filters, dfilter_set_t *filter_set, bench_result_t *result)
+{
+	epan_t *session;
+	epan_dissect_t edt;
+	struct wtap_pkthdr phdr;
+	frame_data fdata;
+	frame_data ref_frame;
+	frame_data prev_dis_frame;
+	const frame_data *ref = NULL;
+	const frame_data *prev_dis = NULL;
+	nstime_t elapsed_time;
+	guint32 cum_bytes = 0;
+	guint64 start;
+	guint64 allocs;
+	guint64 alloc_bytes;
+	guint64 file_bytes;
+	guint64 filter_start;
+	guint idx;
+	guint application;
+	guint filter;
+	gboolean matched;
+
+	session = bench_epan_new();
+	epan_dissect_init(&edt, session, create_tree || (filters->len != 0), FALSE);
+	memset(&phdr, 0, sizeof(phdr));
+	phdr.rec_type = REC_TYPE_PACKET;
+	phdr.presence_flags = WTAP_HAS_TS;
+	phdr.pkt_encap = WTAP_ENCAP_ETHERNET;
+	phdr.pkt_tsprec = WTAP_TSPREC_NSEC;
+	nstime_set_zero(&elapsed_time);
+
+	allocs = bench_allocs;
+	alloc_bytes = bench_alloc_bytes;
+	file_bytes = bench_file_bytes;
+	result->filter_ns = 0;
+	result->set_ns = 0;
+	result->matched = 0;
+	start = bench_now_ns();
+	for (idx = 0; idx < frames->count; idx++) {
+		/* One frame per microsecond */
+		phdr.ts.secs = 1000000000 + idx / 1000000;
+		phdr.ts.nsecs = (idx % 1000000) * 1000;
+		phdr.caplen = frames->length[idx];
+		phdr.len = frames->length[idx];
+
+		frame_data_init(&fdata, idx + 1, &phdr, frames->offset[idx], cum_bytes);
+		frame_data_set_before_dissect(&fdata, &elapsed_time, &ref, prev_dis);
+		if (ref == &fdata) {
+			ref_frame = fdata;
+			ref = &ref_frame;
+		}
+		for (filter = 0; filter < filters->len; filter++)
+			epan_dissect_prime_dfilter(&edt, (dfilter_t *)g_ptr_array_index(filters, filter));
+		epan_dissect_run(&edt, WTAP_FILE_TYPE_SUBTYPE_UNKNOWN, &phdr,
+			tvb_new_real_data(frames->data + frames->offset[idx],
+				frames->length[idx], frames->length[idx]),
+			&fdata, NULL);
+		if (filters->len != 0) {
+			matched = FALSE;
+			for (filter = 0; filter < filters->len; filter++)
+				matched |= dfilter_apply_edt((dfilter_t *)g_ptr_array_index(filters, filter), &edt);
+			if (matched)
+				result->matched++;
+
+			filter_start = bench_now_ns();
+			for (application = 0; application < BENCH_FILTER_APPLICATIONS; application++) {
+				for (filter = 0; filter < filters->len; filter++)
+					dfilter_apply_edt((dfilter_t *)g_ptr_array_index(filters, filter), &edt);
+			}
+			result->filter_ns += bench_now_ns() - filter_start;
+
+			if (filter_set != NULL) {
+				filter_start = bench_now_ns();
+				for (application = 0; application < BENCH_FILTER_APPLICATIONS; application++) {
+					dfilter_set_reset(filter_set);
+					for (filter = 0; filter < filters->len; filter++)
+						dfilter_set_apply_edt(filter_set, filter, &edt);
+				}
+				result->set_ns += bench_now_ns() - filter_start;
+			}
+		}
+		frame_data_set_after_dissect(&fdata, &cum_bytes);
+		prev_dis_frame = fdata;
+		prev_dis = &prev_dis_frame;
+		epan_dissect_reset(&edt);
+		frame_data_destroy(&fdata);
+	}
+	/* The timed filter applications are not part of the dissection */
+	result->elapsed_ns = bench_now_ns() - start - result->filter_ns - result->set_ns;
+	result->allocs = bench_allocs - allocs;
+	result->alloc_bytes = bench_alloc_bytes - alloc_bytes;
+	result->file_bytes = bench_file_bytes - file_bytes;
+
+	epan_dissect_cleanup(&edt);
+	epan_free(session);
+}
+
+static void
+usage(gboolean is_error)
+{
+	FILE *output;
+
+	if (!is_error)
+		output = stdout;
+	else
+		output = stderr;
+
+	fprintf(output, "Usage: aeronbench [-c <count>] [-f <filter>]... [-r <runs>] [-s <size>] [-T]\n");
+	fprintf(output, "                  [-t] [-y <type>]\n");
+	fprintf(output, "Dissects Aeron frames built in memory and reports the cost per frame.\n");
+	fprintf(output, "\n");
+	fprintf(output, "  -c <count>  frames dissected per run (default 20000)\n");
+	fprintf(output, "  -f <filter> apply this display filter to every frame (may be repeated),\n");
+	fprintf(output, "              and report the cost of applying all the filters one by one\n");
+	fprintf(output, "              and as a filter set (%u times per frame)\n", BENCH_FILTER_APPLICATIONS);
+	fprintf(output, "  -r <runs>   runs of each measurement; the fastest is reported (default 5)\n");
+	fprintf(output, "  -s <size>   DATA and PAD payload size in bytes (default 64)\n");
+	fprintf(output, "  -t          apply %u display filters such as tap listeners would use,\n", (guint)G_N_ELEMENTS(bench_tap_filters));
+	fprintf(output, "              as if each one were given with -f\n");
+	fprintf(output, "  -T          build the protocol tree\n");
+	fprintf(output, "  -y <type>   only measure frames of this type: data, data-fragmented,\n");
+	fprintf(output, "              pad, sm, nak or setup (default all of them)\n");
+
+	exit(is_error ? 1 : 0);
+}
+
+int
+main(int argc, char **argv)
+{
+	char		*init_progfile_dir_error;
+	char		*gpf_path, *pf_path;
+	int		gpf_open_errno, gpf_read_errno;
+	int		pf_open_errno, pf_read_errno;
+	int		opt;
+	guint		count = 20000;
+	guint		runs = 5;
+	guint		payload_length = 64;
+	gboolean	create_tree = FALSE;
+	GPtrArray	*filter_texts = g_ptr_array_new();
+	GPtrArray	*filters = g_ptr_array_new();
+	dfilter_set_t	*filter_set = dfilter_set_new();
+	dfilter_t	*filter;
+	gchar		*err_msg;
+	GSList		*handles;
+	dissector_handle_t	aeron_handle = NULL;
+	int		type;
+	int		only_type = -1;
+	guint		config;
+	guint		run;
+	guint		idx;
+DIAG_OFF(cast-qual)
+	static const struct option long_options[] = {
+		{(char *)"help", no_argument, NULL, 'h'},
+		{0, 0, 0, 0 }
+	};
+DIAG_ON(cast-qual)
+
+	while ((opt = getopt_long(argc, argv, "c:f:hr:s:tTy:", long_options, NULL)) != -1) {
+		switch (opt) {
+			case 'c':	/* frames per run */
+				count = (guint)strtoul(optarg, NULL, 10);
+				break;
+
+			case 'f':	/* display filter */
+				g_ptr_array_add(filter_texts, optarg);
+				break;
+
+			case 'r':	/* runs */
+				runs = (guint)strtoul(optarg, NULL, 10);
+				break;
+
+			case 's':	/* payload size */
+				payload_length = (guint)strtoul(optarg, NULL, 10);
+				if (payload_length > BENCH_MTU - L_BENCH_DATA) {
+					fprintf(stderr,
+					    "aeronbench: Max payload size is %u\n",
+					    BENCH_MTU - L_BENCH_DATA);
+					exit(1);
+				}
+				break;
+
+			case 't':	/* tap listener filters */
+DIAG_OFF(cast-qual)
+				for (idx = 0; idx < G_N_ELEMENTS(bench_tap_filters); idx++)
+					g_ptr_array_add(filter_texts, (gpointer)bench_tap_filters[idx]);
+DIAG_ON(cast-qual)
+				break;
+
+			case 'T':	/* protocol tree */
+				create_tree = TRUE;
+				break;
+
+			case 'y':	/* frame type */
+				for (type = 0; type < BENCH_TYPE_COUNT; type++) {
+					if (strcmp(optarg, bench_type_options[type]) == 0)
+						break;
+				}
+				if (type == BENCH_TYPE_COUNT) {
+					fprintf(stderr,
+					    "aeronbench: Unknown frame type \"%s\"\n",
+					    optarg);
+					exit(1);
+				}
+				only_type = type;
+				break;
+
+			case 'h':
+				usage(FALSE);
+				break;
+			default:
+				usage(TRUE);
+				break;
+		}
+	}
+	if ((count == 0) || (runs == 0))
+		usage(TRUE);
+
+	/*
+	 * Get credential information for later use.
+	 */
+	init_process_policies();
+
+	/*
+	 * Attempt to get the pathname of the executable file.
+	 */
+	init_progfile_dir_error = init_progfile_dir(argv[0], (void *)main);
+	if (init_progfile_dir_error != NULL) {
+		fprintf(stderr, "aeronbench: Can't get pathname of aeronbench program: %s.\n",
+			init_progfile_dir_error);
+	}
+
+	init_report_err(failure_message, open_failure_message,
+			read_failure_message, write_failure_message);
+
+	timestamp_set_type(TS_RELATIVE);
+	timestamp_set_seconds_type(TS_SECONDS_DEFAULT);
+
+#ifdef HAVE_PLUGINS
+	/* Register all the plugin types we have. */
+	epan_register_plugin_types(); /* Types known to libwireshark */
+
+	/* Scan for plugins.  This does *not* call their registration routines;
+	   that's done later. */
+	scan_plugins();
+#endif
+
+	epan_init(register_all_protocols, register_all_protocol_handoffs,
+		  NULL, NULL);
+
+	/* set the c-language locale to the native environment. */
+	setlocale(LC_ALL, "");
+
+	read_prefs(&gpf_open_errno, &gpf_read_errno, &gpf_path,
+		&pf_open_errno, &pf_read_errno, &pf_path);
+
+	if (proto_get_id_by_filter_name("aeron") == -1) {
+		fprintf(stderr, "aeronbench: The Aeron plugin is not loaded.\n");
+		epan_cleanup();
+		exit(2);
+	}
+
+	/* Decode the receiver port as Aeron, as "Decode As" would, rather
+	   than relying on the UDP heuristic; unlike the "udp_ports"
+	   preference, this also works in the older trees. Keep reassembled
+	   payloads out of the subdissectors. */
+	for (handles = dissector_table_get_dissector_handles(find_dissector_table("udp.port"));
+	     handles != NULL; handles = g_slist_next(handles)) {
+		if (dissector_handle_get_protocol_index((dissector_handle_t)handles->data) == proto_get_id_by_filter_name("aeron"))
+			aeron_handle = (dissector_handle_t)handles->data;
+	}
+	if (aeron_handle == NULL) {
+		fprintf(stderr, "aeronbench: Aeron can't be decoded as UDP.\n");
+		epan_cleanup();
+		exit(2);
+	}
+	dissector_change_uint("udp.port", BENCH_RECEIVER_PORT, aeron_handle);
+	bench_set_pref("use_heuristic_subdissectors", "FALSE");
+
+	for (idx = 0; idx < filter_texts->len; idx++) {
+		if (!dfilter_compile((const char *)g_ptr_array_index(filter_texts, idx), &filter, &err_msg)) {
+			fprintf(stderr, "aeronbench: %s\n", err_msg);
+			g_free(err_msg);
+			epan_cleanup();
+			exit(2);
+		}
+		if (filter) {
+			g_ptr_array_add(filters, filter);
+			dfilter_set_add(filter_set, filter);
+		}
+	}
+
+	bench_count_allocations();
+
+	printf("Frames per run: %u, runs: %u, payload size: %u, protocol tree: %s\n",
+	       count, runs, payload_length, create_tree ? "yes" : "no");
+	for (idx = 0; idx < filter_texts->len; idx++)
+		printf("Display filter: %s\n", (const char *)g_ptr_array_index(filter_texts, idx));
+	printf("Allocations are wmem packet and file scope allocations; file bytes\n");
+	printf("are the file scope part, which is kept until the file is closed.\n\n");
+	printf("%-18s %-17s %12s %14s %14s %14s",
+	       "Frame type", "Analysis", "ns/frame", "allocs/frame", "bytes/frame",
+	       "file bytes");
+	if (filters->len != 0)
+		printf(" %12s %12s %8s", "filter ns", "set ns", "matched");
+	printf("\n");
+
+	for (type = 0; type < BENCH_TYPE_COUNT; type++) {
+		bench_frames_t frames;
+
+		if ((only_type != -1) && (type != only_type))
+			continue;
+		bench_frames_build(&frames, (bench_type_e)type, count, payload_length);
+		for (config = 0; config < G_N_ELEMENTS(bench_configs); config++) {
+			bench_result_t best;
+
+			memset(&best, 0, sizeof(best));
+			bench_configure(&bench_configs[config]);
+			for (run = 0; run < runs; run++) {
+				bench_result_t result;
+
+				bench_run(&frames, create_tree, filters, filter_set, &result);
+				if ((run == 0) || (result.elapsed_ns < best.elapsed_ns))
+					best = result;
+			}
+			printf("%-18s %-17s %12.1f %14.2f %14.1f %14.1f",
+			       bench_type_names[type], bench_configs[config].name,
+			       (double)best.elapsed_ns / frames.count,
+			       (double)best.allocs / frames.count,
+			       (double)best.alloc_bytes / frames.count,
+			       (double)best.file_bytes / frames.count);
+			if (filters->len != 0)
+				printf(" %12.1f %12.1f %8u",
+				       (double)best.filter_ns / ((guint64)frames.count * BENCH_FILTER_APPLICATIONS),
+				       (double)best.set_ns / ((guint64)frames.count * BENCH_FILTER_APPLICATIONS),
+				       best.matched);
+			printf("\n");
+		}
+		bench_frames_free(&frames);
+	}
+
+	dfilter_set_free(filter_set);
+	for (idx = 0; idx < filters->len; idx++)
+		dfilter_free((dfilter_t *)g_ptr_array_index(filters, idx));
+	g_ptr_array_free(filters, TRUE);
+	g_ptr_array_free(filter_texts, TRUE);
+	epan_cleanup();
+
+	exit(0);
+}
+
+/*
+ * General errors are reported with an console message in "aeronbench".
+ */
+static void
+failure_message(const char *msg_format, va_list ap)
+{
+	fprintf(stderr, "aeronbench: ");
+	vfprintf(stderr, msg_format, ap);
+	fprintf(stderr, "\n");
+}
+
+/*
+ * Open/create errors are reported with an console message in "aeronbench".
+ */
+static void
+open_failure_message(const char *filename, int err, gboolean for_writing)
+{
+	fprintf(stderr, "aeronbench: ");
+	fprintf(stderr, file_open_error_message(err, for_writing), filename);
+	fprintf(stderr, "\n");
+}
+
+/*
+ * Read errors are reported with an console message in "aeronbench".
+ */
+static void
+read_failure_message(const char *filename, int err)
+{
+	fprintf(stderr, "aeronbench: An error occurred while reading from the file \"%s\": %s.\n",
+		filename, g_strerror(err));
+}
+
+/*
+ * Write errors are reported with an console message in "aeronbench".
+ */
+static void
+write_failure_message(const char *filename, int err)
+{
+	fprintf(stderr, "aeronbench: An error occurred while writing to the file \"%s\": %s.\n",
+		filename, g_strerror(err));
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
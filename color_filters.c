@@ -58,6 +58,12 @@ static GSList *color_filter_list = NULL;
 static GSList *color_filter_deleted_list = NULL;
 static GSList *color_filter_valid_list   = NULL;
 
+/* The compiled filters of color_filter_list, in list order, applied
+ * together so that the fields they share are read once per packet.
+ * Rebuilt when the list or its filters change. */
+static dfilter_set_t *color_filter_set = NULL;
+static gboolean color_filter_set_dirty = TRUE;
+
 /* Color Filters can en-/disabled. */
 static gboolean filters_enabled = TRUE;
 
@@ -183,6 +189,7 @@ color_filters_set_tmp(guint8 filt_nr, gchar *filter, gboolean disabled)
                     dfilter_free(colorf->c_colorfilter);
                 colorf->filter_text = g_strdup(tmpfilter);
                 colorf->c_colorfilter = compiled_filter;
+                color_filter_set_dirty = TRUE;
                 colorf->disabled = ((i!=filt_nr) ? TRUE : disabled);
                 /* Remember that there are now temporary coloring filters set */
                 if( filter )
@@ -293,6 +300,8 @@ color_filters_init(void)
     if (!read_users_filters(&color_filter_list))
         /* if that failed, try to read the global filters */
         color_filters_read_globals(&color_filter_list);
+
+    color_filter_set_dirty = TRUE;
 }
 
 void
@@ -310,6 +319,8 @@ color_filters_reload(void)
     if (!read_users_filters(&color_filter_list))
         /* if that failed, try to read the global filters */
         color_filters_read_globals(&color_filter_list);
+
+    color_filter_set_dirty = TRUE;
 }
 
 void
@@ -317,6 +328,11 @@ color_filters_cleanup(void)
 {
     /* delete the previously deleted filters */
     color_filter_list_delete(&color_filter_deleted_list);
+
+    /* the set may still refer to them; it's rebuilt on the next packet */
+    dfilter_set_free(color_filter_set);
+    color_filter_set = NULL;
+    color_filter_set_dirty = TRUE;
 }
 
 static void
@@ -392,6 +408,7 @@ color_filters_apply(GSList *tmp_cfl, GSList *edit_cfl)
 
     /* compile all filter */
     g_slist_foreach(color_filter_list, color_filter_compile_cb, NULL);
+    color_filter_set_dirty = TRUE;
 }
 
 gboolean
@@ -433,23 +450,47 @@ color_filters_prime_edt(epan_dissect_t *edt)
         g_slist_foreach(color_filter_list, prime_edt, edt);
 }
 
+static void
+color_filters_build_set(void)
+{
+    GSList         *curr;
+    color_filter_t *colorf;
+
+    dfilter_set_free(color_filter_set);
+    color_filter_set = dfilter_set_new();
+    for (curr = color_filter_list; curr != NULL; curr = g_slist_next(curr)) {
+        colorf = (color_filter_t *)curr->data;
+        if (colorf->c_colorfilter != NULL)
+            dfilter_set_add(color_filter_set, colorf->c_colorfilter);
+    }
+    color_filter_set_dirty = FALSE;
+}
+
 /* * Return the color_t for later use */
 const color_filter_t *
 color_filters_colorize_packet(epan_dissect_t *edt)
 {
     GSList         *curr;
     color_filter_t *colorf;
+    int             filter_idx = 0;
 
     /* If we have color filters, "search" for the matching one. */
     if (color_filters_used()) {
+        if (color_filter_set_dirty)
+            color_filters_build_set();
+        dfilter_set_reset(color_filter_set);
+
         curr = color_filter_list;
 
         while(curr != NULL) {
             colorf = (color_filter_t *)curr->data;
-            if ( (!colorf->disabled) &&
-                 (colorf->c_colorfilter != NULL) &&
-                 dfilter_apply_edt(colorf->c_colorfilter, edt)) {
-                return colorf;
+            if (colorf->c_colorfilter != NULL) {
+                /* The set has an entry for every compiled filter, disabled or not */
+                if ( (!colorf->disabled) &&
+                     dfilter_set_apply_edt(color_filter_set, filter_idx, edt)) {
+                    return colorf;
+                }
+                filter_idx++;
             }
             curr = g_slist_next(curr);
         }
@@ -27,17 +27,55 @@
 #include <epan/proto.h>
 #include <stdio.h>
 
+/* A register of the display filter VM. A register loaded from the tree
+ * refers to the field_info array of the field in place; other registers
+ * hold their values in an array which is kept, and reused, from one run
+ * of the dfilter to the next. */
+typedef struct {
+	field_info	**finfos;	/* Loaded fields, or NULL to use values */
+	fvalue_t	**values;
+	guint		len;
+	guint		size;		/* Allocated length of values */
+	gboolean	owned;		/* Free the values when the register is cleared */
+} df_register_t;
+
+#define DF_REGISTER_VALUE(reg, i) \
+	((reg)->finfos ? &(reg)->finfos[i]->value : (reg)->values[i])
+
 /* Passed back to user */
 struct epan_dfilter {
 	GPtrArray	*insns;
 	GPtrArray	*consts;
 	guint		num_registers;
 	guint		max_registers;
-	GList		**registers;
+	df_register_t	*registers;
 	gboolean	*attempted_load;
 	int		*interesting_fields;
 	int		num_interesting_fields;
 	GPtrArray	*deprecated;
+	gchar		*text;		/* Filter text, after macro expansion */
+};
+
+/* A field loaded once per tree for all the filters of a set */
+typedef struct {
+	header_field_info	*hfinfo;
+	df_register_t		reg;
+	guint			generation;	/* Set generation in which reg was loaded */
+} df_set_field_t;
+
+typedef struct {
+	dfilter_t	*df;
+	int		*insn_field;	/* Set field of each READ_TREE or CHECK_EXISTS insn, else -1 */
+	int		same_as;	/* Earlier member with the same filter text, or -1 */
+	guint		generation;	/* Set generation in which result was found */
+	gboolean	result;
+} df_set_member_t;
+
+struct epan_dfilter_set {
+	GArray		*members;	/* df_set_member_t */
+	GArray		*fields;	/* df_set_field_t */
+	GHashTable	*field_ids;	/* Index + 1 in fields, by hf ID */
+	guint		generation;	/* Incremented for every tree */
 };
 
 typedef struct {
@@ -21,11 +21,13 @@
 #include "config.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "dfilter-int.h"
 #include "syntax-tree.h"
 #include "gencode.h"
+#include "optimize.h"
 #include "semcheck.h"
 #include "dfvm.h"
 #include <epan/epan_dissect.h>
@@ -147,9 +149,7 @@ dfilter_free(dfilter_t *df)
 
 	/* clear registers */
 	for (i = 0; i < df->max_registers; i++) {
-		if (df->registers[i]) {
-			g_list_free(df->registers[i]);
-		}
+		dfvm_register_free(&df->registers[i]);
 	}
 
 	if (df->deprecated) {
@@ -162,6 +162,7 @@ dfilter_free(dfilter_t *df)
 
 	g_free(df->registers);
 	g_free(df->attempted_load);
+	g_free(df->text);
 	g_free(df);
 }
 
@@ -207,43 +208,18 @@ dfwork_free(dfwork_t *dfw)
 	g_free(dfw);
 }
 
-gboolean
-dfilter_compile(const gchar *text, dfilter_t **dfp, gchar **err_msg)
+/* Parse a filter into dfw->st_root, and check and optimize it. The
+ * caller sets global_dfw to dfw. An empty filter leaves st_root NULL. */
+static gboolean
+dfwork_build(dfwork_t *dfw, const gchar *text, GPtrArray *deprecated)
 {
 	int		token;
-	dfilter_t	*dfilter;
-	dfwork_t	*dfw;
 	gboolean failure = FALSE;
 	const char	*depr_test;
 	guint		i;
-	/* XXX, GHashTable */
-	GPtrArray	*deprecated;
-
-	g_assert(dfp);
-
-	if (!text) {
-		*dfp = NULL;
-		if (err_msg != NULL)
-			*err_msg = g_strdup("BUG: NULL text pointer passed to dfilter_compile()");
-		return FALSE;
-	}
-
-	if ( !( text = dfilter_macro_apply(text, err_msg) ) ) {
-		return FALSE;
-	}
-
-	dfw = dfwork_new();
-
-	/*
-	 * XXX - if we're using a version of Flex that supports reentrant lexical
-	 * analyzers, we should put this into the lexical analyzer's state.
-	 */
-	global_dfw = dfw;
 
 	df_scanner_text(text);
 
-	deprecated = g_ptr_array_new();
-
 	while (1) {
 		df_lval = stnode_new(STTYPE_UNINITIALIZED, NULL);
 		token = df_lex();
@@ -310,6 +286,55 @@ dfilter_compile(const gchar *text, dfilter_t **dfp, gchar **err_msg)
 	df_scanner_cleanup();
 
 	if (failure)
+		return FALSE;
+
+	if (dfw->st_root == NULL)
+		return TRUE;
+
+	/* Check semantics and do necessary type conversion*/
+	if (!dfw_semcheck(dfw, deprecated))
+		return FALSE;
+
+	/* Simplify and reorder the tests, unless a developer wants to
+	 * compare the results with those of the tests as written */
+	if (getenv("WIRESHARK_DFILTER_NO_OPTIMIZE") == NULL)
+		dfw_optimize(dfw);
+	return TRUE;
+}
+
+gboolean
+dfilter_compile(const gchar *text, dfilter_t **dfp, gchar **err_msg)
+{
+	dfilter_t	*dfilter;
+	dfwork_t	*dfw;
+	guint		i;
+	/* XXX, GHashTable */
+	GPtrArray	*deprecated;
+
+	g_assert(dfp);
+
+	if (!text) {
+		*dfp = NULL;
+		if (err_msg != NULL)
+			*err_msg = g_strdup("BUG: NULL text pointer passed to dfilter_compile()");
+		return FALSE;
+	}
+
+	if ( !( text = dfilter_macro_apply(text, err_msg) ) ) {
+		return FALSE;
+	}
+
+	dfw = dfwork_new();
+
+	/*
+	 * XXX - if we're using a version of Flex that supports reentrant lexical
+	 * analyzers, we should put this into the lexical analyzer's state.
+	 */
+	global_dfw = dfw;
+
+	deprecated = g_ptr_array_new();
+
+	if (!dfwork_build(dfw, text, deprecated))
 		goto FAILURE;
 
 	/* Success, but was it an empty filter? If so, discard
@@ -323,12 +348,6 @@ dfilter_compile(const gchar *text, dfilter_t **dfp, gchar **err_msg)
 		g_ptr_array_free(deprecated, TRUE);
 	}
 	else {
-
-		/* Check semantics and do necessary type conversion*/
-		if (!dfw_semcheck(dfw, deprecated)) {
-			goto FAILURE;
-		}
-
 		/* Create bytecode */
 		dfw_gencode(dfw);
 
@@ -341,10 +360,15 @@ dfilter_compile(const gchar *text, dfilter_t **dfp, gchar **err_msg)
 		dfilter->interesting_fields = dfw_interesting_fields(dfw,
 			&dfilter->num_interesting_fields);
 
+		/* Assign the interesting field slots now, so that
+		 * priming a tree does not have to */
+		for (i = 0; i < (guint)dfilter->num_interesting_fields; i++)
+			proto_register_interesting_hfid(dfilter->interesting_fields[i]);
+
 		/* Initialize run-time space */
 		dfilter->num_registers = dfw->first_constant;
 		dfilter->max_registers = dfw->next_register;
-		dfilter->registers = g_new0(GList*, dfilter->max_registers);
+		dfilter->registers = g_new0(df_register_t, dfilter->max_registers);
 		dfilter->attempted_load = g_new0(gboolean, dfilter->max_registers);
 
 		/* Initialize constants */
@@ -353,6 +377,8 @@ dfilter_compile(const gchar *text, dfilter_t **dfp, gchar **err_msg)
 		/* Add any deprecated items */
 		dfilter->deprecated = deprecated;
 
+		dfilter->text = g_strdup(text);
+
 		/* And give it to the user. */
 		*dfp = dfilter;
 	}
@@ -403,6 +429,135 @@ dfilter_apply_edt(dfilter_t *df, epan_dissect_t* edt)
 	return dfvm_apply(df, edt->tree);
 }
 
+dfilter_set_t *
+dfilter_set_new(void)
+{
+	dfilter_set_t	*set;
+
+	set = g_new(dfilter_set_t, 1);
+	set->members = g_array_new(FALSE, FALSE, sizeof(df_set_member_t));
+	set->fields = g_array_new(FALSE, FALSE, sizeof(df_set_field_t));
+	set->field_ids = g_hash_table_new(g_direct_hash, g_direct_equal);
+	set->generation = 1;
+
+	return set;
+}
+
+void
+dfilter_set_free(dfilter_set_t *set)
+{
+	guint	i;
+
+	if (!set)
+		return;
+
+	for (i = 0; i < set->members->len; i++) {
+		g_free(g_array_index(set->members, df_set_member_t, i).insn_field);
+	}
+	for (i = 0; i < set->fields->len; i++) {
+		dfvm_register_free(&g_array_index(set->fields, df_set_field_t, i).reg);
+	}
+	g_array_free(set->members, TRUE);
+	g_array_free(set->fields, TRUE);
+	g_hash_table_destroy(set->field_ids);
+	g_free(set);
+}
+
+/* Returns the index of the set field for a field, adding it if needed. */
+static int
+dfilter_set_field(dfilter_set_t *set, header_field_info *hfinfo)
+{
+	df_set_field_t	field;
+	gpointer	idx;
+
+	idx = g_hash_table_lookup(set->field_ids, GINT_TO_POINTER(hfinfo->id));
+	if (idx) {
+		return GPOINTER_TO_INT(idx) - 1;
+	}
+
+	memset(&field, 0, sizeof(field));
+	field.hfinfo = hfinfo;
+	g_array_append_val(set->fields, field);
+	g_hash_table_insert(set->field_ids, GINT_TO_POINTER(hfinfo->id),
+			GINT_TO_POINTER(set->fields->len));
+	return set->fields->len - 1;
+}
+
+int
+dfilter_set_add(dfilter_set_t *set, dfilter_t *df)
+{
+	df_set_member_t	member;
+	dfvm_insn_t	*insn;
+	guint		i;
+
+	member.df = df;
+	member.generation = 0;
+	member.result = FALSE;
+	member.same_as = -1;
+	member.insn_field = NULL;
+
+	for (i = 0; i < set->members->len; i++) {
+		df_set_member_t *other = &g_array_index(set->members, df_set_member_t, i);
+
+		if (other->same_as == -1 && strcmp(other->df->text, df->text) == 0) {
+			member.same_as = i;
+			break;
+		}
+	}
+
+	if (member.same_as == -1) {
+		member.insn_field = g_new(int, df->insns->len);
+		for (i = 0; i < df->insns->len; i++) {
+			insn = (dfvm_insn_t *)g_ptr_array_index(df->insns, i);
+			if (insn->op == READ_TREE || insn->op == CHECK_EXISTS) {
+				member.insn_field[i] = dfilter_set_field(set,
+						insn->arg1->value.hfinfo);
+			}
+			else {
+				member.insn_field[i] = -1;
+			}
+		}
+	}
+
+	g_array_append_val(set->members, member);
+	return set->members->len - 1;
+}
+
+void
+dfilter_set_reset(dfilter_set_t *set)
+{
+	guint	i;
+
+	/* Fields and results of earlier generations are stale */
+	if (++set->generation != 0)
+		return;
+
+	/* Wrapped around: make sure nothing looks current */
+	for (i = 0; i < set->members->len; i++) {
+		g_array_index(set->members, df_set_member_t, i).generation = 0;
+	}
+	for (i = 0; i < set->fields->len; i++) {
+		g_array_index(set->fields, df_set_field_t, i).generation = 0;
+	}
+	set->generation = 1;
+}
+
+gboolean
+dfilter_set_apply_edt(dfilter_set_t *set, int idx, epan_dissect_t *edt)
+{
+	df_set_member_t	*member = &g_array_index(set->members, df_set_member_t, idx);
+
+	if (member->same_as != -1) {
+		member = &g_array_index(set->members, df_set_member_t, member->same_as);
+	}
+	if (member->generation != set->generation) {
+		member->result = dfvm_apply_shared(member->df, edt->tree, set,
+				member->insn_field);
+		member->generation = set->generation;
+	}
+	return member->result;
+}
+
 
 void
 dfilter_prime_proto_tree(const dfilter_t *df, proto_tree *tree)
@@ -414,6 +569,32 @@ dfilter_prime_proto_tree(const dfilter_t *df, proto_tree *tree)
 	}
 }
 
+gboolean
+dfilter_needed_protocols(const dfilter_t *df, GArray *protos)
+{
+	header_field_info	*hfinfo;
+	int			i, proto_id;
+	guint			j;
+
+	for (i = 0; i < df->num_interesting_fields; i++) {
+		hfinfo = proto_registrar_get_nth(df->interesting_fields[i]);
+
+		/* The frame dissector lists the protocols of the packet
+		 * after all the others have returned */
+		if (strcmp(hfinfo->abbrev, "frame.protocols") == 0)
+			return FALSE;
+
+		proto_id = (hfinfo->parent == -1) ? hfinfo->id : hfinfo->parent;
+		for (j = 0; j < protos->len; j++) {
+			if (g_array_index(protos, int, j) == proto_id)
+				break;
+		}
+		if (j == protos->len)
+			g_array_append_val(protos, proto_id);
+	}
+	return TRUE;
+}
+
 GPtrArray *
 dfilter_deprecated_tokens(dfilter_t *df) {
 	if (df->deprecated && df->deprecated->len > 0) {
@@ -422,11 +603,47 @@ dfilter_deprecated_tokens(dfilter_t *df) {
 	return NULL;
 }
 
+/* Compile the filter's text again as far as the optimized syntax
+ * tree, which is not kept, and describe that tree. */
+static gchar *
+dfilter_plan(const dfilter_t *df)
+{
+	dfwork_t	*dfw;
+	GPtrArray	*deprecated;
+	gchar		*plan = NULL;
+	guint		i;
+
+	dfw = dfwork_new();
+	global_dfw = dfw;
+	deprecated = g_ptr_array_new();
+
+	if (dfwork_build(dfw, df->text, deprecated) && dfw->st_root) {
+		plan = dfw_plan(dfw);
+		/* No code is generated from this tree to take the values */
+		dfw_free_fvalues(dfw);
+	}
+
+	global_dfw = NULL;
+	g_free(dfw->error_message);
+	dfwork_free(dfw);
+	for (i = 0; i < deprecated->len; ++i)
+		g_free(g_ptr_array_index(deprecated, i));
+	g_ptr_array_free(deprecated, TRUE);
+	return plan;
+}
+
 void
 dfilter_dump(dfilter_t *df)
 {
 	guint i;
 	const gchar *sep = "";
+	gchar *plan;
+
+	plan = dfilter_plan(df);
+	if (plan) {
+		printf("Plan:\n%s\n", plan);
+		g_free(plan);
+	}
 
 	dfvm_dump(stdout, df);
 
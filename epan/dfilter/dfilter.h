@@ -27,6 +27,9 @@
 /* Passed back to user */
 typedef struct epan_dfilter dfilter_t;
 
+/* A set of filters applied to the same trees */
+typedef struct epan_dfilter_set dfilter_set_t;
+
 #include <epan/proto.h>
 
 #ifdef __cplusplus
@@ -84,11 +87,52 @@ WS_DLL_PUBLIC
 GPtrArray *
 dfilter_deprecated_tokens(dfilter_t *df);
 
+/* Add to protos (a GArray of int) the protocols of the fields/protocols
+ * used in a dfilter, for set_dissection_depth_protocols(). Returns FALSE
+ * if the dfilter needs the whole dissection of the packet. */
+WS_DLL_PUBLIC
+gboolean
+dfilter_needed_protocols(const dfilter_t *df, GArray *protos);
+
 /* Print bytecode of dfilter to stdout */
 WS_DLL_PUBLIC
 void
 dfilter_dump(dfilter_t *df);
 
+/* Filter sets, for applying many filters to the same tree, as the
+ * tap listeners or the coloring rules do. Every field which the filters
+ * of a set load is read from the tree once per tree, for all of them,
+ * identical filters are evaluated once, and the result of each filter is
+ * kept until the set is reset, so applying a filter of the set again to
+ * the same tree costs nothing.
+ *
+ * The set refers to the filters added to it but does not own them; free
+ * the set before freeing any of its filters, or at least before applying
+ * it again. */
+WS_DLL_PUBLIC
+dfilter_set_t *
+dfilter_set_new(void);
+
+WS_DLL_PUBLIC
+void
+dfilter_set_free(dfilter_set_t *set);
+
+/* Adds a filter to the set and returns its index within the set. */
+WS_DLL_PUBLIC
+int
+dfilter_set_add(dfilter_set_t *set, dfilter_t *df);
+
+/* Forget all fields and results: the filters are going to be applied
+ * to a new tree. Call this before applying the set to each tree. */
+WS_DLL_PUBLIC
+void
+dfilter_set_reset(dfilter_set_t *set);
+
+/* Apply the filter with the given index in the set */
+WS_DLL_PUBLIC
+gboolean
+dfilter_set_apply_edt(dfilter_set_t *set, int idx, struct epan_dissect *edt);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -23,10 +23,13 @@
 
 #include <glib.h>
 #include <ftypes/ftypes.h>
+#include "dfilter-int.h"
 #include "syntax-tree.h"
 
-/* The run-time logic of the dfilter function */
-typedef gboolean (*DFFuncType)(GList *arg1list, GList *arg2list, GList **retval);
+/* The run-time logic of the dfilter function. The function appends the
+ * fvalues it creates to retval with dfvm_register_append(); they are freed
+ * when the register is cleared. */
+typedef gboolean (*DFFuncType)(const df_register_t *arg1, const df_register_t *arg2, df_register_t *retval);
 
 /* The semantic check for the dfilter function */
 typedef void (*DFSemCheckType)(dfwork_t *dfw, int param_num, stnode_t *st_node);
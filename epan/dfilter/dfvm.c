@@ -20,6 +20,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "dfvm.h"
 
 #include <ftypes/ftypes-int.h>
@@ -289,28 +291,75 @@ dfvm_dump(FILE *f, dfilter_t *df)
 	}
 }
 
-/* Reads a field from the proto_tree and loads the fvalues into a register,
- * if that field has not already been read. */
-static gboolean
-read_tree(dfilter_t *df, proto_tree *tree, header_field_info *hfinfo, int reg)
+/* Make room for at least len values in a register's own array. */
+static void
+register_reserve(df_register_t *reg, guint len)
 {
-	GPtrArray	*finfos;
-	field_info	*finfo;
-	int		i, len;
-	GList		*fvalues = NULL;
-	gboolean	found_something = FALSE;
+	if (len > reg->size) {
+		reg->size = MAX(len, reg->size * 2);
+		reg->values = g_renew(fvalue_t *, reg->values, reg->size);
+	}
+}
 
-	/* Already loaded in this run of the dfilter? */
-	if (df->attempted_load[reg]) {
-		if (df->registers[reg]) {
-			return TRUE;
+/* Copy the values of loaded fields into the register's own array, so that
+ * more values can be added to them. */
+static void
+register_flatten(df_register_t *reg)
+{
+	guint	i;
+
+	if (reg->finfos) {
+		register_reserve(reg, reg->len);
+		for (i = 0; i < reg->len; i++) {
+			reg->values[i] = &reg->finfos[i]->value;
 		}
-		else {
-			return FALSE;
+		reg->finfos = NULL;
+	}
+}
+
+void
+dfvm_register_append(df_register_t *reg, fvalue_t *fv)
+{
+	register_flatten(reg);
+	register_reserve(reg, reg->len + 1);
+	reg->values[reg->len++] = fv;
+}
+
+/* Empty a register, keeping its array for the next run. */
+static void
+register_clear(df_register_t *reg)
+{
+	guint	i;
+
+	if (reg->owned) {
+		for (i = 0; i < reg->len; i++) {
+			FVALUE_FREE(reg->values[i]);
 		}
+		reg->owned = FALSE;
 	}
+	reg->finfos = NULL;
+	reg->len = 0;
+}
 
-	df->attempted_load[reg] = TRUE;
+void
+dfvm_register_free(df_register_t *reg)
+{
+	register_clear(reg);
+	g_free(reg->values);
+	reg->values = NULL;
+	reg->size = 0;
+}
+
+/* Loads the fvalues of a field (and of the fields with the same name)
+ * from the proto_tree into an empty register. The register refers to
+ * the field_info array of the field in place unless fields with the same
+ * name are found too. */
+static void
+load_field(df_register_t *r, proto_tree *tree, header_field_info *hfinfo)
+{
+	GPtrArray	*finfos;
+	field_info	*finfo;
+	guint		i;
 
 	while (hfinfo) {
 		finfos = proto_get_finfo_ptr_array(tree, hfinfo->id);
@@ -318,32 +367,80 @@ read_tree(dfilter_t *df, proto_tree *tree, header_field_info *hfinfo, int reg)
 			hfinfo = hfinfo->same_name_next;
 			continue;
 		}
-		else {
-			found_something = TRUE;
-		}
 
-		len = finfos->len;
-		for (i = 0; i < len; i++) {
-			finfo = (field_info *)g_ptr_array_index(finfos, i);
-			fvalues = g_list_prepend(fvalues, &finfo->value);
+		if (r->len == 0) {
+			r->finfos = (field_info **)finfos->pdata;
+			r->len = finfos->len;
+		}
+		else {
+			register_flatten(r);
+			register_reserve(r, r->len + finfos->len);
+			for (i = 0; i < finfos->len; i++) {
+				finfo = (field_info *)g_ptr_array_index(finfos, i);
+				r->values[r->len++] = &finfo->value;
+			}
 		}
 
 		hfinfo = hfinfo->same_name_next;
 	}
+}
+
+/* Returns the register of a field of a filter set, loading it if it has
+ * not been loaded for the current tree yet. */
+static const df_register_t *
+load_set_field(dfilter_set_t *set, int field_idx, proto_tree *tree)
+{
+	df_set_field_t	*field = &g_array_index(set->fields, df_set_field_t, field_idx);
 
-	if (!found_something) {
-		return FALSE;
+	if (field->generation != set->generation) {
+		register_clear(&field->reg);
+		load_field(&field->reg, tree, field->hfinfo);
+		field->generation = set->generation;
 	}
+	return &field->reg;
+}
 
-	df->registers[reg] = fvalues;
-	return TRUE;
+/* Reads a field from the proto_tree and loads the fvalues into a register,
+ * if that field has not already been read. With a filter set, the field
+ * is read through the set. */
+static gboolean
+read_tree(dfilter_t *df, proto_tree *tree, header_field_info *hfinfo, int reg,
+		dfilter_set_t *set, int field_idx)
+{
+	df_register_t		*r = &df->registers[reg];
+	const df_register_t	*shared;
+
+	/* Already loaded in this run of the dfilter? */
+	if (df->attempted_load[reg]) {
+		return r->len != 0;
+	}
+
+	df->attempted_load[reg] = TRUE;
+
+	if (set && field_idx >= 0) {
+		shared = load_set_field(set, field_idx, tree);
+		if (shared->finfos) {
+			r->finfos = shared->finfos;
+		}
+		else if (shared->len) {
+			register_reserve(r, shared->len);
+			memcpy(r->values, shared->values, shared->len * sizeof(fvalue_t *));
+		}
+		r->len = shared->len;
+	}
+	else {
+		load_field(r, tree, hfinfo);
+	}
+
+	return r->len != 0;
 }
 
 
 static gboolean
 put_fvalue(dfilter_t *df, fvalue_t *fv, int reg)
 {
-	df->registers[reg] = g_list_append(NULL, fv);
+	register_clear(&df->registers[reg]);
+	dfvm_register_append(&df->registers[reg], fv);
 	return TRUE;
 }
 
@@ -352,26 +449,23 @@ typedef gboolean (*FvalueCmpFunc)(const fvalue_t*, const fvalue_t*);
 static gboolean
 any_test(dfilter_t *df, FvalueCmpFunc cmp, int reg1, int reg2)
 {
-	GList	*list_a, *list_b;
-
-	list_a = df->registers[reg1];
+	const df_register_t	*a = &df->registers[reg1];
+	const df_register_t	*b = &df->registers[reg2];
+	guint			i, j;
 
-	while (list_a) {
-		list_b = df->registers[reg2];
-		while (list_b) {
-			if (cmp((fvalue_t *)list_a->data, (fvalue_t *)list_b->data)) {
+	for (i = 0; i < a->len; i++) {
+		for (j = 0; j < b->len; j++) {
+			if (cmp(DF_REGISTER_VALUE(a, i), DF_REGISTER_VALUE(b, j))) {
 				return TRUE;
 			}
-			list_b = g_list_next(list_b);
 		}
-		list_a = g_list_next(list_a);
 	}
 	return FALSE;
 }
 
 
-/* Free the list nodes w/o freeing the memory that each
- * list node points to. */
+/* Empty the registers for the next run, without freeing the
+ * memory of the fields they refer to. */
 static void
 free_register_overhead(dfilter_t* df)
 {
@@ -379,44 +473,48 @@ free_register_overhead(dfilter_t* df)
 
 	for (i = 0; i < df->num_registers; i++) {
 		df->attempted_load[i] = FALSE;
-		if (df->registers[i]) {
-			g_list_free(df->registers[i]);
-			df->registers[i] = NULL;
-		}
+		register_clear(&df->registers[i]);
 	}
 }
 
-/* Takes the list of fvalue_t's in a register, uses fvalue_slice()
- * to make a new list of fvalue_t's (which are ranges, or byte-slices),
- * and puts the new list into a new register. */
+/* Takes the fvalue_t's in a register, uses fvalue_slice()
+ * to make new fvalue_t's (which are ranges, or byte-slices),
+ * and puts them into another register. */
 static void
 mk_range(dfilter_t *df, int from_reg, int to_reg, drange_t *d_range)
 {
-	GList		*from_list, *to_list;
-	fvalue_t	*old_fv, *new_fv;
+	const df_register_t	*from = &df->registers[from_reg];
+	df_register_t		*to = &df->registers[to_reg];
+	fvalue_t		*new_fv;
+	guint			i;
 
-	to_list = NULL;
-	from_list = df->registers[from_reg];
+	register_clear(to);
+	register_reserve(to, from->len);
+	to->owned = TRUE;
 
-	while (from_list) {
-		old_fv = (fvalue_t*)from_list->data;
-		new_fv = fvalue_slice(old_fv, d_range);
+	for (i = 0; i < from->len; i++) {
+		new_fv = fvalue_slice(DF_REGISTER_VALUE(from, i), d_range);
 		/* Assert here because semcheck.c should have
 		 * already caught the cases in which a slice
 		 * cannot be made. */
 		g_assert(new_fv);
-		to_list = g_list_append(to_list, new_fv);
-
-		from_list = g_list_next(from_list);
+		to->values[to->len++] = new_fv;
 	}
-
-	df->registers[to_reg] = to_list;
 }
 
 
 
 gboolean
 dfvm_apply(dfilter_t *df, proto_tree *tree)
+{
+	return dfvm_apply_shared(df, tree, NULL, NULL);
+}
+
+/* Runs a filter of a filter set, with insn_field giving the set field
+ * of each instruction, or with a NULL set and insn_field on its own. */
+gboolean
+dfvm_apply_shared(dfilter_t *df, proto_tree *tree, dfilter_set_t *set,
+		const int *insn_field)
 {
 	int		id, length;
 	gboolean	accum = TRUE;
@@ -426,8 +524,9 @@ dfvm_apply(dfilter_t *df, proto_tree *tree)
 	dfvm_value_t	*arg3 = NULL;
 	dfvm_value_t	*arg4 = NULL;
 	header_field_info	*hfinfo;
-	GList		*param1;
-	GList		*param2;
+	df_register_t	*param1;
+	df_register_t	*param2;
+	df_register_t	*retval;
 
 	g_assert(tree);
 
@@ -442,6 +541,10 @@ dfvm_apply(dfilter_t *df, proto_tree *tree)
 
 		switch (insn->op) {
 			case CHECK_EXISTS:
+				if (set && insn_field[id] >= 0) {
+					accum = load_set_field(set, insn_field[id], tree)->len != 0;
+					break;
+				}
 				hfinfo = arg1->value.hfinfo;
 				while(hfinfo) {
 					accum = proto_check_for_protocol_or_field(tree,
@@ -457,7 +560,8 @@ dfvm_apply(dfilter_t *df, proto_tree *tree)
 
 			case READ_TREE:
 				accum = read_tree(df, tree,
-						arg1->value.hfinfo, arg2->value.numeric);
+						arg1->value.hfinfo, arg2->value.numeric,
+						set, set ? insn_field[id] : -1);
 				break;
 
 			case CALL_FUNCTION:
@@ -466,13 +570,16 @@ dfvm_apply(dfilter_t *df, proto_tree *tree)
 				param1 = NULL;
 				param2 = NULL;
 				if (arg3) {
-					param1 = df->registers[arg3->value.numeric];
+					param1 = &df->registers[arg3->value.numeric];
 				}
 				if (arg4) {
-					param2 = df->registers[arg4->value.numeric];
+					param2 = &df->registers[arg4->value.numeric];
 				}
+				retval = &df->registers[arg2->value.numeric];
+				register_clear(retval);
+				retval->owned = TRUE;
 				accum = arg1->value.funcdef->function(param1, param2,
-						&df->registers[arg2->value.numeric]);
+						retval);
 				break;
 
 			case MK_RANGE:
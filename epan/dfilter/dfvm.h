@@ -100,7 +100,17 @@ dfvm_dump(FILE *f, dfilter_t *df);
 gboolean
 dfvm_apply(dfilter_t *df, proto_tree *tree);
 
+gboolean
+dfvm_apply_shared(dfilter_t *df, proto_tree *tree, dfilter_set_t *set,
+		const int *insn_field);
+
 void
 dfvm_init_const(dfilter_t *df);
 
+void
+dfvm_register_append(df_register_t *reg, fvalue_t *fv);
+
+void
+dfvm_register_free(df_register_t *reg);
+
 #endif
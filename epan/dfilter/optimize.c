@@ -0,0 +1,721 @@
+/*
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 2001 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "dfilter-int.h"
+#include "optimize.h"
+#include "syntax-tree.h"
+#include "sttype-range.h"
+#include "sttype-test.h"
+#include "sttype-function.h"
+
+#include <ftypes/ftypes-int.h>
+
+/*
+ * The tests of a display filter have no side effects, so the operands
+ * of "and" and "or" can be evaluated in any order, and the generated
+ * code stops at the first operand which decides the result. Putting
+ * the cheap operands first means the expensive ones, such as searching
+ * a payload, only run on the packets which the cheap ones let through.
+ *
+ * The costs below only rank the tests against each other; they are
+ * not measured times.
+ */
+#define COST_EXISTS		1
+#define COST_LOAD		1	/* Reading a field from the tree, or slicing it */
+#define COST_FUNCTION		4
+#define COST_CMP_INTEGER	2
+#define COST_CMP_FIXED		3	/* Addresses, times, floating point, ... */
+#define COST_CMP_STRING		4	/* Strings and byte arrays */
+#define COST_CONTAINS		8
+#define COST_MATCHES		16
+
+static stnode_t *
+optimize_node(stnode_t *node);
+
+static int
+node_cost(stnode_t *node);
+
+static ftenum_t
+entity_ftype(stnode_t *node)
+{
+	switch (stnode_type_id(node)) {
+		case STTYPE_FIELD:
+			return ((header_field_info *)stnode_data(node))->type;
+		case STTYPE_FVALUE:
+			return fvalue_type_ftenum((fvalue_t *)stnode_data(node));
+		case STTYPE_RANGE:
+			return FT_BYTES;
+		case STTYPE_FUNCTION:
+			return sttype_function_funcdef(node)->retval_ftype;
+		default:
+			return FT_NONE;
+	}
+}
+
+static int
+entity_cost(stnode_t *node)
+{
+	GSList	*params;
+	int	cost;
+
+	switch (stnode_type_id(node)) {
+		case STTYPE_FIELD:
+			return COST_LOAD;
+		case STTYPE_FVALUE:
+			/* Constants are set up once, not per packet */
+			return 0;
+		case STTYPE_RANGE:
+			return entity_cost(sttype_range_entity(node)) + COST_LOAD;
+		case STTYPE_FUNCTION:
+			cost = COST_FUNCTION;
+			for (params = sttype_function_params(node); params; params = params->next)
+				cost += entity_cost((stnode_t *)params->data);
+			return cost;
+		default:
+			return 0;
+	}
+}
+
+static int
+compare_cost(ftenum_t ftype)
+{
+	if (IS_FT_INT(ftype) || IS_FT_UINT(ftype) || ftype == FT_BOOLEAN ||
+	    ftype == FT_IPv4 || ftype == FT_IPXNET)
+		return COST_CMP_INTEGER;
+
+	if (IS_FT_STRING(ftype) || ftype == FT_UINT_STRING ||
+	    ftype == FT_BYTES || ftype == FT_UINT_BYTES || ftype == FT_PROTOCOL ||
+	    ftype == FT_OID || ftype == FT_REL_OID || ftype == FT_SYSTEM_ID)
+		return COST_CMP_STRING;
+
+	return COST_CMP_FIXED;
+}
+
+static int
+test_cost(stnode_t *node)
+{
+	test_op_t	op;
+	stnode_t	*arg1, *arg2;
+	stnode_t	*value;
+
+	sttype_test_get(node, &op, &arg1, &arg2);
+
+	switch (op) {
+		case TEST_OP_UNINITIALIZED:
+			break;
+
+		case TEST_OP_EXISTS:
+			return COST_EXISTS;
+
+		case TEST_OP_NOT:
+			return node_cost(arg1);
+
+		case TEST_OP_AND:
+		case TEST_OP_OR:
+			/* All the operands, as we cannot tell how
+			 * often the first ones decide the result */
+			return node_cost(arg1) + node_cost(arg2);
+
+		case TEST_OP_EQ:
+		case TEST_OP_NE:
+		case TEST_OP_GT:
+		case TEST_OP_GE:
+		case TEST_OP_LT:
+		case TEST_OP_LE:
+		case TEST_OP_BITWISE_AND:
+			/* The values are compared as the type of the
+			 * field, or whichever side is not a constant */
+			value = (stnode_type_id(arg1) == STTYPE_FVALUE) ? arg2 : arg1;
+			return compare_cost(entity_ftype(value)) +
+				entity_cost(arg1) + entity_cost(arg2);
+
+		case TEST_OP_CONTAINS:
+			return COST_CONTAINS + entity_cost(arg1) + entity_cost(arg2);
+
+		case TEST_OP_MATCHES:
+			return COST_MATCHES + entity_cost(arg1) + entity_cost(arg2);
+	}
+	g_assert_not_reached();
+	return 0;
+}
+
+static int
+node_cost(stnode_t *node)
+{
+	if (stnode_type_id(node) == STTYPE_TEST)
+		return test_cost(node);
+	return entity_cost(node);
+}
+
+static gboolean
+node_equal(stnode_t *a, stnode_t *b);
+
+static gboolean
+fvalue_equal(fvalue_t *a, fvalue_t *b)
+{
+	char		*repr_a, *repr_b;
+	gboolean	equal;
+
+	if (fvalue_type_ftenum(a) != fvalue_type_ftenum(b))
+		return FALSE;
+
+	/* Not every type can be compared for equality, but every
+	 * constant which came from a filter string can be written
+	 * back as one. */
+	repr_a = fvalue_to_string_repr(a, FTREPR_DFILTER, BASE_NONE, NULL);
+	repr_b = fvalue_to_string_repr(b, FTREPR_DFILTER, BASE_NONE, NULL);
+	equal = repr_a && repr_b && strcmp(repr_a, repr_b) == 0;
+	g_free(repr_a);
+	g_free(repr_b);
+
+	return equal;
+}
+
+static gboolean
+drange_equal(drange_t *a, drange_t *b)
+{
+	GSList		*list_a, *list_b;
+	drange_node	*node_a, *node_b;
+
+	for (list_a = a->range_list, list_b = b->range_list;
+	     list_a && list_b;
+	     list_a = list_a->next, list_b = list_b->next) {
+		node_a = (drange_node *)list_a->data;
+		node_b = (drange_node *)list_b->data;
+		if (node_a->ending != node_b->ending ||
+		    node_a->start_offset != node_b->start_offset)
+			return FALSE;
+		if (node_a->ending == DRANGE_NODE_END_T_LENGTH &&
+		    node_a->length != node_b->length)
+			return FALSE;
+		if (node_a->ending == DRANGE_NODE_END_T_OFFSET &&
+		    node_a->end_offset != node_b->end_offset)
+			return FALSE;
+	}
+
+	return list_a == NULL && list_b == NULL;
+}
+
+static gboolean
+test_equal(stnode_t *a, stnode_t *b)
+{
+	test_op_t	op_a, op_b;
+	stnode_t	*a1, *a2, *b1, *b2;
+
+	sttype_test_get(a, &op_a, &a1, &a2);
+	sttype_test_get(b, &op_b, &b1, &b2);
+
+	if (op_a != op_b || !node_equal(a1, b1))
+		return FALSE;
+	if (a2 == NULL || b2 == NULL)
+		return a2 == b2;
+	return node_equal(a2, b2);
+}
+
+/* Whether two sub-trees test the same thing. Only used to find
+ * duplicates, so a FALSE for equivalent trees is safe. */
+static gboolean
+node_equal(stnode_t *a, stnode_t *b)
+{
+	GSList	*params_a, *params_b;
+
+	if (stnode_type_id(a) != stnode_type_id(b))
+		return FALSE;
+
+	switch (stnode_type_id(a)) {
+		case STTYPE_TEST:
+			return test_equal(a, b);
+
+		case STTYPE_FIELD:
+			return stnode_data(a) == stnode_data(b);
+
+		case STTYPE_FVALUE:
+			return fvalue_equal((fvalue_t *)stnode_data(a),
+					(fvalue_t *)stnode_data(b));
+
+		case STTYPE_RANGE:
+			return node_equal(sttype_range_entity(a), sttype_range_entity(b)) &&
+				drange_equal(sttype_range_drange(a), sttype_range_drange(b));
+
+		case STTYPE_FUNCTION:
+			if (sttype_function_funcdef(a) != sttype_function_funcdef(b))
+				return FALSE;
+			for (params_a = sttype_function_params(a), params_b = sttype_function_params(b);
+			     params_a && params_b;
+			     params_a = params_a->next, params_b = params_b->next) {
+				if (!node_equal((stnode_t *)params_a->data, (stnode_t *)params_b->data))
+					return FALSE;
+			}
+			return params_a == NULL && params_b == NULL;
+
+		default:
+			return FALSE;
+	}
+}
+
+/* The FVALUE nodes do not own their values, which normally go on to
+ * the PUT_FVALUE instructions; free those of a dropped sub-tree. */
+static void
+free_fvalues(stnode_t *node)
+{
+	stnode_t	*arg1, *arg2;
+	GSList		*params;
+
+	switch (stnode_type_id(node)) {
+		case STTYPE_TEST:
+			sttype_test_get(node, NULL, &arg1, &arg2);
+			if (arg1)
+				free_fvalues(arg1);
+			if (arg2)
+				free_fvalues(arg2);
+			break;
+
+		case STTYPE_FVALUE:
+			FVALUE_FREE((fvalue_t *)stnode_data(node));
+			break;
+
+		case STTYPE_RANGE:
+			free_fvalues(sttype_range_entity(node));
+			break;
+
+		case STTYPE_FUNCTION:
+			for (params = sttype_function_params(node); params; params = params->next)
+				free_fvalues((stnode_t *)params->data);
+			break;
+
+		default:
+			break;
+	}
+}
+
+static void
+free_subtree(stnode_t *node)
+{
+	free_fvalues(node);
+	stnode_free(node);
+}
+
+/* Free a TEST node, but not its operands */
+static void
+free_test_node(stnode_t *node)
+{
+	sttype_test_set2_args(node, NULL, NULL);
+	stnode_free(node);
+}
+
+/* Returns the field which a relation needs to be present, if any */
+static header_field_info *
+relation_field(stnode_t *node)
+{
+	test_op_t	op;
+	stnode_t	*arg1, *arg2;
+
+	if (stnode_type_id(node) != STTYPE_TEST)
+		return NULL;
+
+	sttype_test_get(node, &op, &arg1, &arg2);
+	switch (op) {
+		case TEST_OP_EQ:
+		case TEST_OP_NE:
+		case TEST_OP_GT:
+		case TEST_OP_GE:
+		case TEST_OP_LT:
+		case TEST_OP_LE:
+		case TEST_OP_BITWISE_AND:
+		case TEST_OP_CONTAINS:
+		case TEST_OP_MATCHES:
+			break;
+		default:
+			return NULL;
+	}
+
+	/* A relation is false unless its field has an occurrence */
+	if (stnode_type_id(arg1) == STTYPE_RANGE)
+		arg1 = sttype_range_entity(arg1);
+	if (stnode_type_id(arg1) == STTYPE_FIELD)
+		return (header_field_info *)stnode_data(arg1);
+	return NULL;
+}
+
+/* Returns the field of an existence test, if node is one */
+static header_field_info *
+exists_field(stnode_t *node)
+{
+	test_op_t	op;
+	stnode_t	*arg1;
+
+	if (stnode_type_id(node) != STTYPE_TEST)
+		return NULL;
+
+	sttype_test_get(node, &op, &arg1, NULL);
+	if (op != TEST_OP_EXISTS)
+		return NULL;
+	return (header_field_info *)stnode_data(arg1);
+}
+
+/* Flatten a chain of the same "and" or "or" into its operands,
+ * optimizing each of them. */
+static void
+collect_operands(stnode_t *node, test_op_t chain_op, GPtrArray *operands,
+		GPtrArray *op_nodes)
+{
+	test_op_t	op;
+	stnode_t	*arg1, *arg2;
+
+	if (stnode_type_id(node) == STTYPE_TEST) {
+		sttype_test_get(node, &op, &arg1, &arg2);
+		if (op == chain_op) {
+			g_ptr_array_add(op_nodes, node);
+			collect_operands(arg1, chain_op, operands, op_nodes);
+			collect_operands(arg2, chain_op, operands, op_nodes);
+			return;
+		}
+	}
+	g_ptr_array_add(operands, optimize_node(node));
+}
+
+/* Drop the operands of a chain which do not change its result */
+static void
+fold_operands(test_op_t chain_op, GPtrArray *operands)
+{
+	header_field_info	*hfinfo;
+	stnode_t		*operand;
+	guint			i, j;
+
+	/* "a and a" is "a", and "a or a" is "a" */
+	for (i = 1; i < operands->len; i++) {
+		operand = (stnode_t *)g_ptr_array_index(operands, i);
+		for (j = 0; j < i; j++) {
+			if (node_equal((stnode_t *)g_ptr_array_index(operands, j), operand)) {
+				g_ptr_array_remove_index(operands, i);
+				free_subtree(operand);
+				i--;
+				break;
+			}
+		}
+	}
+
+	/* A relation on a field implies that the field exists, so
+	 * "f and f == 1" is "f == 1", and "f or f == 1" is "f". */
+	for (i = 0; i < operands->len; i++) {
+		hfinfo = exists_field((stnode_t *)g_ptr_array_index(operands, i));
+		if (!hfinfo)
+			continue;
+
+		for (j = 0; j < operands->len; j++) {
+			operand = (stnode_t *)g_ptr_array_index(operands, j);
+			if (relation_field(operand) != hfinfo)
+				continue;
+
+			if (chain_op == TEST_OP_AND) {
+				operand = (stnode_t *)g_ptr_array_index(operands, i);
+				g_ptr_array_remove_index(operands, i);
+				free_subtree(operand);
+				i--;
+				break;
+			}
+			g_ptr_array_remove_index(operands, j);
+			free_subtree(operand);
+			if (j < i)
+				i--;
+			j--;
+		}
+	}
+}
+
+/* Stable sort of the operands by increasing cost; the chains are
+ * short, so an insertion sort does. */
+static void
+order_operands(GPtrArray *operands)
+{
+	int		*costs;
+	stnode_t	*operand;
+	int		cost;
+	guint		i, j;
+
+	costs = g_new(int, operands->len);
+	for (i = 0; i < operands->len; i++)
+		costs[i] = node_cost((stnode_t *)g_ptr_array_index(operands, i));
+
+	for (i = 1; i < operands->len; i++) {
+		operand = (stnode_t *)g_ptr_array_index(operands, i);
+		cost = costs[i];
+		for (j = i; j > 0 && costs[j - 1] > cost; j--) {
+			g_ptr_array_index(operands, j) = g_ptr_array_index(operands, j - 1);
+			costs[j] = costs[j - 1];
+		}
+		g_ptr_array_index(operands, j) = operand;
+		costs[j] = cost;
+	}
+
+	g_free(costs);
+}
+
+static stnode_t *
+optimize_chain(stnode_t *node, test_op_t chain_op)
+{
+	GPtrArray	*operands = g_ptr_array_new();
+	GPtrArray	*op_nodes = g_ptr_array_new();
+	stnode_t	*result;
+	stnode_t	*op_node;
+	guint		i;
+
+	collect_operands(node, chain_op, operands, op_nodes);
+	fold_operands(chain_op, operands);
+	order_operands(operands);
+
+	/* Rebuild the chain as "a op (b op (c ...))", reusing the TEST
+	 * nodes, so that the first operand is evaluated first and a
+	 * decided result jumps straight to the end. */
+	result = (stnode_t *)g_ptr_array_index(operands, operands->len - 1);
+	for (i = operands->len - 1; i > 0; i--) {
+		op_node = (stnode_t *)g_ptr_array_index(op_nodes, i - 1);
+		sttype_test_set2_args(op_node,
+			(stnode_t *)g_ptr_array_index(operands, i - 1), result);
+		result = op_node;
+	}
+	for (i = operands->len - 1; i < op_nodes->len; i++)
+		free_test_node((stnode_t *)g_ptr_array_index(op_nodes, i));
+
+	g_ptr_array_free(operands, TRUE);
+	g_ptr_array_free(op_nodes, TRUE);
+
+	return result;
+}
+
+static stnode_t *
+optimize_node(stnode_t *node)
+{
+	test_op_t	op;
+	stnode_t	*arg1, *arg2;
+	stnode_t	*inner;
+
+	if (stnode_type_id(node) != STTYPE_TEST)
+		return node;
+
+	sttype_test_get(node, &op, &arg1, &arg2);
+	switch (op) {
+		case TEST_OP_NOT:
+			arg1 = optimize_node(arg1);
+			if (stnode_type_id(arg1) == STTYPE_TEST) {
+				sttype_test_get(arg1, &op, &inner, NULL);
+				if (op == TEST_OP_NOT) {
+					/* "not not a" is "a" */
+					free_test_node(arg1);
+					free_test_node(node);
+					return inner;
+				}
+			}
+			sttype_test_set2_args(node, arg1, NULL);
+			return node;
+
+		case TEST_OP_AND:
+		case TEST_OP_OR:
+			return optimize_chain(node, op);
+
+		default:
+			return node;
+	}
+}
+
+void
+dfw_optimize(dfwork_t *dfw)
+{
+	dfw->st_root = optimize_node(dfw->st_root);
+}
+
+static void
+plan_append_entity(GString *plan, stnode_t *node)
+{
+	char		*repr;
+	GSList		*params;
+	GSList		*range_list;
+	drange_node	*range_item;
+
+	switch (stnode_type_id(node)) {
+		case STTYPE_FIELD:
+			g_string_append(plan, ((header_field_info *)stnode_data(node))->abbrev);
+			break;
+
+		case STTYPE_FVALUE:
+			repr = fvalue_to_string_repr((fvalue_t *)stnode_data(node),
+				FTREPR_DFILTER, BASE_NONE, NULL);
+			if (repr)
+				g_string_append(plan, repr);
+			else
+				g_string_append_printf(plan, "<%s>",
+					fvalue_type_name((fvalue_t *)stnode_data(node)));
+			g_free(repr);
+			break;
+
+		case STTYPE_RANGE:
+			plan_append_entity(plan, sttype_range_entity(node));
+			g_string_append_c(plan, '[');
+			for (range_list = sttype_range_drange(node)->range_list;
+			     range_list != NULL;
+			     range_list = range_list->next) {
+				range_item = (drange_node *)range_list->data;
+				switch (range_item->ending) {
+
+				case DRANGE_NODE_END_T_UNINITIALIZED:
+					g_string_append_c(plan, '?');
+					break;
+
+				case DRANGE_NODE_END_T_LENGTH:
+					g_string_append_printf(plan, "%d:%d",
+					    range_item->start_offset,
+					    range_item->length);
+					break;
+
+				case DRANGE_NODE_END_T_OFFSET:
+					g_string_append_printf(plan, "%d-%d",
+					    range_item->start_offset,
+					    range_item->end_offset);
+					break;
+
+				case DRANGE_NODE_END_T_TO_THE_END:
+					g_string_append_printf(plan, "%d:",
+					    range_item->start_offset);
+					break;
+				}
+				if (range_list->next != NULL)
+					g_string_append_c(plan, ',');
+			}
+			g_string_append_c(plan, ']');
+			break;
+
+		case STTYPE_FUNCTION:
+			g_string_append_printf(plan, "%s(", sttype_function_funcdef(node)->name);
+			for (params = sttype_function_params(node); params; params = params->next) {
+				plan_append_entity(plan, (stnode_t *)params->data);
+				if (params->next != NULL)
+					g_string_append(plan, ", ");
+			}
+			g_string_append_c(plan, ')');
+			break;
+
+		default:
+			g_string_append(plan, stnode_type_name(node));
+			break;
+	}
+}
+
+static void
+plan_append_chain(GString *plan, stnode_t *node, test_op_t chain_op, int indent);
+
+static void
+plan_append(GString *plan, stnode_t *node, int indent)
+{
+	static const char *relation[] = {
+		NULL,		/* TEST_OP_UNINITIALIZED */
+		NULL,		/* TEST_OP_EXISTS */
+		NULL,		/* TEST_OP_NOT */
+		NULL,		/* TEST_OP_AND */
+		NULL,		/* TEST_OP_OR */
+		"==",		/* TEST_OP_EQ */
+		"!=",		/* TEST_OP_NE */
+		">",		/* TEST_OP_GT */
+		">=",		/* TEST_OP_GE */
+		"<",		/* TEST_OP_LT */
+		"<=",		/* TEST_OP_LE */
+		"&",		/* TEST_OP_BITWISE_AND */
+		"contains",	/* TEST_OP_CONTAINS */
+		"matches"	/* TEST_OP_MATCHES */
+	};
+	test_op_t	op;
+	stnode_t	*arg1, *arg2;
+
+	g_string_append_printf(plan, "%*s", indent * 4, "");
+	sttype_test_get(node, &op, &arg1, &arg2);
+	switch (op) {
+		case TEST_OP_EXISTS:
+			plan_append_entity(plan, arg1);
+			break;
+
+		case TEST_OP_NOT:
+			g_string_append_printf(plan, "not (cost %d)\n", node_cost(node));
+			plan_append(plan, arg1, indent + 1);
+			return;
+
+		case TEST_OP_AND:
+		case TEST_OP_OR:
+			g_string_append_printf(plan, "%s (cost %d)\n",
+				op == TEST_OP_AND ? "and" : "or", node_cost(node));
+			plan_append_chain(plan, node, op, indent + 1);
+			return;
+
+		default:
+			g_assert(op < G_N_ELEMENTS(relation) && relation[op]);
+			plan_append_entity(plan, arg1);
+			g_string_append_printf(plan, " %s ", relation[op]);
+			plan_append_entity(plan, arg2);
+			break;
+	}
+	g_string_append_printf(plan, " (cost %d)\n", node_cost(node));
+}
+
+/* The operands of a chain are listed at the same level */
+static void
+plan_append_chain(GString *plan, stnode_t *node, test_op_t chain_op, int indent)
+{
+	test_op_t	op;
+	stnode_t	*arg1, *arg2;
+
+	sttype_test_get(node, &op, &arg1, &arg2);
+	if (op != chain_op) {
+		plan_append(plan, node, indent);
+		return;
+	}
+	plan_append_chain(plan, arg1, chain_op, indent);
+	plan_append_chain(plan, arg2, chain_op, indent);
+}
+
+gchar *
+dfw_plan(dfwork_t *dfw)
+{
+	GString		*plan = g_string_new("");
+
+	plan_append(plan, dfw->st_root, 0);
+	return g_string_free(plan, FALSE);
+}
+
+void
+dfw_free_fvalues(dfwork_t *dfw)
+{
+	if (dfw->st_root)
+		free_fvalues(dfw->st_root);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -0,0 +1,41 @@
+/*
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 2001 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+/* Simplify the syntax tree checked by dfw_semcheck(), and order the
+ * tests of "and" and "or" so that the cheapest are evaluated first. */
+void
+dfw_optimize(dfwork_t *dfw);
+
+/* Returns the optimized syntax tree as text, one test per line with
+ * its estimated cost, for dfilter_dump(), which builds the tree again
+ * for it. Must be called before dfw_gencode(), which takes the ranges
+ * out of the tree. */
+gchar *
+dfw_plan(dfwork_t *dfw);
+
+/* Frees the values of the FVALUE nodes of a syntax tree which won't be
+ * handed to dfw_gencode(), such as the one built for dfw_plan(). */
+void
+dfw_free_fvalues(dfwork_t *dfw);
+
+#endif
@@ -2547,6 +2547,14 @@ dissect_ip_heur(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data
     return TRUE;
 }
 
+/* Reassembly must see every fragment, even when the filters given to
+ * --filter-depth don't need IP */
+static void
+apply_ip_prefs(void)
+{
+  set_dissection_depth_stateful(proto_ip, ip_defragment);
+}
+
 void
 proto_register_ip(void)
 {
@@ -3063,7 +3071,7 @@ proto_register_ip(void)
   heur_subdissector_list = register_heur_dissector_list("ip");
 
   /* Register configuration options */
-  ip_module = prefs_register_protocol(proto_ip, NULL);
+  ip_module = prefs_register_protocol(proto_ip, apply_ip_prefs);
   prefs_register_bool_preference(ip_module, "decode_tos_as_diffserv",
     "Decode IPv4 TOS field as DiffServ field",
     "Whether the IPv4 type-of-service field should be decoded as a "
@@ -3138,6 +3146,7 @@ proto_reg_handoff_ip(void)
   dissector_add_for_decode_as("udp.port", ip_handle);
 
   heur_dissector_add("tipc", dissect_ip_heur, proto_ip);
+  apply_ip_prefs();
 }
 
 /*
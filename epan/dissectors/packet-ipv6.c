@@ -2216,6 +2216,14 @@ again:
     pinfo->fragmented = save_fragmented;
 }
 
+/* Reassembly must see every fragment, even when the filters given to
+ * --filter-depth don't need IPv6 */
+static void
+apply_ipv6_prefs(void)
+{
+    set_dissection_depth_stateful(proto_ipv6, ipv6_reassemble);
+}
+
 void
 proto_register_ipv6(void)
 {
@@ -3001,7 +3009,7 @@ proto_register_ipv6(void)
       "IPv6 Next Header", FT_UINT32, BASE_DEC);
 
     /* Register configuration options */
-    ipv6_module = prefs_register_protocol(proto_ipv6, NULL);
+    ipv6_module = prefs_register_protocol(proto_ipv6, apply_ipv6_prefs);
     prefs_register_bool_preference(ipv6_module, "defragment",
                                    "Reassemble fragmented IPv6 datagrams",
                                    "Whether fragmented IPv6 datagrams should be reassembled",
@@ -3077,6 +3085,7 @@ proto_reg_handoff_ipv6(void)
     dissector_add_uint("ipv6.nxt", IP_PROTO_DSTOPTS, ipv6_dstopts_handle);
 
     ip_dissector_table = find_dissector_table("ip.proto");
+    apply_ipv6_prefs();
 }
 
 /*
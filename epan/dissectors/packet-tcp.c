@@ -5086,6 +5086,14 @@ tcp_init(void)
                           &addresses_ports_reassembly_table_functions);
 }
 
+/* The reassembly and the sequence analysis must see every segment of a
+ * connection, even when the filters given to --filter-depth don't need TCP */
+static void
+apply_tcp_prefs(void)
+{
+    set_dissection_depth_stateful(proto_tcp, tcp_desegment || tcp_analyze_seq);
+}
+
 void
 proto_register_tcp(void)
 {
@@ -5950,7 +5958,7 @@ proto_register_tcp(void)
     heur_subdissector_list = register_heur_dissector_list("tcp");
 
     /* Register configuration preferences */
-    tcp_module = prefs_register_protocol(proto_tcp, NULL);
+    tcp_module = prefs_register_protocol(proto_tcp, apply_tcp_prefs);
     prefs_register_bool_preference(tcp_module, "summary_in_tree",
         "Show TCP summary in protocol tree",
         "Whether the TCP summary line should be shown in the protocol tree",
@@ -6029,6 +6037,7 @@ proto_reg_handoff_tcp(void)
     data_handle = find_dissector("data");
     sport_handle = find_dissector("sport");
     tcp_tap = register_tap("tcp");
+    apply_tcp_prefs();
 }
 
 /*
@@ -109,6 +109,36 @@ struct heur_dissector_list {
 
 static GHashTable *heur_dissector_lists = NULL;
 
+/*
+ * Filter-driven dissection depth; see set_dissection_depth_protocols().
+ * The needed protocols get an index, and depth_seen holds, for each
+ * index, the packet generation in which the protocol was last seen.
+ */
+static GArray *depth_protocols = NULL;	/* gint, set by the filters */
+static GArray *depth_stateful = NULL;	/* gint, set by the dissectors */
+static GArray *depth_index = NULL;	/* index + 1 by protocol ID, 0 if not needed */
+static guint  *depth_seen = NULL;
+static guint   depth_needed = 0;	/* number of needed protocols, 0 to dissect everything */
+static guint   depth_seen_count = 0;	/* number of them seen in this packet */
+static guint   depth_generation = 1;
+
+/* Everything the filters need from this packet has been dissected */
+#define DEPTH_REACHED() \
+	(depth_needed != 0 && depth_seen_count == depth_needed)
+
+static gboolean
+depth_is_needed(const int proto_id)
+{
+	return proto_id >= 0 && (guint)proto_id < depth_index->len &&
+	    g_array_index(depth_index, guint, proto_id) != 0;
+}
+
+/* Once the depth is reached, the needed protocols are still called, for
+ * their further occurrences in the packet (the next PDU in a TCP segment,
+ * the inner header of IP in IP), but no other protocol is. */
+#define DEPTH_SKIP(proto_id) \
+	(DEPTH_REACHED() && !depth_is_needed(proto_id))
+
 static void
 destroy_heuristic_dissector_entry(gpointer data, gpointer user_data _U_)
 {
@@ -171,6 +201,22 @@ packet_cleanup(void)
 	g_hash_table_destroy(dissector_tables);
 	g_hash_table_destroy(registered_dissectors);
 	g_hash_table_destroy(heur_dissector_lists);
+
+	if (depth_protocols) {
+		g_array_free(depth_protocols, TRUE);
+		depth_protocols = NULL;
+	}
+	if (depth_stateful) {
+		g_array_free(depth_stateful, TRUE);
+		depth_stateful = NULL;
+	}
+	if (depth_index) {
+		g_array_free(depth_index, TRUE);
+		depth_index = NULL;
+	}
+	g_free(depth_seen);
+	depth_seen = NULL;
+	depth_needed = 0;
 }
 
 /*
@@ -413,6 +459,121 @@ final_registration_all_protocols(void)
 }
 
 
+static void
+depth_add_protocol(const int proto_id)
+{
+	if (proto_id < 0)
+		return;
+	if ((guint)proto_id >= depth_index->len)
+		g_array_set_size(depth_index, proto_id + 1);
+	if (g_array_index(depth_index, guint, proto_id) == 0)
+		g_array_index(depth_index, guint, proto_id) = ++depth_needed;
+}
+
+static void
+depth_rebuild(void)
+{
+	guint i;
+
+	if (depth_index)
+		g_array_set_size(depth_index, 0);
+	else
+		depth_index = g_array_new(FALSE, TRUE, sizeof(guint));
+	depth_needed = 0;
+
+	/* Without filter protocols, dissect everything */
+	if (depth_protocols == NULL || depth_protocols->len == 0)
+		return;
+
+	for (i = 0; i < depth_protocols->len; i++)
+		depth_add_protocol(g_array_index(depth_protocols, gint, i));
+	if (depth_stateful) {
+		for (i = 0; i < depth_stateful->len; i++)
+			depth_add_protocol(g_array_index(depth_stateful, gint, i));
+	}
+
+	g_free(depth_seen);
+	depth_seen = g_new0(guint, depth_needed);
+	depth_seen_count = 0;
+	depth_generation = 1;
+}
+
+void
+set_dissection_depth_protocols(const int *protos, const guint num_protos)
+{
+	if (depth_protocols == NULL)
+		depth_protocols = g_array_new(FALSE, FALSE, sizeof(gint));
+	g_array_set_size(depth_protocols, 0);
+	g_array_append_vals(depth_protocols, protos, num_protos);
+	depth_rebuild();
+}
+
+void
+set_dissection_depth_stateful(const int proto, const gboolean stateful)
+{
+	guint i;
+
+	if (depth_stateful == NULL)
+		depth_stateful = g_array_new(FALSE, FALSE, sizeof(gint));
+	for (i = 0; i < depth_stateful->len; i++) {
+		if (g_array_index(depth_stateful, gint, i) == proto)
+			break;
+	}
+	if (stateful && i == depth_stateful->len)
+		g_array_append_val(depth_stateful, proto);
+	else if (!stateful && i < depth_stateful->len)
+		g_array_remove_index(depth_stateful, i);
+	else
+		return;
+	depth_rebuild();
+}
+
+static void
+depth_new_packet(void)
+{
+	if (depth_needed == 0)
+		return;
+
+	depth_seen_count = 0;
+	if (++depth_generation == 0) {
+		/* 0 is never a generation, so no protocol looks seen */
+		memset(depth_seen, 0, depth_needed * sizeof(guint));
+		depth_generation = 1;
+	}
+}
+
+/*
+ * Marks a needed protocol as seen in this packet. Returns its index + 1
+ * if it was not seen yet, so that depth_reject() can undo the mark if the
+ * dissector rejects the packet, else 0.
+ */
+static guint
+depth_enter(const int proto_id)
+{
+	guint idx;
+
+	if (depth_needed == 0 || proto_id < 0 || (guint)proto_id >= depth_index->len)
+		return 0;
+
+	idx = g_array_index(depth_index, guint, proto_id);
+	if (idx == 0 || depth_seen[idx - 1] == depth_generation)
+		return 0;
+
+	depth_seen[idx - 1] = depth_generation;
+	depth_seen_count++;
+	return idx;
+}
+
+static void
+depth_reject(const guint idx)
+{
+	if (idx == 0)
+		return;
+
+	depth_seen[idx - 1] = 0;
+	depth_seen_count--;
+}
+
 /* Creates the top-most tvbuff and calls dissect_frame() */
 void
 dissect_record(epan_dissect_t *edt, int file_type_subtype,
@@ -468,6 +629,7 @@ dissect_record(epan_dissect_t *edt, int file_type_subtype,
 	edt->pi.link_dir = LINK_DIR_UNKNOWN;
 	edt->pi.layers = wmem_list_new(edt->pi.pool);
 	edt->tvb = tvb;
+	depth_new_packet();
 
 
 	frame_delta_abs_time(edt->session, fd, fd->frame_ref_num, &edt->pi.rel_ts);
@@ -531,6 +693,7 @@ dissect_file(epan_dissect_t *edt, struct wtap_pkthdr *phdr,
 	edt->pi.link_dir = LINK_DIR_UNKNOWN;
 	edt->pi.layers = wmem_list_new(edt->pi.pool);
 	edt->tvb = tvb;
+	depth_new_packet();
 
 
 	frame_delta_abs_time(edt->session, fd, fd->frame_ref_num, &edt->pi.rel_ts);
@@ -650,6 +813,7 @@ call_dissector_work(dissector_handle_t handle, tvbuff_t *tvb, packet_info *pinfo
 	guint16      saved_can_desegment;
 	int          len;
 	guint        saved_layers_len = 0;
+	guint        depth_idx = 0;
 
 	if (handle->protocol != NULL &&
 	    !proto_is_protocol_enabled(handle->protocol)) {
@@ -659,6 +823,16 @@ call_dissector_work(dissector_handle_t handle, tvbuff_t *tvb, packet_info *pinfo
 		return 0;
 	}
 
+	if (handle->protocol != NULL &&
+	    DEPTH_SKIP(proto_get_id(handle->protocol))) {
+		/*
+		 * The filters have all they need from this packet,
+		 * and don't need this protocol; leave the data to the
+		 * caller, as if the dissector had rejected it.
+		 */
+		return 0;
+	}
+
 	saved_proto = pinfo->current_proto;
 	saved_can_desegment = pinfo->can_desegment;
 	saved_layers_len = wmem_list_count(pinfo->layers);
@@ -689,6 +863,7 @@ call_dissector_work(dissector_handle_t handle, tvbuff_t *tvb, packet_info *pinfo
 			pinfo->curr_layer_num++;
 			wmem_list_append(pinfo->layers, GINT_TO_POINTER(proto_get_id(handle->protocol)));
 		}
+		depth_idx = depth_enter(proto_get_id(handle->protocol));
 	}
 
 	if (pinfo->flags.in_error_pkt) {
@@ -708,6 +883,7 @@ call_dissector_work(dissector_handle_t handle, tvbuff_t *tvb, packet_info *pinfo
 		while (wmem_list_count(pinfo->layers) > saved_layers_len) {
 			wmem_list_remove_frame(pinfo->layers, wmem_list_tail(pinfo->layers));
 		}
+		depth_reject(depth_idx);
  	}
  	pinfo->current_proto = saved_proto;
  	pinfo->can_desegment = saved_can_desegment;
@@ -1975,6 +2151,66 @@ heur_dissector_set_enabled(const char *name, heur_dissector_t dissector, const i
 	}
 }
 
+/* Call the dissector of one heuristic entry, unless it or its protocol is
+ * disabled. The protocol is in the layers while the dissector runs, and
+ * stays there only if the dissector accepts the packet. The callers save
+ * and restore the rest of pinfo's state. */
+static gboolean
+call_heuristic_entry(heur_dtbl_entry_t *hdtbl_entry, tvbuff_t *tvb,
+		     packet_info *pinfo, proto_tree *tree, void *data,
+		     guint16 saved_can_desegment, guint saved_layers_len)
+{
+	int   proto_id;
+	guint depth_idx;
+
+	/* XXX - why set this now and above? */
+	pinfo->can_desegment = saved_can_desegment-(saved_can_desegment>0);
+
+	if (hdtbl_entry->protocol != NULL &&
+		(!proto_is_protocol_enabled(hdtbl_entry->protocol)||(hdtbl_entry->enabled==FALSE))) {
+		/*
+		 * No - don't try this dissector.
+		 */
+		return FALSE;
+	}
+
+	proto_id = hdtbl_entry->protocol != NULL ? proto_get_id(hdtbl_entry->protocol) : -1;
+	if (DEPTH_SKIP(proto_id)) {
+		/* The filters have all they need from this packet */
+		return FALSE;
+	}
+
+	if (hdtbl_entry->protocol != NULL) {
+		/* do NOT change this behavior - wslua uses the protocol short name set here in order
+		   to determine which Lua-based heurisitc dissector to call */
+		pinfo->current_proto =
+			proto_get_protocol_short_name(hdtbl_entry->protocol);
+
+		/*
+		 * Add the protocol name to the layers; we'll remove it
+		 * if the dissector fails.
+		 */
+		wmem_list_append(pinfo->layers, GINT_TO_POINTER(proto_id));
+	}
+
+	pinfo->heur_list_name = hdtbl_entry->list_name;
+	depth_idx = depth_enter(proto_id);
+
+	if ((hdtbl_entry->dissector)(tvb, pinfo, tree, data))
+		return TRUE;
+
+	/*
+	 * That dissector didn't accept the packet, so
+	 * remove its protocol's name from the list
+	 * of protocols.
+	 */
+	while (wmem_list_count(pinfo->layers) > saved_layers_len) {
+		wmem_list_remove_frame(pinfo->layers, wmem_list_tail(pinfo->layers));
+	}
+	depth_reject(depth_idx);
+	return FALSE;
+}
+
 gboolean
 dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 			packet_info *pinfo, proto_tree *tree, heur_dtbl_entry_t **heur_dtbl_entry, void *data)
@@ -1986,7 +2222,8 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 	guint16            saved_can_desegment;
 	guint              saved_layers_len = 0;
 	heur_dtbl_entry_t *hdtbl_entry;
-	int                proto_id;
+
+	*heur_dtbl_entry = NULL;
 
 	/* can_desegment is set to 2 by anyone which offers this api/service.
 	   then everytime a subdissector is called it is decremented by one.
@@ -2006,51 +2243,16 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 	saved_heur_list_name = pinfo->heur_list_name;
 
 	saved_layers_len = wmem_list_count(pinfo->layers);
-	*heur_dtbl_entry = NULL;
 
 	for (entry = sub_dissectors->dissectors; entry != NULL;
 	    entry = g_slist_next(entry)) {
-		/* XXX - why set this now and above? */
-		pinfo->can_desegment = saved_can_desegment-(saved_can_desegment>0);
 		hdtbl_entry = (heur_dtbl_entry_t *)entry->data;
 
-		if (hdtbl_entry->protocol != NULL &&
-			(!proto_is_protocol_enabled(hdtbl_entry->protocol)||(hdtbl_entry->enabled==FALSE))) {
-			/*
-			 * No - don't try this dissector.
-			 */
-			continue;
-		}
-
-		proto_id = proto_get_id(hdtbl_entry->protocol);
-		if (hdtbl_entry->protocol != NULL) {
-			/* do NOT change this behavior - wslua uses the protocol short name set here in order
-			   to determine which Lua-based heurisitc dissector to call */
-			pinfo->current_proto =
-				proto_get_protocol_short_name(hdtbl_entry->protocol);
-
-			/*
-			 * Add the protocol name to the layers; we'll remove it
-			 * if the dissector fails.
-			 */
-			wmem_list_append(pinfo->layers, GINT_TO_POINTER(proto_id));
-		}
-
-		pinfo->heur_list_name = hdtbl_entry->list_name;
-
-		if ((hdtbl_entry->dissector)(tvb, pinfo, tree, data)) {
+		if (call_heuristic_entry(hdtbl_entry, tvb, pinfo, tree, data,
+					 saved_can_desegment, saved_layers_len)) {
 			*heur_dtbl_entry = hdtbl_entry;
 			status = TRUE;
 			break;
-		} else {
-			/*
-			 * That dissector didn't accept the packet, so
-			 * remove its protocol's name from the list
-			 * of protocols.
-			 */
-			while (wmem_list_count(pinfo->layers) > saved_layers_len) {
-				wmem_list_remove_frame(pinfo->layers, wmem_list_tail(pinfo->layers));
-			}
 		}
 	}
 
@@ -2060,6 +2262,31 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 	return status;
 }
 
+gboolean
+dissector_try_heuristic_entry(heur_dtbl_entry_t *hdtbl_entry, tvbuff_t *tvb,
+			      packet_info *pinfo, proto_tree *tree, void *data)
+{
+	gboolean     status;
+	const char  *saved_curr_proto;
+	const char  *saved_heur_list_name;
+	guint16      saved_can_desegment;
+
+	/* See dissector_try_heuristic() for the handling of can_desegment. */
+	saved_can_desegment        = pinfo->can_desegment;
+	pinfo->saved_can_desegment = saved_can_desegment;
+
+	saved_curr_proto = pinfo->current_proto;
+	saved_heur_list_name = pinfo->heur_list_name;
+
+	status = call_heuristic_entry(hdtbl_entry, tvb, pinfo, tree, data,
+				      saved_can_desegment, wmem_list_count(pinfo->layers));
+
+	pinfo->current_proto = saved_curr_proto;
+	pinfo->heur_list_name = saved_heur_list_name;
+	pinfo->can_desegment = saved_can_desegment;
+	return status;
+}
+
 typedef struct heur_dissector_foreach_info {
 	gpointer      caller_data;
 	DATFunc_heur  caller_func;
@@ -408,6 +408,21 @@ WS_DLL_PUBLIC gboolean has_heur_dissector_list(const gchar *name);
 WS_DLL_PUBLIC gboolean dissector_try_heuristic(heur_dissector_list_t sub_dissectors,
     tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, heur_dtbl_entry_t **hdtbl_entry, void *data);
 
+/** Try a single heuristic dissector entry, such as one previously returned
+ *  by dissector_try_heuristic(). Unlike call_heur_dissector_direct(), the
+ *  dissector is allowed to reject the packet.
+ *
+ * @param hdtbl_entry the heuristic dissector entry to try
+ * @param tvb the tvbuff with the (remaining) packet data
+ * @param pinfo the packet info of this packet (additional info)
+ * @param tree the protocol tree to be build or NULL
+ * @param data parameter to pass to subdissector
+ * @return TRUE if the packet was recognized by the sub-dissector, FALSE if it
+ *  was rejected or the dissector (or its protocol) is disabled
+ */
+WS_DLL_PUBLIC gboolean dissector_try_heuristic_entry(heur_dtbl_entry_t *hdtbl_entry,
+    tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data);
+
 /** Find a heuristic dissector table by table name.
  *
  * @param name name of the dissector table
@@ -616,6 +631,31 @@ extern void dissect_file(struct epan_dissect *edt,
     struct wtap_pkthdr *phdr, tvbuff_t *tvb,
     frame_data *fd, column_info *cinfo);
 
+/*
+ * Filter-driven dissection depth.
+ *
+ * When filters are the only consumers of the dissection, the dissectors
+ * below the last protocol they need are wasted work. With a set of needed
+ * protocols, once all of them have been dissected in a packet, only their
+ * dissectors are still called for it, for their further occurrences such
+ * as the next PDU in a TCP segment; calls to the other dissectors return
+ * 0, as if they had rejected the data. Packets which lack one of the
+ * needed protocols are fully dissected.
+ *
+ * A needed protocol encapsulated inside a skipped one, such as the IP
+ * header quoted by ICMP, is not seen, and neither is anything that a
+ * protocol only knows from its sub-dissectors, such as "frame.protocols".
+ */
+
+/* Set the protocols the filters need, or none to dissect everything */
+WS_DLL_PUBLIC void set_dissection_depth_protocols(const int *protos,
+    const guint num_protos);
+
+/* Mark a protocol as needed whenever a dissection depth is set, for
+ * dissectors with stateful analysis that must see all their packets */
+WS_DLL_PUBLIC void set_dissection_depth_stateful(const int proto,
+    const gboolean stateful);
+
 /* These functions are in packet-ethertype.c */
 extern void capture_ethertype(guint16 etype, const guchar *pd, int offset,
 		int len, packet_counts *ld);
@@ -351,6 +351,12 @@ static guint32 *tree_is_expanded;
 /* Number of elements in that array. */
 int		num_tree_types;
 
+/* Interesting field slots. Every field which a filter refers to gets a
+   small index, its slot, so that a primed tree can keep the items of
+   the interesting fields in an array rather than a hash table. */
+static GArray *interesting_slots = NULL;	/* slot + 1 by field ID, 0 for none */
+static GArray *interesting_slot_hfids = NULL;	/* field ID by slot */
+
 /* Name hashtables for fast detection of duplicate names */
 static GHashTable* proto_names        = NULL;
 static GHashTable* proto_short_names  = NULL;
@@ -573,6 +579,16 @@ proto_cleanup(void)
 
 	g_free(tree_is_expanded);
 	tree_is_expanded = NULL;
+
+	if (interesting_slots) {
+		g_array_free(interesting_slots, TRUE);
+		interesting_slots = NULL;
+	}
+
+	if (interesting_slot_hfids) {
+		g_array_free(interesting_slot_hfids, TRUE);
+		interesting_slot_hfids = NULL;
+	}
 }
 
 static gboolean
@@ -646,28 +662,38 @@ proto_tree_children_foreach(proto_tree *tree, proto_tree_foreach_func func,
 	}
 }
 
+/* Empty the arrays of the interesting fields which have items in the
+   tree, keeping them for the next packet. Only the slots in use are
+   visited, so this is cheap however many fields are interesting. */
 static void
-free_GPtrArray_value(gpointer key, gpointer value, gpointer user_data _U_)
+tree_data_clear_interesting(tree_data_t *tree_data)
 {
-	GPtrArray         *ptrs = (GPtrArray *)value;
-	gint               hfid = (gint)(long)key;
+	guint              i;
+	guint              slot;
+	gint               hfid;
 	header_field_info *hfinfo;
 
-	PROTO_REGISTRAR_GET_NTH(hfid, hfinfo);
-	if (hfinfo->ref_type != HF_REF_TYPE_NONE) {
-		/* when a field is referenced by a filter this also
-		   affects the refcount for the parent protocol so we need
-		   to adjust the refcount for the parent as well
-		*/
-		if (hfinfo->parent != -1) {
-			header_field_info *parent_hfinfo;
-			PROTO_REGISTRAR_GET_NTH(hfinfo->parent, parent_hfinfo);
-			parent_hfinfo->ref_type = HF_REF_TYPE_NONE;
+	for (i = 0; i < tree_data->interesting_count; i++) {
+		slot = tree_data->interesting_used[i];
+		hfid = g_array_index(interesting_slot_hfids, gint, slot);
+
+		PROTO_REGISTRAR_GET_NTH(hfid, hfinfo);
+		if (hfinfo->ref_type != HF_REF_TYPE_NONE) {
+			/* when a field is referenced by a filter this also
+			   affects the refcount for the parent protocol so we need
+			   to adjust the refcount for the parent as well
+			*/
+			if (hfinfo->parent != -1) {
+				header_field_info *parent_hfinfo;
+				PROTO_REGISTRAR_GET_NTH(hfinfo->parent, parent_hfinfo);
+				parent_hfinfo->ref_type = HF_REF_TYPE_NONE;
+			}
+			hfinfo->ref_type = HF_REF_TYPE_NONE;
 		}
-		hfinfo->ref_type = HF_REF_TYPE_NONE;
-	}
 
-	g_ptr_array_free(ptrs, TRUE);
+		g_ptr_array_set_size(tree_data->interesting[slot], 0);
+	}
+	tree_data->interesting_count = 0;
 }
 
 static void
@@ -687,15 +713,8 @@ proto_tree_reset(proto_tree *tree)
 
 	proto_tree_children_foreach(tree, proto_tree_free_node, NULL);
 
-	/* free tree data */
-	if (tree_data->interesting_hfids) {
-		/* Free all the GPtrArray's in the interesting_hfids hash. */
-		g_hash_table_foreach(tree_data->interesting_hfids,
-			free_GPtrArray_value, NULL);
-
-		/* And then remove all values. */
-		g_hash_table_remove_all(tree_data->interesting_hfids);
-	}
+	/* reset tree data, keeping the interesting field arrays */
+	tree_data_clear_interesting(tree_data);
 
 	/* Reset track of the number of children */
 	tree_data->count = 0;
@@ -708,18 +727,18 @@ void
 proto_tree_free(proto_tree *tree)
 {
 	tree_data_t *tree_data = PTREE_DATA(tree);
+	guint        i;
 
 	proto_tree_children_foreach(tree, proto_tree_free_node, NULL);
 
 	/* free tree data */
-	if (tree_data->interesting_hfids) {
-		/* Free all the GPtrArray's in the interesting_hfids hash. */
-		g_hash_table_foreach(tree_data->interesting_hfids,
-			free_GPtrArray_value, NULL);
-
-		/* And then destroy the hash. */
-		g_hash_table_destroy(tree_data->interesting_hfids);
+	tree_data_clear_interesting(tree_data);
+	for (i = 0; i < tree_data->interesting_size; i++) {
+		if (tree_data->interesting[i])
+			g_ptr_array_free(tree_data->interesting[i], TRUE);
 	}
+	g_free(tree_data->interesting);
+	g_free(tree_data->interesting_used);
 
 	g_slice_free(tree_data_t, tree_data);
 
@@ -1598,24 +1617,32 @@ tree_data_add_maybe_interesting_field(tree_data_t *tree_data, field_info *fi)
 	const header_field_info *hfinfo = fi->hfinfo;
 
 	if (hfinfo->ref_type == HF_REF_TYPE_DIRECT) {
-		GPtrArray *ptrs = NULL;
-
-		if (tree_data->interesting_hfids == NULL) {
-			/* Initialize the hash because we now know that it is needed */
-			tree_data->interesting_hfids =
-				g_hash_table_new(g_direct_hash, NULL /* g_direct_equal */);
-		} else if (g_hash_table_size(tree_data->interesting_hfids)) {
-			ptrs = (GPtrArray *)g_hash_table_lookup(tree_data->interesting_hfids,
-					   GINT_TO_POINTER(hfinfo->id));
+		GPtrArray *ptrs;
+		guint      slot;
+
+		/* Primed fields always have a slot */
+		slot = g_array_index(interesting_slots, guint, hfinfo->id) - 1;
+
+		if (slot >= tree_data->interesting_size) {
+			/* Make room for all the slots assigned so far */
+			guint size = interesting_slot_hfids->len;
+
+			tree_data->interesting = g_renew(GPtrArray *, tree_data->interesting, size);
+			memset(tree_data->interesting + tree_data->interesting_size, 0,
+			       (size - tree_data->interesting_size) * sizeof(GPtrArray *));
+			tree_data->interesting_used = g_renew(guint, tree_data->interesting_used, size);
+			tree_data->interesting_size = size;
 		}
 
+		ptrs = tree_data->interesting[slot];
 		if (!ptrs) {
 			/* First element triggers the creation of pointer array */
 			ptrs = g_ptr_array_new();
-			g_hash_table_insert(tree_data->interesting_hfids,
-					    GINT_TO_POINTER(hfinfo->id), ptrs);
+			tree_data->interesting[slot] = ptrs;
 		}
 
+		if (ptrs->len == 0)
+			tree_data->interesting_used[tree_data->interesting_count++] = slot;
 		g_ptr_array_add(ptrs, fi);
 	}
 }
@@ -4934,8 +4961,11 @@ proto_tree_create_root(packet_info *pinfo)
 	/* Make sure we can access pinfo everywhere */
 	pnode->tree_data->pinfo = pinfo;
 
-	/* Don't initialize the tree_data_t. Wait until we know we need it */
-	pnode->tree_data->interesting_hfids = NULL;
+	/* Don't allocate the interesting field arrays. Wait until we know we need them */
+	pnode->tree_data->interesting = NULL;
+	pnode->tree_data->interesting_size = 0;
+	pnode->tree_data->interesting_used = NULL;
+	pnode->tree_data->interesting_count = 0;
 
 	/* Set the default to FALSE so it's easier to
 	 * find errors; if we expect to see the protocol tree
@@ -4961,6 +4991,8 @@ proto_tree_prime_hfid(proto_tree *tree _U_, const gint hfid)
 	header_field_info *hfinfo;
 
 	PROTO_REGISTRAR_GET_NTH(hfid, hfinfo);
+	/* Fields primed other than through a filter get their slot now */
+	proto_register_interesting_hfid(hfid);
 	/* this field is referenced by a filter so increase the refcount.
 	   also increase the refcount for the parent, i.e the protocol.
 	*/
@@ -4981,6 +5013,28 @@ proto_tree_prime_hfid(proto_tree *tree _U_, const gint hfid)
 	}
 }
 
+void
+proto_register_interesting_hfid(const int hfid)
+{
+	guint slot;
+
+	if (interesting_slots == NULL) {
+		interesting_slots = g_array_new(FALSE, TRUE, sizeof(guint));
+		interesting_slot_hfids = g_array_new(FALSE, FALSE, sizeof(gint));
+	}
+
+	if ((guint)hfid >= interesting_slots->len) {
+		/* The array is zero-filled, so the new fields have no slot */
+		g_array_set_size(interesting_slots, gpa_hfinfo.len);
+	}
+	if (g_array_index(interesting_slots, guint, hfid) != 0)
+		return;
+
+	slot = interesting_slot_hfids->len;
+	g_array_append_val(interesting_slot_hfids, hfid);
+	g_array_index(interesting_slots, guint, hfid) = slot + 1;
+}
+
 proto_tree *
 proto_item_add_subtree(proto_item *pi,	const gint idx) {
 	field_info *fi;
@@ -7214,27 +7268,38 @@ proto_check_for_protocol_or_field(const proto_tree* tree, const int id)
 GPtrArray *
 proto_get_finfo_ptr_array(const proto_tree *tree, const int id)
 {
+	tree_data_t *tree_data;
+	GPtrArray   *ptrs;
+	guint        slot;
+
 	if (!tree)
 		return NULL;
 
-	if (PTREE_DATA(tree)->interesting_hfids != NULL)
-		return (GPtrArray *)g_hash_table_lookup(PTREE_DATA(tree)->interesting_hfids,
-					   GINT_TO_POINTER(id));
-	else
+	tree_data = PTREE_DATA(tree);
+	if (interesting_slots == NULL || (guint)id >= interesting_slots->len)
 		return NULL;
+
+	slot = g_array_index(interesting_slots, guint, id);
+	if (slot == 0 || slot > tree_data->interesting_size)
+		return NULL;
+
+	/* An array kept from an earlier packet is empty; callers expect
+	   NULL for a field without items, as they got before the arrays
+	   were reused. */
+	ptrs = tree_data->interesting[slot - 1];
+	if (!ptrs || ptrs->len == 0)
+		return NULL;
+
+	return ptrs;
 }
 
 gboolean
 proto_tracking_interesting_fields(const proto_tree *tree)
 {
-	GHashTable *interesting_hfids;
-
 	if (!tree)
 		return FALSE;
 
-	interesting_hfids = PTREE_DATA(tree)->interesting_hfids;
-
-	return (interesting_hfids != NULL) && g_hash_table_size(interesting_hfids);
+	return PTREE_DATA(tree)->interesting_count != 0;
 }
 
 /* Helper struct for proto_find_info() and	proto_all_finfos() */
@@ -674,7 +674,10 @@ typedef struct
 /** One of these exists for the entire protocol tree. Each proto_node
  * in the protocol tree points to the same copy. */
 typedef struct {
-    GHashTable  *interesting_hfids;
+    GPtrArray  **interesting;       /**< field_info arrays by interesting field slot */
+    guint        interesting_size;  /**< allocated length of interesting */
+    guint       *interesting_used;  /**< slots with items in this tree, interesting_size long */
+    guint        interesting_count; /**< number of entries in interesting_used */
     gboolean     visible;
     gboolean     fake_protocols;
     gint         count;
@@ -938,6 +941,15 @@ proto_tree_set_fake_protocols(proto_tree *tree, gboolean fake_protocols);
 extern void
 proto_tree_prime_hfid(proto_tree *tree, const int hfid);
 
+/** Assign an interesting field slot to a field/protocol ID, unless it
+    has one already. Primed trees collect the items of each interesting
+    field in an array indexed by its slot. Display filters assign the
+    slots of their fields when they are compiled, rather than when a
+    tree is primed.
+ @param hfid the field id */
+extern void
+proto_register_interesting_hfid(const int hfid);
+
 /** Get a parent item of a subtree.
  @param tree the tree to get the parent from
  @return parent item */
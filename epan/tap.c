@@ -68,6 +68,7 @@ typedef struct _tap_listener_t {
 	gboolean needs_redraw;
 	guint flags;
 	dfilter_t *code;
+	int filter_idx;		/* index of code in tap_filter_set */
 	void *tapdata;
 	tap_reset_cb reset;
 	tap_packet_cb packet;
@@ -75,6 +76,13 @@ typedef struct _tap_listener_t {
 } tap_listener_t;
 static volatile tap_listener_t *tap_listener_queue=NULL;
 
+/* The filters of all tap listeners, applied together so that each field
+   is read once per packet and each filter is applied once per packet,
+   however many tapped packets it is tested against. Rebuilt when a
+   listener or its filter changes. */
+static dfilter_set_t *tap_filter_set=NULL;
+static gboolean tap_filter_set_dirty=TRUE;
+
 #ifdef HAVE_PLUGINS
 
 #include <gmodule.h>
@@ -295,6 +303,21 @@ tap_queue_init(epan_dissect_t *edt)
 	tap_build_interesting (edt);
 }
 
+static void
+tap_build_filter_set(void)
+{
+	tap_listener_t *tl;
+
+	dfilter_set_free(tap_filter_set);
+	tap_filter_set=dfilter_set_new();
+	for(tl=(tap_listener_t *)tap_listener_queue;tl;tl=tl->next){
+		if(tl->code){
+			tl->filter_idx=dfilter_set_add(tap_filter_set, tl->code);
+		}
+	}
+	tap_filter_set_dirty=FALSE;
+}
+
 /* this function is called after a packet has been fully dissected to push the tapped
    data to all extensions that has callbacks registered.
 */
@@ -317,6 +340,11 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 		return;
 	}
 
+	if(tap_filter_set_dirty){
+		tap_build_filter_set();
+	}
+	dfilter_set_reset(tap_filter_set);
+
 	/* loop over all tap listeners and call the listener callback
 	   for all packets that match the filter. */
 	for(i=0;i<tap_packet_index;i++){
@@ -325,7 +353,7 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 			if(tp->tap_id==tl->tap_id){
 				gboolean passed=TRUE;
 				if(tl->code){
-					passed=dfilter_apply_edt(tl->code, edt);
+					passed=dfilter_set_apply_edt(tap_filter_set, tl->filter_idx, edt);
 				}
 				if(passed && tl->packet){
 					tl->needs_redraw|=tl->packet(tl->tapdata, tp->pinfo, edt, tp->tap_specific_data);
@@ -483,6 +511,7 @@ register_tap_listener(const char *tapname, void *tapdata, const char *fstring,
 
 	tl=(tap_listener_t *)g_malloc(sizeof(tap_listener_t));
 	tl->code=NULL;
+	tl->filter_idx=-1;
 	tl->needs_redraw=TRUE;
 	tl->flags=flags;
 	if(fstring){
@@ -505,6 +534,7 @@ register_tap_listener(const char *tapname, void *tapdata, const char *fstring,
 	tl->next=(tap_listener_t *)tap_listener_queue;
 
 	tap_listener_queue=tl;
+	tap_filter_set_dirty=TRUE;
 
 	return NULL;
 }
@@ -539,6 +569,7 @@ set_tap_dfilter(void *tapdata, const char *fstring)
 			dfilter_free(tl->code);
 			tl->code=NULL;
 		}
+		tap_filter_set_dirty=TRUE;
 		tl->needs_redraw=TRUE;
 		if(fstring){
 			if(!dfilter_compile(fstring, &tl->code, &err_msg)){
@@ -585,6 +616,7 @@ remove_tap_listener(void *tapdata)
 			dfilter_free(tl->code);
 		}
 		g_free(tl);
+		tap_filter_set_dirty=TRUE;
 	}
 
 	return;
@@ -641,6 +673,45 @@ have_filtering_tap_listeners(void)
 	return FALSE;
 }
 
+/*
+ * Add to protos the protocols which the tap listeners need, for
+ * set_dissection_depth_protocols(): the protocol of each tap, and those
+ * of the listener filters. Return FALSE if a listener needs the whole
+ * dissection: it reads the protocol tree or the columns, or listens to
+ * a tap which isn't named after a protocol.
+ */
+gboolean
+tap_listeners_needed_protocols(GArray *protos)
+{
+	tap_listener_t *tl;
+	tap_dissector_t *td;
+	int i, proto_id;
+	guint j;
+
+	for(tl=(tap_listener_t *)tap_listener_queue;tl;tl=tl->next){
+		if(tl->flags&(TL_REQUIRES_PROTO_TREE|TL_REQUIRES_COLUMNS))
+			return FALSE;
+
+		for(i=1,td=tap_dissector_list;td && i!=tl->tap_id;i++,td=td->next)
+			;
+		if(!td)
+			return FALSE;
+		proto_id=proto_get_id_by_filter_name(td->name);
+		if(proto_id==-1)
+			return FALSE;
+		for(j=0;j<protos->len;j++){
+			if(g_array_index(protos, int, j)==proto_id)
+				break;
+		}
+		if(j==protos->len)
+			g_array_append_val(protos, proto_id);
+
+		if(tl->code && !dfilter_needed_protocols(tl->code, protos))
+			return FALSE;
+	}
+	return TRUE;
+}
+
 /*
  * Get the union of all the flags for all the tap listeners; that gives
  * an indication of whether the protocol tree, or the columns, are
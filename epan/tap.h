@@ -232,6 +232,13 @@ WS_DLL_PUBLIC gboolean have_tap_listener(int tap_id);
 /** Return TRUE if we have any tap listeners with filters, FALSE otherwise. */
 WS_DLL_PUBLIC gboolean have_filtering_tap_listeners(void);
 
+/**
+ * Add to protos (a GArray of int) the protocols which the tap listeners
+ * need, for set_dissection_depth_protocols(). Return FALSE if a listener
+ * needs the whole dissection of every packet.
+ */
+WS_DLL_PUBLIC gboolean tap_listeners_needed_protocols(GArray *protos);
+
 /**
  * Get the union of all the flags for all the tap listeners; that gives
  * an indication of whether the protocol tree, or the columns, are
@@ -0,0 +1,772 @@
+/* aerondump.c
+ * aerondump is an extcap tool which generates synthetic Aeron traffic,
+ * for load testing live capture and Aeron analysis without a network
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Every session/stream pair is a publication from 10.0.0.1 to a single
+ * receiver at 10.0.0.2. Publications take turns sending DATA frames (and a
+ * PAD frame at the end of each term); the receiver answers every few DATA
+ * frames with a status message. Each publication starts with a SETUP frame.
+ *
+ * Loss drops a DATA frame after its term position has been used, so the
+ * receiver side sees a gap. Reordering holds a DATA frame back and sends it
+ * after the next DATA frame of the same publication. All randomness comes
+ * from a seeded generator, so a given set of options always produces the
+ * same packets; only the timestamps differ.
+ *
+ * The packet rate is a target. If the capture pipe cannot keep up, writes
+ * block and the generator falls behind schedule, which is reported on
+ * stderr once a second.
+ */
+#include "config.h"
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_UNISTD_H
+    #include <unistd.h>
+#endif
+
+#ifdef HAVE_GETOPT_H
+    #include <getopt.h>
+#endif
+
+#ifndef HAVE_GETOPT_LONG
+    #include "wsutil/wsgetopt.h"
+#endif
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+    #ifdef HAVE_WINDOWS_H
+        #include <windows.h>
+    #endif
+#endif
+
+#include "wiretap/wtap.h"
+
+#define INTERFACE_AERON_SYNTHETIC       "aeron-synthetic"
+
+#define AERONDUMP_VERSION_MAJOR    1
+#define AERONDUMP_VERSION_MINOR    0
+#define AERONDUMP_VERSION_RELEASE  0
+
+#define PACKET_LENGTH 65535
+
+/* Ethernet, IPv4 and UDP headers in front of every Aeron frame */
+#define ETH_LEN         14
+#define IP_LEN          20
+#define UDP_LEN         8
+#define HDR_LEN         (ETH_LEN + IP_LEN + UDP_LEN)
+
+/* Aeron frame types, flags and lengths */
+#define HDR_TYPE_PAD    0x0000
+#define HDR_TYPE_DATA   0x0001
+#define HDR_TYPE_SM     0x0003
+#define HDR_TYPE_SETUP  0x0005
+
+#define FLAGS_BEGIN     0x80
+#define FLAGS_END       0x40
+
+#define L_DATA          24
+#define L_SM            28
+#define L_SETUP         36
+
+#define FRAME_ALIGN(len)    (((len) + 7) & ~7)
+
+#define TERM_LENGTH     (64 * 1024)
+#define MTU             8192
+#define MAX_PAYLOAD     (MTU - L_DATA)
+#define SM_WINDOW       (128 * 1024)
+
+#define PUBLISHER_PORT  40124
+
+#define DEFAULT_RATE         1000
+#define DEFAULT_SESSIONS     1
+#define DEFAULT_STREAMS      1
+#define DEFAULT_PAYLOAD      256
+#define DEFAULT_SM_INTERVAL  16
+#define DEFAULT_SEED         1
+#define DEFAULT_UDP_PORT     40123
+
+enum {
+    OPT_HELP = 1,
+    OPT_VERSION,
+    OPT_LIST_INTERFACES,
+    OPT_LIST_DLTS,
+    OPT_INTERFACE,
+    OPT_CONFIG,
+    OPT_CAPTURE,
+    OPT_FIFO,
+    OPT_CONFIG_RATE,
+    OPT_CONFIG_SESSIONS,
+    OPT_CONFIG_STREAMS,
+    OPT_CONFIG_PAYLOAD,
+    OPT_CONFIG_LOSS,
+    OPT_CONFIG_REORDER,
+    OPT_CONFIG_SM_INTERVAL,
+    OPT_CONFIG_COUNT,
+    OPT_CONFIG_SEED,
+    OPT_CONFIG_UDP_PORT
+};
+
+static struct option longopts[] = {
+    { "help",              no_argument,       NULL, OPT_HELP},
+    { "version",           no_argument,       NULL, OPT_VERSION},
+    { "extcap-interfaces", no_argument,       NULL, OPT_LIST_INTERFACES},
+    { "extcap-dlts",       no_argument,       NULL, OPT_LIST_DLTS},
+    { "extcap-interface",  required_argument, NULL, OPT_INTERFACE},
+    { "extcap-config",     no_argument,       NULL, OPT_CONFIG},
+    { "capture",           no_argument,       NULL, OPT_CAPTURE},
+    { "fifo",              required_argument, NULL, OPT_FIFO},
+    { "rate",              required_argument, NULL, OPT_CONFIG_RATE},
+    { "sessions",          required_argument, NULL, OPT_CONFIG_SESSIONS},
+    { "streams",           required_argument, NULL, OPT_CONFIG_STREAMS},
+    { "payload",           required_argument, NULL, OPT_CONFIG_PAYLOAD},
+    { "loss",              required_argument, NULL, OPT_CONFIG_LOSS},
+    { "reorder",           required_argument, NULL, OPT_CONFIG_REORDER},
+    { "sm-interval",       required_argument, NULL, OPT_CONFIG_SM_INTERVAL},
+    { "count",             required_argument, NULL, OPT_CONFIG_COUNT},
+    { "seed",              required_argument, NULL, OPT_CONFIG_SEED},
+    { "udp-port",          required_argument, NULL, OPT_CONFIG_UDP_PORT},
+    { 0, 0, 0, 0 }
+};
+
+struct generator_config {
+    unsigned int    rate;           /* Packets per second, 0 for as fast as possible */
+    unsigned int    sessions;
+    unsigned int    streams;
+    unsigned int    payload;        /* DATA payload length */
+    unsigned int    loss;           /* Per mille of DATA frames dropped */
+    unsigned int    reorder;        /* Per mille of DATA frames sent late */
+    unsigned int    sm_interval;    /* DATA frames per publication between status messages */
+    guint64         count;          /* Packets to write, 0 for no limit */
+    guint32         seed;
+    unsigned short  udp_port;       /* Receiver port */
+};
+
+struct publication {
+    guint32     session_id;
+    guint32     stream_id;
+    guint32     term_id;
+    guint32     term_offset;
+    guint32     completed_term_id;
+    guint32     completed_term_offset;
+    unsigned    data_count;         /* DATA frames since the last status message */
+    guint8     *held;               /* DATA frame held back for reordering */
+    size_t      held_length;
+};
+
+/* Globals */
+static int verbose = 0;
+
+/* Functions */
+static inline int is_specified_interface(char *interface, const char *interface_prefix) {
+    return !strncmp(interface, interface_prefix, strlen(interface_prefix));
+}
+
+static wtap_dumper *extcap_dumper_open(char *fifo) {
+    wtap_dumper  *dumper;
+    int           err = 0;
+
+    dumper = wtap_dump_open(fifo, WTAP_FILE_TYPE_SUBTYPE_PCAP_NSEC, WTAP_ENCAP_ETHERNET, PACKET_LENGTH, FALSE, &err);
+    if (!dumper) {
+        fprintf(stderr, "ERROR: Cannot open <%s>: %s\n", fifo, wtap_strerror(err));
+        return NULL;
+    }
+    wtap_dump_flush(dumper);
+
+    return dumper;
+}
+
+static int extcap_dumper_dump(wtap_dumper *dumper, const guint8 *buffer, size_t length) {
+    int                 err = 0;
+    char               *err_info = NULL;
+    struct wtap_pkthdr  hdr;
+    gint64              now = g_get_real_time();
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.rec_type = REC_TYPE_PACKET;
+    hdr.presence_flags = WTAP_HAS_TS;
+    hdr.caplen = (guint32) length;
+    hdr.len = (guint32) length;
+    hdr.pkt_encap = WTAP_ENCAP_ETHERNET;
+    hdr.ts.secs = (time_t) (now / G_USEC_PER_SEC);
+    hdr.ts.nsecs = (int) ((now % G_USEC_PER_SEC) * 1000);
+    hdr.pseudo_header.eth.fcs_len = 0;
+
+    if (!wtap_dump(dumper, &hdr, buffer, &err, &err_info)) {
+        fprintf(stderr, "ERROR: Cannot write packet: %s\n", wtap_strerror(err));
+        g_free(err_info);
+        return 0;
+    }
+    wtap_dump_flush(dumper);
+
+    return 1;
+}
+
+static void put_le16(guint8 *ptr, guint16 value) {
+    ptr[0] = value & 0xff;
+    ptr[1] = value >> 8;
+}
+
+static void put_le32(guint8 *ptr, guint32 value) {
+    ptr[0] = value & 0xff;
+    ptr[1] = (value >> 8) & 0xff;
+    ptr[2] = (value >> 16) & 0xff;
+    ptr[3] = value >> 24;
+}
+
+/* Build the Ethernet/IPv4/UDP headers in buffer and return where the Aeron frame goes */
+static guint8 *frame_start(guint8 *buffer, unsigned short udp_port, size_t aeron_length,
+        int from_publisher) {
+    guint16   ip_length = (guint16) (IP_LEN + UDP_LEN + aeron_length);
+    guint16   src_port = from_publisher ? PUBLISHER_PORT : udp_port;
+    guint16   dst_port = from_publisher ? udp_port : PUBLISHER_PORT;
+    guint32   sum = 0;
+    int       i;
+
+    memset(buffer, 0, HDR_LEN + aeron_length);
+
+    /* Ethernet */
+    buffer[5] = from_publisher ? 0x02 : 0x01;
+    buffer[11] = from_publisher ? 0x01 : 0x02;
+    buffer[12] = 0x08;
+
+    /* IPv4 */
+    buffer[14] = 0x45;
+    buffer[16] = ip_length >> 8;
+    buffer[17] = ip_length & 0xff;
+    buffer[20] = 0x40;
+    buffer[22] = 64;
+    buffer[23] = 17;
+    buffer[26] = 10;
+    buffer[29] = from_publisher ? 1 : 2;
+    buffer[30] = 10;
+    buffer[33] = from_publisher ? 2 : 1;
+    for (i = 0; i < IP_LEN; i += 2)
+        sum += (buffer[14 + i] << 8) | buffer[15 + i];
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    buffer[24] = (~sum >> 8) & 0xff;
+    buffer[25] = ~sum & 0xff;
+
+    /* UDP, without a checksum */
+    buffer[34] = src_port >> 8;
+    buffer[35] = src_port & 0xff;
+    buffer[36] = dst_port >> 8;
+    buffer[37] = dst_port & 0xff;
+    buffer[38] = (UDP_LEN + aeron_length) >> 8;
+    buffer[39] = (UDP_LEN + aeron_length) & 0xff;
+
+    return buffer + HDR_LEN;
+}
+
+static void put_header(guint8 *aeron, guint8 flags, guint16 type, guint32 frame_length) {
+    aeron[1] = flags;
+    put_le16(aeron + 2, type);
+    put_le32(aeron + 4, frame_length);
+}
+
+static size_t build_setup(guint8 *buffer, const struct generator_config *config,
+        const struct publication *pub) {
+    guint8  *aeron = frame_start(buffer, config->udp_port, L_SETUP, 1);
+
+    put_header(aeron, 0, HDR_TYPE_SETUP, L_SETUP);
+    put_le32(aeron + 8, pub->term_offset);
+    put_le32(aeron + 12, pub->session_id);
+    put_le32(aeron + 16, pub->stream_id);
+    put_le32(aeron + 20, pub->term_id);
+    put_le32(aeron + 24, pub->term_id);
+    put_le32(aeron + 28, TERM_LENGTH);
+    put_le32(aeron + 32, MTU);
+
+    return HDR_LEN + L_SETUP;
+}
+
+static size_t build_sm(guint8 *buffer, const struct generator_config *config,
+        const struct publication *pub) {
+    guint8  *aeron = frame_start(buffer, config->udp_port, L_SM, 0);
+
+    put_header(aeron, 0, HDR_TYPE_SM, L_SM);
+    put_le32(aeron + 8, pub->session_id);
+    put_le32(aeron + 12, pub->stream_id);
+    put_le32(aeron + 16, pub->completed_term_id);
+    put_le32(aeron + 20, pub->completed_term_offset);
+    put_le32(aeron + 24, SM_WINDOW);
+
+    return HDR_LEN + L_SM;
+}
+
+/*
+ * Build the next frame of a publication at its current term position and
+ * advance the position: a DATA frame, or a PAD frame filling the rest of the
+ * term when the DATA frame would not fit. *is_data tells which it was.
+ */
+static size_t build_next(guint8 *buffer, const struct generator_config *config,
+        struct publication *pub, guint64 sequence, int *is_data) {
+    guint32  frame_length = L_DATA + config->payload;
+    guint8  *aeron;
+
+    /* Never leave less room at the end of the term than a PAD frame needs */
+    if (pub->term_offset + FRAME_ALIGN(frame_length) != TERM_LENGTH &&
+            pub->term_offset + FRAME_ALIGN(frame_length) + L_DATA > TERM_LENGTH) {
+        frame_length = TERM_LENGTH - pub->term_offset;
+        aeron = frame_start(buffer, config->udp_port, L_DATA, 1);
+        put_header(aeron, 0, HDR_TYPE_PAD, frame_length);
+        *is_data = 0;
+    } else {
+        aeron = frame_start(buffer, config->udp_port, frame_length, 1);
+        put_header(aeron, FLAGS_BEGIN | FLAGS_END, HDR_TYPE_DATA, frame_length);
+        memset(aeron + L_DATA, (int) (sequence & 0xff), config->payload);
+        *is_data = 1;
+    }
+    put_le32(aeron + 8, pub->term_offset);
+    put_le32(aeron + 12, pub->session_id);
+    put_le32(aeron + 16, pub->stream_id);
+    put_le32(aeron + 20, pub->term_id);
+
+    pub->term_offset += FRAME_ALIGN(frame_length);
+    if (pub->term_offset >= TERM_LENGTH) {
+        pub->term_id++;
+        pub->term_offset = 0;
+    }
+
+    return HDR_LEN + (*is_data ? frame_length : L_DATA);
+}
+
+static int list_interfaces(void) {
+    printf("interface {display=Aeron synthetic traffic generator}{value=%s}\n",
+            INTERFACE_AERON_SYNTHETIC);
+
+    return 0;
+}
+
+static int list_dlts(char *interface) {
+    if (!interface) {
+        fprintf(stderr, "ERROR: No interface specified.\n");
+        return 1;
+    }
+
+    if (is_specified_interface(interface, INTERFACE_AERON_SYNTHETIC)) {
+        printf("dlt {number=1}{name=EN10MB}{display=Ethernet}\n");
+        return 0;
+    }
+
+    fprintf(stderr, "ERROR: Invalid interface: <%s>\n", interface);
+    return 1;
+}
+
+static int list_config(char *interface) {
+    if (!interface) {
+        fprintf(stderr, "ERROR: No interface specified.\n");
+        return 1;
+    }
+
+    if (is_specified_interface(interface, INTERFACE_AERON_SYNTHETIC)) {
+        printf("arg {number=0}{call=--rate}{display=Packets per second}{type=integer}{range=0,10000000}{default=%u}{tooltip=0 sends as fast as the capture pipe accepts packets}\n"
+                "arg {number=1}{call=--sessions}{display=Sessions}{type=integer}{range=1,1000}{default=%u}\n"
+                "arg {number=2}{call=--streams}{display=Streams per session}{type=integer}{range=1,1000}{default=%u}\n"
+                "arg {number=3}{call=--payload}{display=DATA payload length}{type=integer}{range=0,%u}{default=%u}\n"
+                "arg {number=4}{call=--loss}{display=Loss (per mille)}{type=integer}{range=0,1000}{default=0}{tooltip=DATA frames dropped per 1000}\n"
+                "arg {number=5}{call=--reorder}{display=Reordering (per mille)}{type=integer}{range=0,1000}{default=0}{tooltip=DATA frames sent late per 1000}\n"
+                "arg {number=6}{call=--sm-interval}{display=DATA frames per status message}{type=integer}{range=1,100000}{default=%u}\n"
+                "arg {number=7}{call=--count}{display=Packet count}{type=integer}{default=0}{tooltip=Stop after this many packets, 0 for no limit}\n"
+                "arg {number=8}{call=--seed}{display=Random seed}{type=integer}{default=%u}\n"
+                "arg {number=9}{call=--udp-port}{display=Receiver UDP port}{type=integer}{range=1,65535}{default=%u}\n",
+                DEFAULT_RATE, DEFAULT_SESSIONS, DEFAULT_STREAMS, MAX_PAYLOAD, DEFAULT_PAYLOAD,
+                DEFAULT_SM_INTERVAL, DEFAULT_SEED, DEFAULT_UDP_PORT);
+        return 0;
+    }
+
+    fprintf(stderr, "ERROR: Invalid interface: <%s>\n", interface);
+    return 1;
+}
+
+static void help(void) {
+    unsigned int  i_opt;
+
+    printf("Help\n");
+    printf(" Usage:\n"
+        " aerondump --extcap-interfaces\n"
+        " aerondump --extcap-interface=INTERFACE --extcap-dlts\n"
+        " aerondump --extcap-interface=INTERFACE --extcap-config\n"
+        " aerondump --extcap-interface=INTERFACE --fifo=PATH_FILENAME --capture \n");
+
+    printf("\n Parameters:\n");
+    for (i_opt = 0; i_opt < (sizeof(longopts) / sizeof(longopts[0])) - 1; i_opt += 1) {
+        printf("  --%s%s\n", longopts[i_opt].name,
+            (longopts[i_opt].has_arg == required_argument) ? "=<arg>" :
+            ((longopts[i_opt].has_arg == optional_argument) ? "[=arg]" : ""));
+    }
+
+}
+
+/*----------------------------------------------------------------------------*/
+/* Aeron synthetic traffic */
+/*----------------------------------------------------------------------------*/
+
+struct generator {
+    wtap_dumper                    *dumper;
+    const struct generator_config  *config;
+    guint64                         written;
+    gint64                          start;      /* Monotonic time of the first packet */
+    int                             failed;
+};
+
+/*
+ * Write one packet, keeping to the packet rate. Returns 0 once the packet
+ * count has been reached or when the write fails (setting failed).
+ */
+static int write_packet(struct generator *gen, const guint8 *buffer, size_t length) {
+    if (gen->config->count != 0 && gen->written >= gen->config->count)
+        return 0;
+
+    if (gen->config->rate != 0) {
+        gint64 due = gen->start + (gint64) ((gen->written * G_USEC_PER_SEC) / gen->config->rate);
+        gint64 now = g_get_monotonic_time();
+
+        if (due > now)
+            g_usleep((gulong) (due - now));
+    }
+
+    if (!extcap_dumper_dump(gen->dumper, buffer, length)) {
+        gen->failed = 1;
+        return 0;
+    }
+    gen->written += 1;
+
+    return 1;
+}
+
+static int capture_aeron_synthetic(char *fifo, const struct generator_config *config) {
+    struct generator     gen;
+    GRand               *prng;
+    struct publication  *pubs;
+    unsigned int         pub_count = config->sessions * config->streams;
+    unsigned int         i_pub;
+    guint8              *buffer;
+    size_t               length;
+    guint64              sequence = 0;
+    guint64              reported_lag = 0;
+    gint64               next_report;
+    gint64               elapsed;
+    int                  running = 1;
+    int                  err = 0;
+
+    gen.dumper = extcap_dumper_open(fifo);
+    if (!gen.dumper)
+        return 1;
+    gen.config = config;
+    gen.written = 0;
+    gen.failed = 0;
+
+    prng = g_rand_new_with_seed(config->seed);
+    buffer = (guint8 *) g_malloc(HDR_LEN + MTU);
+    pubs = g_new0(struct publication, pub_count);
+    for (i_pub = 0; i_pub < pub_count; i_pub += 1) {
+        pubs[i_pub].session_id = g_rand_int(prng);
+        if (i_pub % config->streams != 0)
+            pubs[i_pub].session_id = pubs[i_pub - 1].session_id;
+        pubs[i_pub].stream_id = 1 + i_pub % config->streams;
+        pubs[i_pub].term_id = g_rand_int(prng);
+        pubs[i_pub].completed_term_id = pubs[i_pub].term_id;
+    }
+
+    gen.start = g_get_monotonic_time();
+    next_report = gen.start + G_USEC_PER_SEC;
+
+    for (i_pub = 0; running && i_pub < pub_count; i_pub += 1) {
+        length = build_setup(buffer, config, &pubs[i_pub]);
+        running = write_packet(&gen, buffer, length);
+    }
+
+    while (running) {
+        struct publication  *pub = &pubs[sequence % pub_count];
+        int                  is_data;
+
+        length = build_next(buffer, config, pub, sequence, &is_data);
+        sequence += 1;
+
+        if (is_data && config->loss != 0 && g_rand_int_range(prng, 0, 1000) < (gint32) config->loss) {
+            /* Dropped: the position is used, but the frame never arrives */
+        } else if (is_data && !pub->held_length && config->reorder != 0 &&
+                g_rand_int_range(prng, 0, 1000) < (gint32) config->reorder) {
+            /* Most publications never reorder, so only allocate on the first frame held back */
+            if (!pub->held)
+                pub->held = (guint8 *) g_malloc(HDR_LEN + MTU);
+            memcpy(pub->held, buffer, length);
+            pub->held_length = length;
+        } else {
+            running = write_packet(&gen, buffer, length);
+            if (running && pub->held_length) {
+                running = write_packet(&gen, pub->held, pub->held_length);
+                pub->held_length = 0;
+            }
+        }
+
+        if (running && is_data && ++pub->data_count >= config->sm_interval) {
+            /* The receiver completes up to the frame it is still waiting for, if any */
+            if (!pub->held_length) {
+                pub->completed_term_id = pub->term_id;
+                pub->completed_term_offset = pub->term_offset;
+            }
+            pub->data_count = 0;
+            length = build_sm(buffer, config, pub);
+            running = write_packet(&gen, buffer, length);
+        }
+
+        if (config->rate != 0) {
+            gint64 now = g_get_monotonic_time();
+
+            if (now >= next_report) {
+                guint64 due = ((guint64) (now - gen.start) * config->rate) / G_USEC_PER_SEC;
+                guint64 lag = (due > gen.written) ? due - gen.written : 0;
+
+                if (lag > config->rate / 100 || (verbose && lag != reported_lag))
+                    fprintf(stderr, "aerondump: %" G_GINT64_MODIFIER "u packets written, %" G_GINT64_MODIFIER "u behind schedule\n",
+                            gen.written, lag);
+                reported_lag = lag;
+                next_report = now + G_USEC_PER_SEC;
+            }
+        }
+    }
+
+    elapsed = g_get_monotonic_time() - gen.start;
+    if (!gen.failed)
+        fprintf(stderr, "aerondump: %" G_GINT64_MODIFIER "u packets written in %.3f secs (%.0f packets/sec)\n",
+                gen.written, (double) elapsed / G_USEC_PER_SEC,
+                (elapsed > 0) ? ((double) gen.written * G_USEC_PER_SEC) / (double) elapsed : 0.0);
+
+    for (i_pub = 0; i_pub < pub_count; i_pub += 1)
+        g_free(pubs[i_pub].held);
+    g_free(pubs);
+    g_free(buffer);
+    g_rand_free(prng);
+    wtap_dump_close(gen.dumper, &err);
+
+    return gen.failed;
+}
+
+/*============================================================================*/
+
+#ifdef _WIN32
+BOOLEAN IsHandleRedirected(DWORD handle)
+{
+    HANDLE h = GetStdHandle(handle);
+    if (h) {
+        BY_HANDLE_FILE_INFORMATION fi;
+        if (GetFileInformationByHandle(h, &fi)) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static void attach_parent_console()
+{
+    BOOL outRedirected, errRedirected;
+
+    outRedirected = IsHandleRedirected(STD_OUTPUT_HANDLE);
+    errRedirected = IsHandleRedirected(STD_ERROR_HANDLE);
+
+    if (outRedirected && errRedirected) {
+        /* Both standard output and error handles are redirected.
+         * There is no point in attaching to parent process console.
+         */
+        return;
+    }
+
+    if (AttachConsole(ATTACH_PARENT_PROCESS) == 0) {
+        /* Console attach failed. */
+        return;
+    }
+
+    /* Console attach succeeded */
+    if (outRedirected == FALSE) {
+        freopen("CONOUT$", "w", stdout);
+    }
+
+    if (errRedirected == FALSE) {
+        freopen("CONOUT$", "w", stderr);
+    }
+}
+#endif
+
+int main(int argc, char **argv) {
+    int                      option_idx = 0;
+    int                      do_capture = 0;
+    int                      do_config = 0;
+    int                      do_list_interfaces = 0;
+    int                      do_dlts = 0;
+    int                      result;
+    char                    *fifo = NULL;
+    char                    *interface = NULL;
+    struct generator_config  config;
+
+#ifdef _WIN32
+    attach_parent_console();
+#endif  /* _WIN32 */
+
+    config.rate = DEFAULT_RATE;
+    config.sessions = DEFAULT_SESSIONS;
+    config.streams = DEFAULT_STREAMS;
+    config.payload = DEFAULT_PAYLOAD;
+    config.loss = 0;
+    config.reorder = 0;
+    config.sm_interval = DEFAULT_SM_INTERVAL;
+    config.count = 0;
+    config.seed = DEFAULT_SEED;
+    config.udp_port = DEFAULT_UDP_PORT;
+
+    opterr = 0;
+    optind = 0;
+
+    if (argc == 1) {
+        help();
+        return 0;
+    }
+
+    while ((result = getopt_long(argc, argv, "", longopts, &option_idx)) != -1) {
+        switch (result) {
+
+        case OPT_VERSION:
+            printf("%u.%u.%u\n", AERONDUMP_VERSION_MAJOR, AERONDUMP_VERSION_MINOR, AERONDUMP_VERSION_RELEASE);
+            return 0;
+        case OPT_LIST_INTERFACES:
+            do_list_interfaces = 1;
+            break;
+        case OPT_LIST_DLTS:
+            do_dlts = 1;
+            break;
+        case OPT_INTERFACE:
+            interface = strdup(optarg);
+            break;
+        case OPT_CONFIG:
+            do_config = 1;
+            break;
+        case OPT_CAPTURE:
+            do_capture = 1;
+            break;
+        case OPT_FIFO:
+            fifo = strdup(optarg);
+            break;
+        case OPT_HELP:
+            help();
+            return 0;
+        case OPT_CONFIG_RATE:
+            config.rate = (unsigned int) strtoul(optarg, NULL, 10);
+            break;
+        case OPT_CONFIG_SESSIONS:
+            config.sessions = (unsigned int) strtoul(optarg, NULL, 10);
+            break;
+        case OPT_CONFIG_STREAMS:
+            config.streams = (unsigned int) strtoul(optarg, NULL, 10);
+            break;
+        case OPT_CONFIG_PAYLOAD:
+            config.payload = (unsigned int) strtoul(optarg, NULL, 10);
+            break;
+        case OPT_CONFIG_LOSS:
+            config.loss = (unsigned int) strtoul(optarg, NULL, 10);
+            break;
+        case OPT_CONFIG_REORDER:
+            config.reorder = (unsigned int) strtoul(optarg, NULL, 10);
+            break;
+        case OPT_CONFIG_SM_INTERVAL:
+            config.sm_interval = (unsigned int) strtoul(optarg, NULL, 10);
+            break;
+        case OPT_CONFIG_COUNT:
+            config.count = g_ascii_strtoull(optarg, NULL, 10);
+            break;
+        case OPT_CONFIG_SEED:
+            config.seed = (guint32) strtoul(optarg, NULL, 10);
+            break;
+        case OPT_CONFIG_UDP_PORT:
+            config.udp_port = (unsigned short) strtoul(optarg, NULL, 10);
+            break;
+        default:
+            printf("Invalid argument <%s>. Try --help.\n", argv[optind - 1]);
+            return -1;
+        }
+    }
+
+    if (do_config)
+        return list_config(interface);
+
+    if (do_dlts)
+        return list_dlts(interface);
+
+    if (do_list_interfaces)
+        return list_interfaces();
+
+    if (fifo == NULL) {
+        printf("ERROR: No FIFO or file specified\n");
+        return 1;
+    }
+
+    if (config.sessions < 1 || config.sessions > 1000 || config.streams < 1 || config.streams > 1000) {
+        fprintf(stderr, "ERROR: Sessions and streams must be between 1 and 1000\n");
+        return 1;
+    }
+    if (config.payload > MAX_PAYLOAD) {
+        fprintf(stderr, "ERROR: Payload length must be at most %u\n", MAX_PAYLOAD);
+        return 1;
+    }
+    if (config.loss > 1000 || config.reorder > 1000) {
+        fprintf(stderr, "ERROR: Loss and reordering are per mille, at most 1000\n");
+        return 1;
+    }
+    if (config.sm_interval < 1)
+        config.sm_interval = 1;
+    if (config.udp_port == 0)
+        config.udp_port = DEFAULT_UDP_PORT;
+
+    if (do_capture) {
+        if (interface && is_specified_interface(interface, INTERFACE_AERON_SYNTHETIC))
+            return capture_aeron_synthetic(fifo, &config);
+        else
+            return 2;
+    }
+
+    return 0;
+}
+
+#ifdef _WIN32
+int CALLBACK WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
+        LPSTR lpCmdLine, int nCmdShow) {
+    return main(__argc, __argv);
+}
+#endif
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
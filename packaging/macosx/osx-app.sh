@@ -50,6 +50,7 @@ ui_toolkit="qt"
 wireshark_bin_name="wireshark"
 
 binary_list="
+	aerondump
 	androiddump
 	capinfos
 	dftest
@@ -30,6 +30,10 @@
 #include <epan/packet.h>
 #include <epan/prefs.h>
 #include <epan/proto.h>
+#include <epan/expert.h>
+#include <epan/crc32-tvb.h>
+#include <wsutil/crc32.h>
+#include <plugins/aeron/packet-aeron.h>
 #ifndef HAVE_INET_ATON
     #include <wsutil/inet_aton.h>
 #endif
@@ -40,6 +44,35 @@ static int hf_aerondata_magic = -1;
 static int hf_aerondata_checksum = -1;
 static int hf_aerondata_sqn = -1;
 static int hf_aerondata_data = -1;
+static int hf_aerondata_checksum_computed = -1;
+static int hf_aerondata_checksum_status = -1;
+static int hf_aerondata_sqn_expected = -1;
+static int hf_aerondata_sqn_gap = -1;
+static int hf_aerondata_sqn_prev_frame = -1;
+static int ett_aerondata_checksum = -1;
+static int ett_aerondata_sqn = -1;
+
+static expert_field ei_aerondata_sqn_gap = EI_INIT;
+static expert_field ei_aerondata_sqn_duplicate = EI_INIT;
+static expert_field ei_aerondata_sqn_reorder = EI_INIT;
+static expert_field ei_aerondata_checksum_bad = EI_INIT;
+static expert_field ei_aerondata_checksum_truncated = EI_INIT;
+
+/* Preferences */
+#define AERONDATA_CHECKSUM_NONE 0
+#define AERONDATA_CHECKSUM_CRC32 1
+#define AERONDATA_CHECKSUM_CRC32C 2
+
+static const enum_val_t aerondata_checksum_type[] =
+{
+    { "none", "None", AERONDATA_CHECKSUM_NONE },
+    { "crc32", "CRC-32", AERONDATA_CHECKSUM_CRC32 },
+    { "crc32c", "CRC-32C", AERONDATA_CHECKSUM_CRC32C },
+    { NULL, NULL, 0 }
+};
+
+static gboolean aerondata_sqn_analysis = TRUE;
+static gint aerondata_checksum = AERONDATA_CHECKSUM_NONE;
 
 #define O_AERONDATA_MAGIC 0
 #define O_AERONDATA_CHECKSUM 4
@@ -72,14 +105,237 @@ static gboolean test_aerondata_packet(tvbuff_t * tvb, packet_info * pinfo _U_, p
     return (FALSE);
 }
 
+/*
+    Sequence number analysis.
+
+    Application sequence numbers are tracked per (transport, session, stream), using the
+    payload information the Aeron dissector passes to payload dissectors. Each stream keeps
+    the highest sequence number seen and the ranges of sequence numbers skipped so far, so
+    a sequence number at or below the highest one is a reorder if it fills part of a skipped
+    range, and a duplicate otherwise.
+
+    The analysis is done once, on the first pass, and the result for each message is kept
+    as per-frame proto data along with the checksum, so re-dissecting a frame recomputes
+    neither.
+*/
+
+#define AERONDATA_SQN_GAP       0x00000001
+#define AERONDATA_SQN_DUPLICATE 0x00000002
+#define AERONDATA_SQN_REORDER   0x00000004
+
+#define AERONDATA_CHECKSUM_GOOD      1
+#define AERONDATA_CHECKSUM_BAD       2
+#define AERONDATA_CHECKSUM_TRUNCATED 3
+
+/*
+    Sequence numbers wrap, so they are compared with serial number arithmetic. The skipped ranges are kept
+    relative to the first sequence number seen on the stream, so that a range never straddles the wrap.
+*/
+typedef struct
+{
+    guint32 base_sqn;                       /* First sequence number seen */
+    guint32 high_sqn;
+    guint32 high_frame;
+    wmem_tree_t * missing;                  /* aerondata_range_t, keyed by the first missing sequence number less base_sqn */
+} aerondata_stream_t;
+
+typedef struct
+{
+    guint32 start;                          /* First missing sequence number of the range, less base_sqn */
+    guint32 end;                            /* Last missing sequence number of the range, less base_sqn */
+} aerondata_range_t;
+
+typedef struct
+{
+    guint32 flags;                          /* AERONDATA_SQN_* */
+    guint32 expected_sqn;
+    guint32 gap;                            /* Number of sequence numbers skipped (AERONDATA_SQN_GAP) */
+    guint32 prev_frame;                     /* Frame with the previous highest sequence number */
+    guint32 checksum;                       /* Computed checksum */
+    guint8 checksum_status;                 /* AERONDATA_CHECKSUM_*, or 0 if no checksum is configured */
+} aerondata_msg_info_t;
+
+/* aerondata_stream_t, keyed by (channel ID high, channel ID low, session ID, stream ID) */
+static wmem_tree_t * aerondata_streams = NULL;
+
+static void aerondata_init(void)
+{
+    aerondata_streams = wmem_tree_new(wmem_file_scope());
+}
+
+static aerondata_stream_t * aerondata_stream_find(const aeron_payload_info_t * payload_info)
+{
+    aerondata_stream_t * stream;
+    guint32 key_value[4];
+    wmem_tree_key_t key[2];
+
+    key_value[0] = (guint32) ((payload_info->channel_id >> 32) & G_GUINT64_CONSTANT(0x00000000ffffffff));
+    key_value[1] = (guint32) (payload_info->channel_id & G_GUINT64_CONSTANT(0x00000000ffffffff));
+    key_value[2] = payload_info->session_id;
+    key_value[3] = payload_info->stream_id;
+    key[0].length = 4;
+    key[0].key = key_value;
+    key[1].length = 0;
+    key[1].key = NULL;
+    stream = (aerondata_stream_t *) wmem_tree_lookup32_array(aerondata_streams, key);
+    if (stream == NULL)
+    {
+        stream = wmem_new0(wmem_file_scope(), aerondata_stream_t);
+        stream->missing = wmem_tree_new(wmem_file_scope());
+        wmem_tree_insert32_array(aerondata_streams, key, (void *) stream);
+    }
+    return (stream);
+}
+
+/* Remove sqn from the skipped ranges of a stream. Returns TRUE if it was missing. */
+static gboolean aerondata_stream_fill(aerondata_stream_t * stream, guint32 sqn)
+{
+    aerondata_range_t * range;
+    aerondata_range_t * tail;
+
+    sqn -= stream->base_sqn;
+
+    /* Ranges don't overlap, so only the range starting closest below sqn can contain it. Filled ranges are NULL. */
+    range = (aerondata_range_t *) wmem_tree_lookup32_le(stream->missing, sqn);
+    if ((range == NULL) || (range->end < sqn))
+    {
+        return (FALSE);
+    }
+    if (sqn < range->end)
+    {
+        tail = wmem_new(wmem_file_scope(), aerondata_range_t);
+        tail->start = sqn + 1;
+        tail->end = range->end;
+        wmem_tree_insert32(stream->missing, tail->start, (void *) tail);
+    }
+    if (sqn == range->start)
+    {
+        wmem_tree_insert32(stream->missing, range->start, NULL);
+    }
+    else
+    {
+        range->end = sqn - 1;
+    }
+    return (TRUE);
+}
+
+static void aerondata_sqn_analyze(aerondata_msg_info_t * msg_info, const aeron_payload_info_t * payload_info, guint32 sqn, packet_info * pinfo)
+{
+    aerondata_stream_t * stream = aerondata_stream_find(payload_info);
+
+    if (stream->high_frame == 0)
+    {
+        stream->base_sqn = sqn;
+        stream->high_sqn = sqn;
+        stream->high_frame = pinfo->fd->num;
+        msg_info->expected_sqn = sqn;
+        return;
+    }
+    msg_info->expected_sqn = stream->high_sqn + 1;
+    msg_info->prev_frame = stream->high_frame;
+    if ((gint32) (sqn - stream->high_sqn) > 0)
+    {
+        if (sqn != msg_info->expected_sqn)
+        {
+            aerondata_range_t * range = wmem_new(wmem_file_scope(), aerondata_range_t);
+
+            range->start = msg_info->expected_sqn - stream->base_sqn;
+            range->end = sqn - 1 - stream->base_sqn;
+            wmem_tree_insert32(stream->missing, range->start, (void *) range);
+            msg_info->flags |= AERONDATA_SQN_GAP;
+            msg_info->gap = sqn - msg_info->expected_sqn;
+        }
+        stream->high_sqn = sqn;
+        stream->high_frame = pinfo->fd->num;
+    }
+    else if (aerondata_stream_fill(stream, sqn))
+    {
+        msg_info->flags |= AERONDATA_SQN_REORDER;
+    }
+    else
+    {
+        msg_info->flags |= AERONDATA_SQN_DUPLICATE;
+    }
+}
+
+/*
+    Checksum of the message data. Returns 0 (not verified) if no checksum is configured, and
+    AERONDATA_CHECKSUM_TRUNCATED if the capture cut the data short.
+*/
+static guint8 aerondata_checksum_verify(tvbuff_t * tvb, guint32 * computed)
+{
+    guint len = (guint) tvb_reported_length_remaining(tvb, O_AERONDATA_DATA);
+    guint32 expected = tvb_get_letohl(tvb, O_AERONDATA_CHECKSUM);
+
+    if (aerondata_checksum == AERONDATA_CHECKSUM_NONE)
+    {
+        return (0);
+    }
+    if ((guint) tvb_captured_length_remaining(tvb, O_AERONDATA_DATA) < len)
+    {
+        return (AERONDATA_CHECKSUM_TRUNCATED);
+    }
+    switch (aerondata_checksum)
+    {
+        case AERONDATA_CHECKSUM_CRC32:
+            *computed = crc32_ccitt_tvb_offset(tvb, O_AERONDATA_DATA, len);
+            break;
+        case AERONDATA_CHECKSUM_CRC32C:
+            /* crc32c_tvb_offset_calculate() returns the register byte-swapped and not inverted. */
+            *computed = crc32c_tvb_offset_calculate(tvb, O_AERONDATA_DATA, len, CRC32C_PRELOAD);
+            *computed = ~CRC32C_SWAP(*computed);
+            break;
+        default:
+            return (0);
+    }
+    return ((*computed == expected) ? AERONDATA_CHECKSUM_GOOD : AERONDATA_CHECKSUM_BAD);
+}
+
+/* Per-frame message information, keyed by (session ID, stream ID, term ID, term offset) as a frame can carry several messages */
+static aerondata_msg_info_t * aerondata_msg_info_find(packet_info * pinfo, const aeron_payload_info_t * payload_info, gboolean create)
+{
+    wmem_tree_t * frame_msgs = (wmem_tree_t *) p_get_proto_data(wmem_file_scope(), pinfo, proto_aerondata, 0);
+    aerondata_msg_info_t * msg_info;
+    guint32 key_value[4];
+    wmem_tree_key_t key[2];
+
+    if (frame_msgs == NULL)
+    {
+        if (!create)
+        {
+            return (NULL);
+        }
+        frame_msgs = wmem_tree_new(wmem_file_scope());
+        p_add_proto_data(wmem_file_scope(), pinfo, proto_aerondata, 0, (void *) frame_msgs);
+    }
+    key_value[0] = payload_info->session_id;
+    key_value[1] = payload_info->stream_id;
+    key_value[2] = payload_info->term_id;
+    key_value[3] = payload_info->term_offset;
+    key[0].length = 4;
+    key[0].key = key_value;
+    key[1].length = 0;
+    key[1].key = NULL;
+    msg_info = (aerondata_msg_info_t *) wmem_tree_lookup32_array(frame_msgs, key);
+    if ((msg_info == NULL) && create)
+    {
+        msg_info = wmem_new0(wmem_file_scope(), aerondata_msg_info_t);
+        wmem_tree_insert32_array(frame_msgs, key, (void *) msg_info);
+    }
+    return (msg_info);
+}
+
 /*
  * dissect_aerondata - The dissector for Aeron message payloads
  */
 
-gboolean dissect_aerondata(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree, void * user_data _U_)
+gboolean dissect_aerondata(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree, void * user_data)
 {
     proto_tree * data_tree = NULL;
     proto_item * ti = NULL;
+    const aeron_payload_info_t * payload_info = (const aeron_payload_info_t *) user_data;
+    aerondata_msg_info_t * msg_info = NULL;
+    aerondata_msg_info_t local_msg_info;
 
     /*
         A heuristic (sub)dissector must return TRUE if it handled the packet, or
@@ -107,11 +363,98 @@ gboolean dissect_aerondata(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tre
     */
     col_append_sep_str(pinfo->cinfo, COL_INFO, NULL, "[Aeron Data]");
 
+    /*
+        The analysis needs the (session, stream) the message belongs to, which the Aeron
+        dissector passes as user_data. Do it on the first pass only, and keep the result.
+    */
+    if (payload_info != NULL)
+    {
+        if (PINFO_FD_VISITED(pinfo) == 0)
+        {
+            msg_info = aerondata_msg_info_find(pinfo, payload_info, TRUE);
+            if (aerondata_sqn_analysis)
+            {
+                aerondata_sqn_analyze(msg_info, payload_info, tvb_get_letohl(tvb, O_AERONDATA_SQN), pinfo);
+            }
+            msg_info->checksum_status = aerondata_checksum_verify(tvb, &(msg_info->checksum));
+        }
+        else
+        {
+            msg_info = aerondata_msg_info_find(pinfo, payload_info, FALSE);
+        }
+    }
+    if (msg_info == NULL)
+    {
+        /* No stored result (no payload information): verify the checksum only. */
+        memset((void *) &local_msg_info, 0, sizeof(aerondata_msg_info_t));
+        local_msg_info.checksum_status = aerondata_checksum_verify(tvb, &(local_msg_info.checksum));
+        msg_info = &local_msg_info;
+    }
+    if ((msg_info->flags & AERONDATA_SQN_GAP) != 0)
+    {
+        col_append_sep_str(pinfo->cinfo, COL_INFO, NULL, "[Sqn gap]");
+    }
+    if ((msg_info->flags & AERONDATA_SQN_DUPLICATE) != 0)
+    {
+        col_append_sep_str(pinfo->cinfo, COL_INFO, NULL, "[Duplicate sqn]");
+    }
+    if ((msg_info->flags & AERONDATA_SQN_REORDER) != 0)
+    {
+        col_append_sep_str(pinfo->cinfo, COL_INFO, NULL, "[Reordered sqn]");
+    }
+    if (msg_info->checksum_status == AERONDATA_CHECKSUM_BAD)
+    {
+        col_append_sep_str(pinfo->cinfo, COL_INFO, NULL, "[Bad checksum]");
+    }
+
     ti = proto_tree_add_protocol_format(tree, proto_aerondata, tvb, 0, -1, "Aeron Data");
     data_tree = proto_item_add_subtree(ti, ett_aerondata);
     proto_tree_add_item(data_tree, hf_aerondata_magic, tvb, O_AERONDATA_MAGIC, 4, ENC_LITTLE_ENDIAN);
-    proto_tree_add_item(data_tree, hf_aerondata_checksum, tvb, O_AERONDATA_CHECKSUM, 4, ENC_LITTLE_ENDIAN);
-    proto_tree_add_item(data_tree, hf_aerondata_sqn, tvb, O_AERONDATA_SQN, 4, ENC_LITTLE_ENDIAN);
+    ti = proto_tree_add_item(data_tree, hf_aerondata_checksum, tvb, O_AERONDATA_CHECKSUM, 4, ENC_LITTLE_ENDIAN);
+    if (msg_info->checksum_status == AERONDATA_CHECKSUM_TRUNCATED)
+    {
+        expert_add_info(pinfo, ti, &ei_aerondata_checksum_truncated);
+    }
+    else if (msg_info->checksum_status != 0)
+    {
+        proto_tree * checksum_tree = proto_item_add_subtree(ti, ett_aerondata_checksum);
+        proto_item * status_item;
+
+        ti = proto_tree_add_uint(checksum_tree, hf_aerondata_checksum_computed, tvb, O_AERONDATA_CHECKSUM, 4, msg_info->checksum);
+        PROTO_ITEM_SET_GENERATED(ti);
+        status_item = proto_tree_add_boolean(checksum_tree, hf_aerondata_checksum_status, tvb, O_AERONDATA_CHECKSUM, 4,
+            (msg_info->checksum_status == AERONDATA_CHECKSUM_BAD));
+        PROTO_ITEM_SET_GENERATED(status_item);
+        if (msg_info->checksum_status == AERONDATA_CHECKSUM_BAD)
+        {
+            expert_add_info(pinfo, status_item, &ei_aerondata_checksum_bad);
+        }
+    }
+    ti = proto_tree_add_item(data_tree, hf_aerondata_sqn, tvb, O_AERONDATA_SQN, 4, ENC_LITTLE_ENDIAN);
+    if (msg_info->prev_frame != 0)
+    {
+        proto_tree * sqn_tree = proto_item_add_subtree(ti, ett_aerondata_sqn);
+        proto_item * sqn_item;
+
+        sqn_item = proto_tree_add_uint(sqn_tree, hf_aerondata_sqn_expected, tvb, O_AERONDATA_SQN, 4, msg_info->expected_sqn);
+        PROTO_ITEM_SET_GENERATED(sqn_item);
+        sqn_item = proto_tree_add_uint(sqn_tree, hf_aerondata_sqn_prev_frame, tvb, 0, 0, msg_info->prev_frame);
+        PROTO_ITEM_SET_GENERATED(sqn_item);
+        if ((msg_info->flags & AERONDATA_SQN_GAP) != 0)
+        {
+            sqn_item = proto_tree_add_uint(sqn_tree, hf_aerondata_sqn_gap, tvb, O_AERONDATA_SQN, 4, msg_info->gap);
+            PROTO_ITEM_SET_GENERATED(sqn_item);
+            expert_add_info_format(pinfo, sqn_item, &ei_aerondata_sqn_gap, "Sequence gap: %" G_GUINT32_FORMAT " message(s) missing before this one", msg_info->gap);
+        }
+        if ((msg_info->flags & AERONDATA_SQN_DUPLICATE) != 0)
+        {
+            expert_add_info(pinfo, ti, &ei_aerondata_sqn_duplicate);
+        }
+        if ((msg_info->flags & AERONDATA_SQN_REORDER) != 0)
+        {
+            expert_add_info(pinfo, ti, &ei_aerondata_sqn_reorder);
+        }
+    }
     proto_tree_add_item(data_tree, hf_aerondata_data, tvb, O_AERONDATA_DATA, tvb_reported_length_remaining(tvb, O_AERONDATA_DATA), ENC_NA);
     return (TRUE);
 }
@@ -150,34 +493,60 @@ void proto_register_aerondata(void)
         { &hf_aerondata_sqn,
             { "Sequence Number", "aerondata.sqn", FT_UINT32, BASE_DEC_HEX, NULL, 0x0, "", HFILL } },
         { &hf_aerondata_data,
-            { "Data", "aerondata.data", FT_BYTES, BASE_NONE, NULL, 0x0, "", HFILL } }
+            { "Data", "aerondata.data", FT_BYTES, BASE_NONE, NULL, 0x0, "", HFILL } },
+        { &hf_aerondata_checksum_computed,
+            { "Computed Checksum", "aerondata.checksum.computed", FT_UINT32, BASE_DEC_HEX, NULL, 0x0, "", HFILL } },
+        { &hf_aerondata_checksum_status,
+            { "Bad Checksum", "aerondata.checksum.bad", FT_BOOLEAN, BASE_NONE, NULL, 0x0, "", HFILL } },
+        { &hf_aerondata_sqn_expected,
+            { "Expected Sequence Number", "aerondata.sqn.expected", FT_UINT32, BASE_DEC_HEX, NULL, 0x0, "", HFILL } },
+        { &hf_aerondata_sqn_gap,
+            { "Missing Sequence Numbers", "aerondata.sqn.gap", FT_UINT32, BASE_DEC, NULL, 0x0, "", HFILL } },
+        { &hf_aerondata_sqn_prev_frame,
+            { "Previous Highest Sequence Number Frame", "aerondata.sqn.prev_frame", FT_FRAMENUM, BASE_NONE, NULL, 0x0, "", HFILL } }
     };
     static gint * ett[] =
     {
-        &ett_aerondata
+        &ett_aerondata,
+        &ett_aerondata_checksum,
+        &ett_aerondata_sqn
     };
-
-    /*
-        If you need to allow customization of the dissector (via preferences),
-        include a declaration such as:
-
-        module_t * data_module;
-    */
+    static ei_register_info ei[] =
+    {
+        { &ei_aerondata_sqn_gap, { "aerondata.analysis.sqn_gap", PI_SEQUENCE, PI_WARN, "Sequence gap", EXPFILL } },
+        { &ei_aerondata_sqn_duplicate, { "aerondata.analysis.sqn_duplicate", PI_SEQUENCE, PI_NOTE, "Duplicate sequence number", EXPFILL } },
+        { &ei_aerondata_sqn_reorder, { "aerondata.analysis.sqn_reorder", PI_SEQUENCE, PI_NOTE, "Reordered sequence number (fills a gap)", EXPFILL } },
+        { &ei_aerondata_checksum_bad, { "aerondata.analysis.bad_checksum", PI_CHECKSUM, PI_ERROR, "Bad checksum", EXPFILL } },
+        { &ei_aerondata_checksum_truncated, { "aerondata.analysis.checksum_truncated", PI_CHECKSUM, PI_NOTE, "Checksum not verified: the message data is not fully captured", EXPFILL } }
+    };
+    module_t * aerondata_module;
+    expert_module_t * expert_aerondata;
 
     proto_aerondata = proto_register_protocol("Aeron Data", "AeronData", "aerondata");
     
     proto_register_field_array(proto_aerondata, hf, array_length(hf));
     proto_register_subtree_array(ett, array_length(ett));
+    expert_aerondata = expert_register_protocol(proto_aerondata);
+    expert_register_field_array(expert_aerondata, ei, array_length(ei));
 
     /*
-        If you need to allow customization of the dissector (via preferences), this
-        would be the place to register them:
-
-        data_module = prefs_register_protocol(proto_aerondata, proto_reg_handoff_aerondata);
-        prefs_register_uint_preference(aerondata_module, etc... );
-
-        See the Wireshark documentation source for examples.
+        Preferences customizing the dissector are registered here. As nothing needs to be
+        redone when they change, no callback is given.
     */
+    aerondata_module = prefs_register_protocol(proto_aerondata, NULL);
+    prefs_register_bool_preference(aerondata_module,
+        "sqn_analysis",
+        "Analyze sequence numbers",
+        "Track sequence numbers per Aeron session and stream, and flag gaps, duplicates and reordering.",
+        &aerondata_sqn_analysis);
+    prefs_register_enum_preference(aerondata_module,
+        "checksum",
+        "Verify checksum",
+        "Checksum algorithm used to verify the checksum field, computed over the message data following the sequence number.",
+        &aerondata_checksum,
+        aerondata_checksum_type,
+        FALSE);
+    register_init_routine(aerondata_init);
 }
 
 /*
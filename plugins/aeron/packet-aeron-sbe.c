@@ -0,0 +1,1354 @@
+/* packet-aeron-sbe.c
+ * Routines for Simple Binary Encoding (SBE) message payloads carried by Aeron,
+ * decoded using an SBE XML message schema.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * The schema named by the "schema_file" preference is parsed when the preferences
+ * are applied, and compiled into a table per message template: the fields of the
+ * fixed-length block (offset, length, encoding and a dynamically registered hf),
+ * followed by its repeating groups and variable-length data. Dissecting a message
+ * is then a single template ID lookup and a walk of that table.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <glib.h>
+#include <epan/packet.h>
+#include <epan/prefs.h>
+#include <epan/expert.h>
+#include <epan/range.h>
+#include <wsutil/report_err.h>
+#include "packet-aeron.h"
+
+void proto_register_aeron_sbe(void);
+void proto_reg_handoff_aeron_sbe(void);
+
+/* Protocol handle */
+static int proto_aeron_sbe = -1;
+
+/* Dissector handle */
+static dissector_handle_t aeron_sbe_dissector_handle;
+
+/* Preferences */
+static const gchar * global_aeron_sbe_schema_file = NULL;
+static range_t * global_aeron_sbe_stream_id_range = NULL;
+
+/* Limit on the nesting of composites, refs and groups, to catch recursive schemas */
+#define SBE_MAX_DEPTH 16
+
+/*----------------------------------------------------------------------------*/
+/* Compiled schema.                                                           */
+/*----------------------------------------------------------------------------*/
+
+/* Location of an unsigned integer (length, count or header field) relative to a base offset */
+typedef struct
+{
+    guint32 offset;
+    guint32 length;
+} sbe_uint_loc_t;
+
+/* A field of a fixed-length block. Offsets are relative to the start of the block. */
+typedef struct sbe_field_t_stct
+{
+    int * hf;
+    gint * ett;                             /* Subtree for the children, if any */
+    guint32 offset;
+    guint32 length;
+    guint encoding;
+    guint child_count;
+    struct sbe_field_t_stct * child;        /* Composite members, or set choices */
+} sbe_field_t;
+
+typedef struct sbe_block_t_stct sbe_block_t;
+
+/* A repeating group: a dimension header followed by numInGroup entries of blockLength bytes each (plus nested groups and data) */
+typedef struct
+{
+    int * hf;
+    guint32 header_length;
+    sbe_uint_loc_t block_length;
+    sbe_uint_loc_t num_in_group;
+    sbe_block_t * block;
+} sbe_group_t;
+
+/* Variable-length data: a length followed by the data */
+typedef struct
+{
+    int * hf;
+    guint32 header_length;
+    sbe_uint_loc_t length;
+    guint encoding;
+} sbe_data_t;
+
+struct sbe_block_t_stct
+{
+    guint field_count;
+    sbe_field_t * field;
+    guint group_count;
+    sbe_group_t * group;
+    guint data_count;
+    sbe_data_t * data;
+};
+
+typedef struct
+{
+    int * hf;
+    const gchar * name;
+    guint32 template_id;
+    sbe_block_t block;
+} sbe_message_t;
+
+typedef struct
+{
+    wmem_allocator_t * scope;               /* Everything below, other than the registered fields */
+    guint encoding;                         /* ENC_LITTLE_ENDIAN or ENC_BIG_ENDIAN */
+    guint32 schema_id;
+    guint32 version;
+    guint32 header_length;
+    sbe_uint_loc_t block_length;
+    sbe_uint_loc_t template_id;
+    sbe_uint_loc_t header_schema_id;
+    sbe_uint_loc_t header_version;
+    wmem_map_t * message;                   /* sbe_message_t, keyed by template ID */
+    hf_register_info * hf;
+    guint hf_count;
+} sbe_schema_t;
+
+static sbe_schema_t * aeron_sbe_schema = NULL;
+
+/*----------------------------------------------------------------------------*/
+/* Schema parsing.                                                            */
+/*----------------------------------------------------------------------------*/
+typedef enum
+{
+    SBE_NODE_OTHER,
+    SBE_NODE_SCHEMA,
+    SBE_NODE_TYPES,
+    SBE_NODE_TYPE,
+    SBE_NODE_COMPOSITE,
+    SBE_NODE_ENUM,
+    SBE_NODE_VALID_VALUE,
+    SBE_NODE_SET,
+    SBE_NODE_CHOICE,
+    SBE_NODE_REF,
+    SBE_NODE_MESSAGE,
+    SBE_NODE_FIELD,
+    SBE_NODE_GROUP,
+    SBE_NODE_DATA
+} sbe_node_kind_t;
+
+typedef struct sbe_node_t_stct
+{
+    sbe_node_kind_t kind;
+    const gchar * name;
+    const gchar * type;                     /* type, primitiveType, encodingType or dimensionType attribute */
+    const gchar * description;
+    const gchar * byte_order;
+    gint64 offset;                          /* -1 if not given */
+    guint32 length;
+    guint32 id;
+    guint32 version;
+    gboolean constant;
+    wmem_strbuf_t * text;                   /* Content of validValue and choice elements */
+    struct sbe_node_t_stct * parent;
+    struct sbe_node_t_stct * first_child;
+    struct sbe_node_t_stct * last_child;
+    struct sbe_node_t_stct * next;
+} sbe_node_t;
+
+typedef struct
+{
+    wmem_allocator_t * scope;
+    sbe_node_t * root;
+    sbe_node_t * current;
+    wmem_map_t * type;                      /* sbe_node_t, keyed by name */
+} sbe_parse_t;
+
+static const struct
+{
+    const gchar * name;
+    sbe_node_kind_t kind;
+} sbe_element[] =
+{
+    { "messageSchema", SBE_NODE_SCHEMA },
+    { "types", SBE_NODE_TYPES },
+    { "type", SBE_NODE_TYPE },
+    { "composite", SBE_NODE_COMPOSITE },
+    { "enum", SBE_NODE_ENUM },
+    { "validValue", SBE_NODE_VALID_VALUE },
+    { "set", SBE_NODE_SET },
+    { "choice", SBE_NODE_CHOICE },
+    { "ref", SBE_NODE_REF },
+    { "message", SBE_NODE_MESSAGE },
+    { "field", SBE_NODE_FIELD },
+    { "group", SBE_NODE_GROUP },
+    { "data", SBE_NODE_DATA }
+};
+
+static void sbe_parse_start_element(GMarkupParseContext * context _U_, const gchar * element_name, const gchar ** attribute_names,
+    const gchar ** attribute_values, gpointer user_data, GError ** error _U_)
+{
+    sbe_parse_t * parse = (sbe_parse_t *) user_data;
+    const gchar * local_name = strchr(element_name, ':');
+    sbe_node_t * node;
+    guint idx;
+
+    /* Ignore any namespace prefix (sbe:messageSchema, sbe:message). */
+    local_name = (local_name != NULL) ? (local_name + 1) : element_name;
+    node = wmem_new0(parse->scope, sbe_node_t);
+    node->kind = SBE_NODE_OTHER;
+    node->offset = -1;
+    node->length = 1;
+    for (idx = 0; idx < G_N_ELEMENTS(sbe_element); idx++)
+    {
+        if (strcmp(local_name, sbe_element[idx].name) == 0)
+        {
+            node->kind = sbe_element[idx].kind;
+            break;
+        }
+    }
+    for (idx = 0; attribute_names[idx] != NULL; idx++)
+    {
+        const gchar * value = attribute_values[idx];
+
+        if (strcmp(attribute_names[idx], "name") == 0)
+        {
+            node->name = wmem_strdup(parse->scope, value);
+        }
+        else if ((strcmp(attribute_names[idx], "type") == 0) || (strcmp(attribute_names[idx], "primitiveType") == 0)
+            || (strcmp(attribute_names[idx], "encodingType") == 0) || (strcmp(attribute_names[idx], "dimensionType") == 0))
+        {
+            node->type = wmem_strdup(parse->scope, value);
+        }
+        else if (strcmp(attribute_names[idx], "description") == 0)
+        {
+            node->description = wmem_strdup(parse->scope, value);
+        }
+        else if (strcmp(attribute_names[idx], "byteOrder") == 0)
+        {
+            node->byte_order = wmem_strdup(parse->scope, value);
+        }
+        else if (strcmp(attribute_names[idx], "offset") == 0)
+        {
+            node->offset = (gint64) strtoul(value, NULL, 10);
+        }
+        else if (strcmp(attribute_names[idx], "length") == 0)
+        {
+            node->length = (guint32) strtoul(value, NULL, 10);
+        }
+        else if (strcmp(attribute_names[idx], "id") == 0)
+        {
+            node->id = (guint32) strtoul(value, NULL, 10);
+        }
+        else if (strcmp(attribute_names[idx], "version") == 0)
+        {
+            node->version = (guint32) strtoul(value, NULL, 10);
+        }
+        else if (strcmp(attribute_names[idx], "presence") == 0)
+        {
+            node->constant = (strcmp(value, "constant") == 0);
+        }
+    }
+    if ((node->kind == SBE_NODE_VALID_VALUE) || (node->kind == SBE_NODE_CHOICE))
+    {
+        node->text = wmem_strbuf_new(parse->scope, "");
+    }
+    if (parse->current == NULL)
+    {
+        parse->root = node;
+    }
+    else
+    {
+        node->parent = parse->current;
+        if (parse->current->last_child == NULL)
+        {
+            parse->current->first_child = node;
+        }
+        else
+        {
+            parse->current->last_child->next = node;
+        }
+        parse->current->last_child = node;
+    }
+    /* Named types are global only when defined directly within <types>. */
+    if ((node->name != NULL) && (node->parent != NULL) && (node->parent->kind == SBE_NODE_TYPES))
+    {
+        switch (node->kind)
+        {
+            case SBE_NODE_TYPE:
+            case SBE_NODE_COMPOSITE:
+            case SBE_NODE_ENUM:
+            case SBE_NODE_SET:
+                wmem_map_insert(parse->type, node->name, node);
+                break;
+            default:
+                break;
+        }
+    }
+    parse->current = node;
+}
+
+static void sbe_parse_end_element(GMarkupParseContext * context _U_, const gchar * element_name _U_, gpointer user_data, GError ** error _U_)
+{
+    sbe_parse_t * parse = (sbe_parse_t *) user_data;
+
+    if (parse->current != NULL)
+    {
+        parse->current = parse->current->parent;
+    }
+}
+
+static void sbe_parse_text(GMarkupParseContext * context _U_, const gchar * text, gsize text_len, gpointer user_data, GError ** error _U_)
+{
+    sbe_parse_t * parse = (sbe_parse_t *) user_data;
+
+    if ((parse->current != NULL) && (parse->current->text != NULL))
+    {
+        wmem_strbuf_append_printf(parse->current->text, "%.*s", (int) text_len, text);
+    }
+}
+
+static const GMarkupParser sbe_parser =
+{
+    sbe_parse_start_element,
+    sbe_parse_end_element,
+    sbe_parse_text,
+    NULL,
+    NULL
+};
+
+/*----------------------------------------------------------------------------*/
+/* Schema compilation.                                                        */
+/*----------------------------------------------------------------------------*/
+static gint ett_aeron_sbe = -1;
+static gint ett_aeron_sbe_header = -1;
+static gint ett_aeron_sbe_composite = -1;
+static gint ett_aeron_sbe_set = -1;
+static gint ett_aeron_sbe_group = -1;
+static gint ett_aeron_sbe_group_entry = -1;
+
+typedef struct
+{
+    const gchar * name;
+    guint32 size;
+    enum ftenum type;
+} sbe_primitive_t;
+
+static const sbe_primitive_t sbe_primitive[] =
+{
+    { "char", 1, FT_STRING },
+    { "int8", 1, FT_INT8 },
+    { "uint8", 1, FT_UINT8 },
+    { "int16", 2, FT_INT16 },
+    { "uint16", 2, FT_UINT16 },
+    { "int32", 4, FT_INT32 },
+    { "uint32", 4, FT_UINT32 },
+    { "int64", 8, FT_INT64 },
+    { "uint64", 8, FT_UINT64 },
+    { "float", 4, FT_FLOAT },
+    { "double", 8, FT_DOUBLE }
+};
+
+typedef struct
+{
+    sbe_schema_t * schema;
+    wmem_map_t * type;                      /* sbe_node_t, keyed by name */
+    GArray * hf;                            /* hf_register_info */
+    guint depth;
+    gchar * error;                          /* First error found, if any */
+} sbe_compile_t;
+
+static void sbe_compile_error(sbe_compile_t * ctx, const gchar * reason, const gchar * name)
+{
+    if (ctx->error == NULL)
+    {
+        ctx->error = g_strdup_printf("%s \"%s\"", reason, (name != NULL) ? name : "(unnamed)");
+    }
+}
+
+static const sbe_primitive_t * sbe_primitive_find(const gchar * name)
+{
+    guint idx;
+
+    if (name == NULL)
+    {
+        return (NULL);
+    }
+    for (idx = 0; idx < G_N_ELEMENTS(sbe_primitive); idx++)
+    {
+        if (strcmp(name, sbe_primitive[idx].name) == 0)
+        {
+            return (&(sbe_primitive[idx]));
+        }
+    }
+    return (NULL);
+}
+
+static const sbe_node_t * sbe_type_find(sbe_compile_t * ctx, const gchar * name)
+{
+    if (name == NULL)
+    {
+        return (NULL);
+    }
+    return ((const sbe_node_t *) wmem_map_lookup(ctx->type, name));
+}
+
+/* The primitive type underlying a type, enum or set (whose encodingType may itself name a type). */
+static const sbe_primitive_t * sbe_encoding_primitive(sbe_compile_t * ctx, const sbe_node_t * node)
+{
+    const sbe_primitive_t * primitive = sbe_primitive_find(node->type);
+    const sbe_node_t * type;
+
+    if (primitive != NULL)
+    {
+        return (primitive);
+    }
+    type = sbe_type_find(ctx, node->type);
+    if ((type != NULL) && (type->kind == SBE_NODE_TYPE))
+    {
+        return (sbe_primitive_find(type->type));
+    }
+    return (NULL);
+}
+
+static guint32 sbe_type_size(sbe_compile_t * ctx, const sbe_node_t * node)
+{
+    const sbe_primitive_t * primitive;
+    const sbe_node_t * child;
+    guint32 offset = 0;
+    guint32 size = 0;
+
+    if ((node == NULL) || (node->constant) || (ctx->depth > SBE_MAX_DEPTH))
+    {
+        return (0);
+    }
+    switch (node->kind)
+    {
+        case SBE_NODE_TYPE:
+            primitive = sbe_primitive_find(node->type);
+            return ((primitive != NULL) ? (primitive->size * node->length) : 0);
+        case SBE_NODE_ENUM:
+        case SBE_NODE_SET:
+            primitive = sbe_encoding_primitive(ctx, node);
+            return ((primitive != NULL) ? primitive->size : 0);
+        case SBE_NODE_REF:
+            ctx->depth++;
+            size = sbe_type_size(ctx, sbe_type_find(ctx, node->type));
+            ctx->depth--;
+            return (size);
+        case SBE_NODE_COMPOSITE:
+            ctx->depth++;
+            for (child = node->first_child; child != NULL; child = child->next)
+            {
+                if (child->offset >= 0)
+                {
+                    offset = (guint32) child->offset;
+                }
+                offset += sbe_type_size(ctx, child);
+                if (offset > size)
+                {
+                    size = offset;
+                }
+            }
+            ctx->depth--;
+            return (size);
+        default:
+            return (0);
+    }
+}
+
+/* Find a member of a composite (such as "length" in a varData composite) and its offset within the composite. */
+static const sbe_node_t * sbe_composite_member(sbe_compile_t * ctx, const sbe_node_t * composite, const gchar * name, guint32 * member_offset)
+{
+    const sbe_node_t * child;
+    guint32 offset = 0;
+
+    for (child = composite->first_child; child != NULL; child = child->next)
+    {
+        if (child->offset >= 0)
+        {
+            offset = (guint32) child->offset;
+        }
+        if ((child->name != NULL) && (strcmp(child->name, name) == 0))
+        {
+            *member_offset = offset;
+            return (child);
+        }
+        offset += sbe_type_size(ctx, child);
+    }
+    return (NULL);
+}
+
+static gboolean sbe_uint_loc_find(sbe_compile_t * ctx, const sbe_node_t * composite, const gchar * name, sbe_uint_loc_t * loc)
+{
+    const sbe_node_t * member;
+    const sbe_primitive_t * primitive;
+
+    if ((composite == NULL) || (composite->kind != SBE_NODE_COMPOSITE))
+    {
+        return (FALSE);
+    }
+    member = sbe_composite_member(ctx, composite, name, &(loc->offset));
+    if ((member == NULL) || (member->kind != SBE_NODE_TYPE) || (member->length != 1))
+    {
+        return (FALSE);
+    }
+    primitive = sbe_primitive_find(member->type);
+    if ((primitive == NULL) || (primitive->size > 4) || (primitive->type == FT_STRING) || (primitive->type == FT_FLOAT) || (primitive->type == FT_DOUBLE))
+    {
+        return (FALSE);
+    }
+    loc->length = primitive->size;
+    return (TRUE);
+}
+
+/* Build a filter name from a prefix and a schema name, replacing any character not allowed in a filter name. */
+static gchar * sbe_abbrev(const gchar * prefix, const gchar * name)
+{
+    gchar * abbrev = g_strdup_printf("%s.%s", prefix, name);
+    gchar * ptr;
+
+    for (ptr = abbrev + strlen(prefix) + 1; *ptr != '\0'; ptr++)
+    {
+        if (!g_ascii_isalnum(*ptr) && (*ptr != '_') && (*ptr != '-') && (*ptr != '.'))
+        {
+            *ptr = '_';
+        }
+    }
+    return (abbrev);
+}
+
+static int * sbe_hf_new(sbe_compile_t * ctx, const gchar * name, gchar * abbrev, enum ftenum type, int display,
+    const void * strings, guint64 bitmask, const gchar * blurb)
+{
+    hf_register_info hf;
+    int * hf_id = wmem_new(ctx->schema->scope, int);
+
+    *hf_id = -1;
+    memset((void *) &hf, 0, sizeof(hf_register_info));
+    hf.p_id = hf_id;
+    /* Registered field names are freed with g_free() when the fields are deregistered. */
+    hf.hfinfo.name = g_strdup(name);
+    hf.hfinfo.abbrev = abbrev;
+    hf.hfinfo.type = type;
+    hf.hfinfo.display = display;
+    hf.hfinfo.strings = strings;
+    hf.hfinfo.bitmask = bitmask;
+    hf.hfinfo.blurb = g_strdup(blurb);
+    HFILL_INIT(hf);
+    g_array_append_val(ctx->hf, hf);
+    return (hf_id);
+}
+
+static gpointer sbe_array_copy(sbe_compile_t * ctx, GArray * array, guint * count)
+{
+    gpointer copy = NULL;
+
+    *count = array->len;
+    if (array->len > 0)
+    {
+        copy = wmem_memdup(ctx->schema->scope, array->data, array->len * g_array_get_element_size(array));
+    }
+    g_array_free(array, TRUE);
+    return (copy);
+}
+
+/* Compile a value of the given type at offset within its block, appending its field(s) to fields. */
+static void sbe_compile_type(sbe_compile_t * ctx, GArray * fields, const gchar * prefix, const gchar * name, const gchar * blurb,
+    const sbe_node_t * type, guint32 offset)
+{
+    const sbe_primitive_t * primitive;
+    const sbe_node_t * child;
+    sbe_field_t field;
+    gchar * abbrev;
+    guint count = 0;
+    guint idx;
+
+    if ((type == NULL) || (type->constant))
+    {
+        return;
+    }
+    if (ctx->depth > SBE_MAX_DEPTH)
+    {
+        sbe_compile_error(ctx, "type nesting too deep at", name);
+        return;
+    }
+    memset((void *) &field, 0, sizeof(sbe_field_t));
+    field.offset = offset;
+    field.length = sbe_type_size(ctx, type);
+    if (field.length == 0)
+    {
+        return;
+    }
+    abbrev = sbe_abbrev(prefix, name);
+    if (blurb == NULL)
+    {
+        blurb = type->description;
+    }
+    switch (type->kind)
+    {
+        case SBE_NODE_TYPE:
+            primitive = sbe_primitive_find(type->type);
+            if (primitive->type == FT_STRING)
+            {
+                field.encoding = ENC_ASCII | ENC_NA;
+                field.hf = sbe_hf_new(ctx, name, abbrev, FT_STRING, BASE_NONE, NULL, 0, blurb);
+            }
+            else if (type->length != 1)
+            {
+                field.encoding = ENC_NA;
+                field.hf = sbe_hf_new(ctx, name, abbrev, FT_BYTES, BASE_NONE, NULL, 0, blurb);
+            }
+            else
+            {
+                field.encoding = ctx->schema->encoding;
+                field.hf = sbe_hf_new(ctx, name, abbrev, primitive->type,
+                    ((primitive->type == FT_FLOAT) || (primitive->type == FT_DOUBLE)) ? BASE_NONE : BASE_DEC, NULL, 0, blurb);
+            }
+            break;
+        case SBE_NODE_ENUM:
+            primitive = sbe_encoding_primitive(ctx, type);
+            {
+                value_string * vals = NULL;
+                enum ftenum ftype = (primitive->type == FT_STRING) ? FT_UINT8 : primitive->type;
+
+                /* value_string only holds 32-bit values; wider enums are shown as plain integers. */
+                if (primitive->size <= 4)
+                {
+                    for (child = type->first_child; child != NULL; child = child->next)
+                    {
+                        count++;
+                    }
+                    vals = wmem_alloc0_array(ctx->schema->scope, value_string, count + 1);
+                    for (child = type->first_child, idx = 0; child != NULL; child = child->next)
+                    {
+                        const gchar * text;
+
+                        if ((child->kind != SBE_NODE_VALID_VALUE) || (child->name == NULL))
+                        {
+                            continue;
+                        }
+                        text = g_strstrip((gchar *) wmem_strbuf_get_str(child->text));
+                        /* The value of a char enum is the character itself. */
+                        vals[idx].value = (primitive->type == FT_STRING) ? (guint32) (guint8) text[0] : (guint32) strtol(text, NULL, 0);
+                        vals[idx].strptr = wmem_strdup(ctx->schema->scope, child->name);
+                        idx++;
+                    }
+                }
+                field.encoding = ctx->schema->encoding;
+                field.hf = sbe_hf_new(ctx, name, abbrev, ftype, BASE_DEC, (vals != NULL) ? VALS(vals) : NULL, 0, blurb);
+            }
+            break;
+        case SBE_NODE_SET:
+            primitive = sbe_encoding_primitive(ctx, type);
+            {
+                GArray * choices = g_array_new(FALSE, TRUE, sizeof(sbe_field_t));
+                enum ftenum ftype = FT_UINT8;
+
+                switch (primitive->size)
+                {
+                    case 2:
+                        ftype = FT_UINT16;
+                        break;
+                    case 4:
+                        ftype = FT_UINT32;
+                        break;
+                    case 8:
+                        ftype = FT_UINT64;
+                        break;
+                    default:
+                        break;
+                }
+                field.encoding = ctx->schema->encoding;
+                field.hf = sbe_hf_new(ctx, name, abbrev, ftype, BASE_HEX, NULL, 0, blurb);
+                field.ett = &ett_aeron_sbe_set;
+                for (child = type->first_child; child != NULL; child = child->next)
+                {
+                    sbe_field_t choice;
+                    guint bit;
+
+                    if ((child->kind != SBE_NODE_CHOICE) || (child->name == NULL))
+                    {
+                        continue;
+                    }
+                    bit = (guint) strtoul(g_strstrip((gchar *) wmem_strbuf_get_str(child->text)), NULL, 10);
+                    if (bit >= (primitive->size * 8))
+                    {
+                        continue;
+                    }
+                    memset((void *) &choice, 0, sizeof(sbe_field_t));
+                    choice.offset = field.offset;
+                    choice.length = field.length;
+                    choice.encoding = field.encoding;
+                    choice.hf = sbe_hf_new(ctx, child->name, sbe_abbrev(abbrev, child->name), FT_BOOLEAN, (int) (primitive->size * 8),
+                        NULL, G_GUINT64_CONSTANT(1) << bit, child->description);
+                    g_array_append_val(choices, choice);
+                }
+                field.child = (sbe_field_t *) sbe_array_copy(ctx, choices, &(field.child_count));
+            }
+            break;
+        case SBE_NODE_COMPOSITE:
+            {
+                GArray * members = g_array_new(FALSE, TRUE, sizeof(sbe_field_t));
+                guint32 member_offset = 0;
+
+                field.encoding = ENC_NA;
+                field.hf = sbe_hf_new(ctx, name, abbrev, FT_NONE, BASE_NONE, NULL, 0, blurb);
+                field.ett = &ett_aeron_sbe_composite;
+                ctx->depth++;
+                for (child = type->first_child; child != NULL; child = child->next)
+                {
+                    if (child->offset >= 0)
+                    {
+                        member_offset = (guint32) child->offset;
+                    }
+                    if (child->name != NULL)
+                    {
+                        sbe_compile_type(ctx, members, abbrev, child->name, NULL, child, offset + member_offset);
+                    }
+                    member_offset += sbe_type_size(ctx, child);
+                }
+                ctx->depth--;
+                field.child = (sbe_field_t *) sbe_array_copy(ctx, members, &(field.child_count));
+            }
+            break;
+        case SBE_NODE_REF:
+            /* A ref is the referenced type under the ref's name. */
+            g_free(abbrev);
+            ctx->depth++;
+            sbe_compile_type(ctx, fields, prefix, name, blurb, sbe_type_find(ctx, type->type), offset);
+            ctx->depth--;
+            return;
+        default:
+            g_free(abbrev);
+            return;
+    }
+    g_array_append_val(fields, field);
+}
+
+static void sbe_compile_block(sbe_compile_t * ctx, sbe_block_t * block, const sbe_node_t * parent, const gchar * prefix)
+{
+    GArray * fields = g_array_new(FALSE, TRUE, sizeof(sbe_field_t));
+    GArray * groups = g_array_new(FALSE, TRUE, sizeof(sbe_group_t));
+    GArray * data = g_array_new(FALSE, TRUE, sizeof(sbe_data_t));
+    const sbe_node_t * child;
+    const sbe_node_t * type;
+    guint32 offset = 0;
+
+    for (child = parent->first_child; child != NULL; child = child->next)
+    {
+        if (child->name == NULL)
+        {
+            continue;
+        }
+        switch (child->kind)
+        {
+            case SBE_NODE_FIELD:
+                if (child->constant)
+                {
+                    break;
+                }
+                type = sbe_type_find(ctx, child->type);
+                if (type == NULL)
+                {
+                    sbe_compile_error(ctx, "unknown type for field", child->name);
+                    break;
+                }
+                if (child->offset >= 0)
+                {
+                    offset = (guint32) child->offset;
+                }
+                sbe_compile_type(ctx, fields, prefix, child->name, child->description, type, offset);
+                offset += sbe_type_size(ctx, type);
+                break;
+            case SBE_NODE_GROUP:
+                {
+                    sbe_group_t group;
+                    gchar * abbrev = sbe_abbrev(prefix, child->name);
+
+                    type = sbe_type_find(ctx, (child->type != NULL) ? child->type : "groupSizeEncoding");
+                    if (!sbe_uint_loc_find(ctx, type, "blockLength", &(group.block_length))
+                        || !sbe_uint_loc_find(ctx, type, "numInGroup", &(group.num_in_group)))
+                    {
+                        sbe_compile_error(ctx, "unusable dimension type for group", child->name);
+                        g_free(abbrev);
+                        break;
+                    }
+                    if (ctx->depth > SBE_MAX_DEPTH)
+                    {
+                        sbe_compile_error(ctx, "group nesting too deep at", child->name);
+                        g_free(abbrev);
+                        break;
+                    }
+                    group.header_length = sbe_type_size(ctx, type);
+                    group.block = wmem_new0(ctx->schema->scope, sbe_block_t);
+                    ctx->depth++;
+                    sbe_compile_block(ctx, group.block, child, abbrev);
+                    ctx->depth--;
+                    group.hf = sbe_hf_new(ctx, child->name, abbrev, FT_NONE, BASE_NONE, NULL, 0, child->description);
+                    g_array_append_val(groups, group);
+                }
+                break;
+            case SBE_NODE_DATA:
+                {
+                    sbe_data_t entry;
+                    const sbe_node_t * var_data = NULL;
+                    const sbe_primitive_t * primitive = NULL;
+
+                    type = sbe_type_find(ctx, child->type);
+                    if ((type != NULL) && sbe_uint_loc_find(ctx, type, "length", &(entry.length)))
+                    {
+                        var_data = sbe_composite_member(ctx, type, "varData", &(entry.header_length));
+                    }
+                    if (var_data == NULL)
+                    {
+                        sbe_compile_error(ctx, "unusable type for data", child->name);
+                        break;
+                    }
+                    primitive = sbe_primitive_find(var_data->type);
+                    if ((primitive != NULL) && (primitive->type == FT_STRING))
+                    {
+                        entry.encoding = ENC_ASCII | ENC_NA;
+                        entry.hf = sbe_hf_new(ctx, child->name, sbe_abbrev(prefix, child->name), FT_STRING, BASE_NONE, NULL, 0, child->description);
+                    }
+                    else
+                    {
+                        entry.encoding = ENC_NA;
+                        entry.hf = sbe_hf_new(ctx, child->name, sbe_abbrev(prefix, child->name), FT_BYTES, BASE_NONE, NULL, 0, child->description);
+                    }
+                    g_array_append_val(data, entry);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    block->field = (sbe_field_t *) sbe_array_copy(ctx, fields, &(block->field_count));
+    block->group = (sbe_group_t *) sbe_array_copy(ctx, groups, &(block->group_count));
+    block->data = (sbe_data_t *) sbe_array_copy(ctx, data, &(block->data_count));
+}
+
+static sbe_schema_t * sbe_compile(sbe_parse_t * parse, gchar ** error)
+{
+    sbe_compile_t ctx;
+    sbe_schema_t * schema;
+    const sbe_node_t * node;
+    const sbe_node_t * header;
+    guint idx;
+
+    if ((parse->root == NULL) || (parse->root->kind != SBE_NODE_SCHEMA))
+    {
+        *error = g_strdup("not an SBE messageSchema");
+        return (NULL);
+    }
+    memset((void *) &ctx, 0, sizeof(sbe_compile_t));
+    ctx.type = parse->type;
+    /* Primitive type names may be used directly as field types. */
+    for (idx = 0; idx < G_N_ELEMENTS(sbe_primitive); idx++)
+    {
+        if (wmem_map_lookup(ctx.type, sbe_primitive[idx].name) == NULL)
+        {
+            sbe_node_t * primitive = wmem_new0(parse->scope, sbe_node_t);
+
+            primitive->kind = SBE_NODE_TYPE;
+            primitive->name = sbe_primitive[idx].name;
+            primitive->type = sbe_primitive[idx].name;
+            primitive->offset = -1;
+            primitive->length = 1;
+            wmem_map_insert(ctx.type, primitive->name, primitive);
+        }
+    }
+
+    schema = g_new0(sbe_schema_t, 1);
+    schema->scope = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+    schema->message = wmem_map_new(schema->scope, g_direct_hash, g_direct_equal);
+    schema->encoding = ENC_LITTLE_ENDIAN;
+    if ((parse->root->byte_order != NULL) && (strcmp(parse->root->byte_order, "bigEndian") == 0))
+    {
+        schema->encoding = ENC_BIG_ENDIAN;
+    }
+    schema->schema_id = parse->root->id;
+    schema->version = parse->root->version;
+    ctx.schema = schema;
+    ctx.hf = g_array_new(FALSE, TRUE, sizeof(hf_register_info));
+
+    /* Use the schema's own message header if it has one, otherwise the standard 8-byte header. */
+    header = sbe_type_find(&ctx, "messageHeader");
+    if ((header != NULL) && sbe_uint_loc_find(&ctx, header, "blockLength", &(schema->block_length))
+        && sbe_uint_loc_find(&ctx, header, "templateId", &(schema->template_id))
+        && sbe_uint_loc_find(&ctx, header, "schemaId", &(schema->header_schema_id))
+        && sbe_uint_loc_find(&ctx, header, "version", &(schema->header_version)))
+    {
+        schema->header_length = sbe_type_size(&ctx, header);
+    }
+    else
+    {
+        schema->header_length = 8;
+        schema->block_length.offset = 0;
+        schema->block_length.length = 2;
+        schema->template_id.offset = 2;
+        schema->template_id.length = 2;
+        schema->header_schema_id.offset = 4;
+        schema->header_schema_id.length = 2;
+        schema->header_version.offset = 6;
+        schema->header_version.length = 2;
+    }
+
+    for (node = parse->root->first_child; node != NULL; node = node->next)
+    {
+        sbe_message_t * message;
+        gchar * prefix;
+
+        if ((node->kind != SBE_NODE_MESSAGE) || (node->name == NULL))
+        {
+            continue;
+        }
+        message = wmem_new0(schema->scope, sbe_message_t);
+        message->name = wmem_strdup(schema->scope, node->name);
+        message->template_id = node->id;
+        prefix = sbe_abbrev("sbe", node->name);
+        sbe_compile_block(&ctx, &(message->block), node, prefix);
+        message->hf = sbe_hf_new(&ctx, node->name, prefix, FT_NONE, BASE_NONE, NULL, 0, node->description);
+        wmem_map_insert(schema->message, GUINT_TO_POINTER(message->template_id), message);
+    }
+
+    schema->hf_count = ctx.hf->len;
+    schema->hf = (hf_register_info *) g_array_free(ctx.hf, FALSE);
+    if (ctx.error != NULL)
+    {
+        *error = ctx.error;
+        for (idx = 0; idx < schema->hf_count; idx++)
+        {
+            g_free((gchar *) schema->hf[idx].hfinfo.name);
+            g_free((gchar *) schema->hf[idx].hfinfo.abbrev);
+            g_free((gchar *) schema->hf[idx].hfinfo.blurb);
+        }
+        g_free(schema->hf);
+        wmem_destroy_allocator(schema->scope);
+        g_free(schema);
+        return (NULL);
+    }
+    return (schema);
+}
+
+static void sbe_schema_release(void)
+{
+    guint idx;
+
+    if (aeron_sbe_schema == NULL)
+    {
+        return;
+    }
+    for (idx = 0; idx < aeron_sbe_schema->hf_count; idx++)
+    {
+        proto_unregister_field(proto_aeron_sbe, *(aeron_sbe_schema->hf[idx].p_id));
+    }
+    /* The field info lives in the hf array, which must stay valid until the deregistered fields are freed. */
+    proto_add_deregistered_data(aeron_sbe_schema->hf);
+    wmem_destroy_allocator(aeron_sbe_schema->scope);
+    g_free(aeron_sbe_schema);
+    aeron_sbe_schema = NULL;
+}
+
+static void sbe_schema_load(const gchar * filename)
+{
+    sbe_parse_t parse;
+    GMarkupParseContext * context;
+    GError * err = NULL;
+    gchar * contents = NULL;
+    gsize length = 0;
+    gchar * error = NULL;
+
+    sbe_schema_release();
+    if ((filename == NULL) || (filename[0] == '\0'))
+    {
+        return;
+    }
+    if (!g_file_get_contents(filename, &contents, &length, &err))
+    {
+        report_failure("Aeron SBE: can't read schema \"%s\": %s", filename, err->message);
+        g_error_free(err);
+        return;
+    }
+    memset((void *) &parse, 0, sizeof(sbe_parse_t));
+    parse.scope = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+    parse.type = wmem_map_new(parse.scope, g_str_hash, g_str_equal);
+    context = g_markup_parse_context_new(&sbe_parser, (GMarkupParseFlags) 0, (gpointer) &parse, NULL);
+    if (g_markup_parse_context_parse(context, contents, (gssize) length, &err) && g_markup_parse_context_end_parse(context, &err))
+    {
+        aeron_sbe_schema = sbe_compile(&parse, &error);
+    }
+    else
+    {
+        error = g_strdup(err->message);
+        g_error_free(err);
+    }
+    g_markup_parse_context_free(context);
+    wmem_destroy_allocator(parse.scope);
+    g_free(contents);
+    if (aeron_sbe_schema == NULL)
+    {
+        report_failure("Aeron SBE: can't load schema \"%s\": %s", filename, error);
+        g_free(error);
+        return;
+    }
+    if (aeron_sbe_schema->hf_count > 0)
+    {
+        proto_register_field_array(proto_aeron_sbe, aeron_sbe_schema->hf, aeron_sbe_schema->hf_count);
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/* Dissection.                                                                */
+/*----------------------------------------------------------------------------*/
+static int hf_aeron_sbe_header = -1;
+static int hf_aeron_sbe_header_block_length = -1;
+static int hf_aeron_sbe_header_template_id = -1;
+static int hf_aeron_sbe_header_schema_id = -1;
+static int hf_aeron_sbe_header_version = -1;
+static int hf_aeron_sbe_group_block_length = -1;
+static int hf_aeron_sbe_group_num_in_group = -1;
+static int hf_aeron_sbe_group_entry = -1;
+static int hf_aeron_sbe_unknown = -1;
+
+static expert_field ei_aeron_sbe_unknown_template = EI_INIT;
+static expert_field ei_aeron_sbe_schema_mismatch = EI_INIT;
+static expert_field ei_aeron_sbe_data_length = EI_INIT;
+
+static guint32 sbe_get_uint(tvbuff_t * tvb, int offset, const sbe_uint_loc_t * loc, guint encoding)
+{
+    switch (loc->length)
+    {
+        case 1:
+            return (tvb_get_guint8(tvb, offset + loc->offset));
+        case 2:
+            return ((encoding == ENC_BIG_ENDIAN) ? tvb_get_ntohs(tvb, offset + loc->offset) : tvb_get_letohs(tvb, offset + loc->offset));
+        case 4:
+            return ((encoding == ENC_BIG_ENDIAN) ? tvb_get_ntohl(tvb, offset + loc->offset) : tvb_get_letohl(tvb, offset + loc->offset));
+        default:
+            break;
+    }
+    return (0);
+}
+
+static void sbe_dissect_fields(tvbuff_t * tvb, int offset, guint32 block_length, proto_tree * tree, const sbe_field_t * field, guint count)
+{
+    guint idx;
+
+    for (idx = 0; idx < count; idx++)
+    {
+        proto_item * item;
+
+        /* A block shorter than the schema's (from an older version of the message) omits the trailing fields. */
+        if ((field[idx].offset + field[idx].length) > block_length)
+        {
+            continue;
+        }
+        item = proto_tree_add_item(tree, *(field[idx].hf), tvb, offset + field[idx].offset, field[idx].length, field[idx].encoding);
+        if (field[idx].child_count > 0)
+        {
+            proto_tree * subtree = proto_item_add_subtree(item, *(field[idx].ett));
+
+            sbe_dissect_fields(tvb, offset, block_length, subtree, field[idx].child, field[idx].child_count);
+        }
+    }
+}
+
+/* Dissect a block and its groups and data, returning the offset of the byte following them. */
+static int sbe_dissect_block(tvbuff_t * tvb, int offset, guint32 block_length, packet_info * pinfo, proto_tree * tree, const sbe_schema_t * schema, const sbe_block_t * block)
+{
+    guint idx;
+
+    sbe_dissect_fields(tvb, offset, block_length, tree, block->field, block->field_count);
+    offset += block_length;
+    for (idx = 0; idx < block->group_count; idx++)
+    {
+        const sbe_group_t * group = &(block->group[idx]);
+        guint32 entry_block_length = sbe_get_uint(tvb, offset, &(group->block_length), schema->encoding);
+        guint32 num_in_group = sbe_get_uint(tvb, offset, &(group->num_in_group), schema->encoding);
+        proto_item * group_item;
+        proto_tree * group_tree;
+        int group_offset = offset;
+        gint remaining;
+        guint32 max_entries;
+        guint32 entry;
+
+        group_item = proto_tree_add_item(tree, *(group->hf), tvb, offset, -1, ENC_NA);
+        proto_item_append_text(group_item, " (%u entries)", num_in_group);
+        group_tree = proto_item_add_subtree(group_item, ett_aeron_sbe_group);
+        proto_tree_add_item(group_tree, hf_aeron_sbe_group_block_length, tvb, offset + group->block_length.offset, group->block_length.length, schema->encoding);
+        proto_tree_add_item(group_tree, hf_aeron_sbe_group_num_in_group, tvb, offset + group->num_in_group.offset, group->num_in_group.length, schema->encoding);
+        offset += group->header_length;
+        /*
+            Every entry but an empty one takes at least a byte, so a count above the bytes remaining is bogus.
+            One entry more than that is still dissected, so that the message is reported as malformed.
+        */
+        remaining = tvb_reported_length_remaining(tvb, offset);
+        max_entries = (guint32) MAX(remaining, 0);
+        if (entry_block_length > 0)
+        {
+            max_entries /= entry_block_length;
+        }
+        if (num_in_group > max_entries)
+        {
+            num_in_group = max_entries + 1;
+        }
+        for (entry = 0; entry < num_in_group; entry++)
+        {
+            proto_item * entry_item;
+            proto_tree * entry_tree;
+            int next_offset;
+
+            /* Throws if the entries run past the end of the message, rather than looping on a bogus count. */
+            tvb_ensure_bytes_exist(tvb, offset, entry_block_length);
+            entry_item = proto_tree_add_none_format(group_tree, hf_aeron_sbe_group_entry, tvb, offset, -1, "Entry %u", entry);
+            entry_tree = proto_item_add_subtree(entry_item, ett_aeron_sbe_group_entry);
+            next_offset = sbe_dissect_block(tvb, offset, entry_block_length, pinfo, entry_tree, schema, group->block);
+            proto_item_set_len(entry_item, next_offset - offset);
+            if (next_offset == offset)
+            {
+                /* An empty entry; the rest are the same, and would never make progress. */
+                break;
+            }
+            offset = next_offset;
+        }
+        proto_item_set_len(group_item, offset - group_offset);
+    }
+    for (idx = 0; idx < block->data_count; idx++)
+    {
+        const sbe_data_t * data = &(block->data[idx]);
+        guint32 length = sbe_get_uint(tvb, offset, &(data->length), schema->encoding);
+        gint remaining = tvb_reported_length_remaining(tvb, offset + data->header_length);
+
+        /*
+            A length beyond the end of the message is bogus, and one near 2^32 would wrap the offset. The
+            rest of the message can't be located, so stop here.
+        */
+        if (length > (guint32) MAX(remaining, 0))
+        {
+            proto_tree_add_expert_format(tree, pinfo, &ei_aeron_sbe_data_length, tvb, offset, data->header_length,
+                "Data length %" G_GUINT32_FORMAT " exceeds the %d bytes remaining", length, MAX(remaining, 0));
+            return (tvb_reported_length(tvb));
+        }
+        proto_tree_add_item(tree, *(data->hf), tvb, offset + data->header_length, length, data->encoding);
+        offset += data->header_length + length;
+    }
+    return (offset);
+}
+
+static int dissect_aeron_sbe(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree, void * user_data _U_)
+{
+    const sbe_schema_t * schema = aeron_sbe_schema;
+    const sbe_message_t * message;
+    proto_item * sbe_item;
+    proto_tree * sbe_tree;
+    proto_item * header_item;
+    proto_tree * header_tree;
+    proto_item * item;
+    guint32 block_length;
+    guint32 template_id;
+    int offset;
+
+    if ((schema == NULL) || (tvb_reported_length(tvb) < schema->header_length))
+    {
+        return (0);
+    }
+    block_length = sbe_get_uint(tvb, 0, &(schema->block_length), schema->encoding);
+    template_id = sbe_get_uint(tvb, 0, &(schema->template_id), schema->encoding);
+    message = (const sbe_message_t *) wmem_map_lookup(schema->message, GUINT_TO_POINTER(template_id));
+    if (message != NULL)
+    {
+        col_append_sep_fstr(pinfo->cinfo, COL_INFO, NULL, "[SBE %s]", message->name);
+    }
+    else
+    {
+        col_append_sep_fstr(pinfo->cinfo, COL_INFO, NULL, "[SBE template %" G_GUINT32_FORMAT "]", template_id);
+    }
+    if (tree == NULL)
+    {
+        return (tvb_reported_length(tvb));
+    }
+
+    sbe_item = proto_tree_add_item(tree, proto_aeron_sbe, tvb, 0, -1, ENC_NA);
+    sbe_tree = proto_item_add_subtree(sbe_item, ett_aeron_sbe);
+    header_item = proto_tree_add_item(sbe_tree, hf_aeron_sbe_header, tvb, 0, schema->header_length, ENC_NA);
+    header_tree = proto_item_add_subtree(header_item, ett_aeron_sbe_header);
+    proto_tree_add_item(header_tree, hf_aeron_sbe_header_block_length, tvb, schema->block_length.offset, schema->block_length.length, schema->encoding);
+    proto_tree_add_item(header_tree, hf_aeron_sbe_header_template_id, tvb, schema->template_id.offset, schema->template_id.length, schema->encoding);
+    item = proto_tree_add_item(header_tree, hf_aeron_sbe_header_schema_id, tvb, schema->header_schema_id.offset, schema->header_schema_id.length, schema->encoding);
+    if (sbe_get_uint(tvb, 0, &(schema->header_schema_id), schema->encoding) != schema->schema_id)
+    {
+        expert_add_info(pinfo, item, &ei_aeron_sbe_schema_mismatch);
+    }
+    proto_tree_add_item(header_tree, hf_aeron_sbe_header_version, tvb, schema->header_version.offset, schema->header_version.length, schema->encoding);
+    offset = (int) schema->header_length;
+    if (message == NULL)
+    {
+        item = proto_tree_add_item(sbe_tree, hf_aeron_sbe_unknown, tvb, offset, -1, ENC_NA);
+        expert_add_info(pinfo, item, &ei_aeron_sbe_unknown_template);
+        return (tvb_reported_length(tvb));
+    }
+    proto_item_append_text(sbe_item, ", %s", message->name);
+    item = proto_tree_add_item(sbe_tree, *(message->hf), tvb, offset, -1, ENC_NA);
+    offset = sbe_dissect_block(tvb, offset, block_length, pinfo, proto_item_add_subtree(item, ett_aeron_sbe_composite), schema, &(message->block));
+    proto_item_set_len(item, offset - (int) schema->header_length);
+    return (offset);
+}
+
+/* As a heuristic, only claim messages of the loaded schema whose template is known. */
+static gboolean test_aeron_sbe_packet(tvbuff_t * tvb, packet_info * pinfo _U_, proto_tree * tree _U_, void * user_data _U_)
+{
+    const sbe_schema_t * schema = aeron_sbe_schema;
+    guint32 block_length;
+    guint32 template_id;
+
+    if ((schema == NULL) || (tvb_reported_length(tvb) < schema->header_length))
+    {
+        return (FALSE);
+    }
+    if (sbe_get_uint(tvb, 0, &(schema->header_schema_id), schema->encoding) != schema->schema_id)
+    {
+        return (FALSE);
+    }
+    block_length = sbe_get_uint(tvb, 0, &(schema->block_length), schema->encoding);
+    if ((schema->header_length + block_length) > tvb_reported_length(tvb))
+    {
+        return (FALSE);
+    }
+    template_id = sbe_get_uint(tvb, 0, &(schema->template_id), schema->encoding);
+    if (wmem_map_lookup(schema->message, GUINT_TO_POINTER(template_id)) == NULL)
+    {
+        return (FALSE);
+    }
+    dissect_aeron_sbe(tvb, pinfo, tree, user_data);
+    return (TRUE);
+}
+
+/* Register all the bits needed with the filtering engine */
+void proto_register_aeron_sbe(void)
+{
+    static hf_register_info hf[] =
+    {
+        { &hf_aeron_sbe_header,
+            { "Message Header", "sbe.header", FT_NONE, BASE_NONE, NULL, 0x0, NULL, HFILL } },
+        { &hf_aeron_sbe_header_block_length,
+            { "Block Length", "sbe.header.block_length", FT_UINT32, BASE_DEC, NULL, 0x0, NULL, HFILL } },
+        { &hf_aeron_sbe_header_template_id,
+            { "Template ID", "sbe.header.template_id", FT_UINT32, BASE_DEC, NULL, 0x0, NULL, HFILL } },
+        { &hf_aeron_sbe_header_schema_id,
+            { "Schema ID", "sbe.header.schema_id", FT_UINT32, BASE_DEC, NULL, 0x0, NULL, HFILL } },
+        { &hf_aeron_sbe_header_version,
+            { "Version", "sbe.header.version", FT_UINT32, BASE_DEC, NULL, 0x0, NULL, HFILL } },
+        { &hf_aeron_sbe_group_block_length,
+            { "Block Length", "sbe.group.block_length", FT_UINT32, BASE_DEC, NULL, 0x0, NULL, HFILL } },
+        { &hf_aeron_sbe_group_num_in_group,
+            { "Number in Group", "sbe.group.num_in_group", FT_UINT32, BASE_DEC, NULL, 0x0, NULL, HFILL } },
+        { &hf_aeron_sbe_group_entry,
+            { "Entry", "sbe.group.entry", FT_NONE, BASE_NONE, NULL, 0x0, NULL, HFILL } },
+        { &hf_aeron_sbe_unknown,
+            { "Unknown Message", "sbe.unknown", FT_BYTES, BASE_NONE, NULL, 0x0, NULL, HFILL } }
+    };
+    static gint * ett[] =
+    {
+        &ett_aeron_sbe,
+        &ett_aeron_sbe_header,
+        &ett_aeron_sbe_composite,
+        &ett_aeron_sbe_set,
+        &ett_aeron_sbe_group,
+        &ett_aeron_sbe_group_entry
+    };
+    static ei_register_info ei[] =
+    {
+        { &ei_aeron_sbe_unknown_template, { "sbe.unknown_template", PI_UNDECODED, PI_WARN, "Template ID not in the SBE schema", EXPFILL } },
+        { &ei_aeron_sbe_schema_mismatch, { "sbe.schema_mismatch", PI_PROTOCOL, PI_WARN, "Schema ID does not match the SBE schema", EXPFILL } },
+        { &ei_aeron_sbe_data_length, { "sbe.data_length", PI_MALFORMED, PI_ERROR, "Data length exceeds the message", EXPFILL } }
+    };
+    module_t * aeron_sbe_module;
+    expert_module_t * expert_aeron_sbe;
+
+    proto_aeron_sbe = proto_register_protocol("Simple Binary Encoding (Aeron)", "SBE", "sbe");
+
+    proto_register_field_array(proto_aeron_sbe, hf, array_length(hf));
+    proto_register_subtree_array(ett, array_length(ett));
+    expert_aeron_sbe = expert_register_protocol(proto_aeron_sbe);
+    expert_register_field_array(expert_aeron_sbe, ei, array_length(ei));
+    aeron_sbe_module = prefs_register_protocol(proto_aeron_sbe, proto_reg_handoff_aeron_sbe);
+
+    prefs_register_filename_preference(aeron_sbe_module,
+        "schema_file",
+        "SBE schema file",
+        "SBE XML message schema used to decode Aeron message payloads. Each message in the schema is registered as a set of sbe.<message>.<field> fields.",
+        &global_aeron_sbe_schema_file);
+    range_convert_str(&global_aeron_sbe_stream_id_range, "", G_MAXUINT32);
+    prefs_register_range_preference(aeron_sbe_module,
+        "stream_ids",
+        "Aeron stream IDs",
+        "Aeron stream IDs (and ranges) whose message payloads are always decoded as SBE. Other streams are decoded as SBE via Decode As, or by the Aeron heuristic sub-dissectors if their schema ID and template ID match the schema.",
+        &global_aeron_sbe_stream_id_range,
+        G_MAXUINT32);
+}
+
+/* The registration hand-off routine */
+void proto_reg_handoff_aeron_sbe(void)
+{
+    static gboolean already_registered = FALSE;
+    static range_t * aeron_sbe_stream_id_range = NULL;
+    static gchar * aeron_sbe_schema_file = NULL;
+
+    if (!already_registered)
+    {
+        aeron_sbe_dissector_handle = new_create_dissector_handle(dissect_aeron_sbe, proto_aeron_sbe);
+        dissector_add_for_decode_as("aeron.stream_id", aeron_sbe_dissector_handle);
+        heur_dissector_add("aeron_msg_payload", test_aeron_sbe_packet, proto_aeron_sbe);
+        already_registered = TRUE;
+    }
+    else
+    {
+        dissector_delete_uint_range("aeron.stream_id", aeron_sbe_stream_id_range, aeron_sbe_dissector_handle);
+        g_free(aeron_sbe_stream_id_range);
+    }
+    aeron_sbe_stream_id_range = range_copy(global_aeron_sbe_stream_id_range);
+    dissector_add_uint_range("aeron.stream_id", aeron_sbe_stream_id_range, aeron_sbe_dissector_handle);
+
+    /* Only recompile (and re-register the fields) when the schema file changes. */
+    if (g_strcmp0(aeron_sbe_schema_file, global_aeron_sbe_schema_file) != 0)
+    {
+        g_free(aeron_sbe_schema_file);
+        aeron_sbe_schema_file = g_strdup(global_aeron_sbe_schema_file);
+        sbe_schema_load(aeron_sbe_schema_file);
+    }
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 4
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=4 expandtab:
+ * :indentSize=4:tabSize=4:noTabs=true:
+ */
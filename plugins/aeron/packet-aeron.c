@@ -32,11 +32,14 @@
 #include <epan/uat.h>
 #include <epan/tap.h>
 #include <epan/conversation.h>
+#include <epan/decode_as.h>
 #include <epan/to_str.h>
+#include <epan/range.h>
 #ifndef HAVE_INET_ATON
     #include <wsutil/inet_aton.h>
 #endif
 #include <wsutil/pint.h>
+#include "packet-aeron.h"
 
 void proto_register_aeron(void);
 void proto_reg_handoff_aeron(void);
@@ -44,11 +47,23 @@ void proto_reg_handoff_aeron(void);
 /* Protocol handle */
 static int proto_aeron = -1;
 
+/* Tap handle */
+static int aeron_tap_handle = -1;
+static int aeron_follow_tap_handle = -1;
+
 /* Dissector handles */
 static dissector_handle_t aeron_dissector_handle;
 static dissector_handle_t aeron_data_dissector_handle;
 static heur_dissector_list_t aeron_heuristic_subdissector_list;
 
+/* Payload dissector table, keyed by stream ID */
+static dissector_table_t aeron_stream_id_dissector_table;
+
+/* Per-packet data keys */
+#define AERON_PROTO_DATA_STREAM_ID 0
+/* Per-frame data key of the payload heuristic chosen for the Aeron frame at this offset in the packet */
+#define AERON_PROTO_DATA_PAYLOAD_HEUR(offset) (0x10000 | (offset))
+
 /*----------------------------------------------------------------------------*/
 /* Preferences.                                                               */
 /*----------------------------------------------------------------------------*/
@@ -57,6 +72,14 @@ static gboolean aeron_sequence_analysis = FALSE;
 static gboolean aeron_stream_analysis = FALSE;
 static gboolean aeron_reassemble_fragments = FALSE;
 static gboolean aeron_use_heuristic_subdissectors = FALSE;
+static range_t * global_aeron_udp_port_range = NULL;
+static const char * global_aeron_mc_address_low = "";
+static const char * global_aeron_mc_address_high = "";
+static guint32 aeron_mc_address_low_host = 0;
+static guint32 aeron_mc_address_high_host = 0;
+static gboolean aeron_heuristic_verdict_cache = FALSE;
+static guint aeron_streaming_term_window = 0;
+static guint aeron_receiver_timeout = 0;
 
 /*----------------------------------------------------------------------------*/
 /* Aeron position routines.                                                   */
@@ -140,8 +163,6 @@ static void aeron_pos_add_length(aeron_pos_t * pos, guint32 length, guint32 term
 /*----------------------------------------------------------------------------*/
 /* Aeron frame information management.                                        */
 /*----------------------------------------------------------------------------*/
-static wmem_tree_t * aeron_frame_info_tree = NULL;
-
 struct aeron_frame_info_t_stct;
 typedef struct aeron_frame_info_t_stct aeron_frame_info_t;
 
@@ -156,12 +177,16 @@ typedef struct
 {
     aeron_frame_info_t * frame_info;        /* Frame (aeron_frame_info_t) in which this NAK occurs */
     wmem_list_t * rx;                       /* List of RX frames for this NAK */
+    wmem_tree_t * rx_index;                 /* Tree of RX frames (aeron_rx_info_t) for this NAK, keyed by term offset and length */
     guint32 flags;
     guint32 nak_term_offset;                /* Term offset specified by this NAK */
     guint32 nak_length;                     /* NAK length */
     guint32 unrecovered_length;             /* Number of bytes unrecovered via RX */
 } aeron_nak_analysis_t;
 
+struct aeron_stream_rcv_t_stct;
+typedef struct aeron_stream_rcv_t_stct aeron_stream_rcv_t;
+
 typedef struct
 {
     guint32 flags;
@@ -170,20 +195,20 @@ typedef struct
     aeron_pos_t completed;
     guint32 receiver_window;
     guint32 outstanding_bytes;
+    nstime_t receiver_lag;                  /* Time from the send of the oldest newly-completed data to this SM */
+    guint32 receiver_lag_frame;             /* Frame containing the oldest newly-completed data */
+    aeron_pos_t gap_start;                  /* Start of the data skipped by an OOO_GAP frame (previous high position) */
+    guint32 gap_length;                     /* Number of bytes skipped by an OOO_GAP frame */
+    aeron_stream_rcv_t * rcv;               /* Receiver which sent this SM */
+    aeron_stream_rcv_t * slowest;           /* Receiver with the lowest completed position, as of this frame */
+    aeron_pos_t min_completed;              /* Completed position of the slowest receiver */
+    guint32 min_outstanding_bytes;          /* Bytes sent but not yet completed by the slowest receiver */
+    guint32 rcv_count;                      /* Number of receivers seen for the stream, as of this frame */
 } aeron_stream_analysis_t;
-#define AERON_STREAM_ANALYSIS_FLAGS_WINDOW_FULL      0x00000001
-#define AERON_STREAM_ANALYSIS_FLAGS_IDLE_RX          0x00000002
-#define AERON_STREAM_ANALYSIS_FLAGS_PACING_RX        0x00000004
-#define AERON_STREAM_ANALYSIS_FLAGS_OOO              0x00000008
-#define AERON_STREAM_ANALYSIS_FLAGS_OOO_GAP          0x00000010
-#define AERON_STREAM_ANALYSIS_FLAGS_KEEPALIVE        0x00000020
-#define AERON_STREAM_ANALYSIS_FLAGS_WINDOW_RESIZE    0x00000040
-#define AERON_STREAM_ANALYSIS_FLAGS_OOO_SM           0x00000080
-#define AERON_STREAM_ANALYSIS_FLAGS_KEEPALIVE_SM     0x00000100
-#define AERON_STREAM_ANALYSIS_FLAGS_RX               0x00000200
-#define AERON_STREAM_ANALYSIS_FLAGS_TERM_ID_CHANGE   0x00000400
-
+/* AERON_STREAM_ANALYSIS_FLAGS_* values for the flags field are in packet-aeron.h */
 #define AERON_STREAM_ANALYSIS_FLAGS2_RCV_VALID       0x00000001
+#define AERON_STREAM_ANALYSIS_FLAGS2_LAG_VALID       0x00000002
+#define AERON_STREAM_ANALYSIS_FLAGS2_SLOWEST_VALID   0x00000004
 
 typedef struct
 {
@@ -194,8 +219,43 @@ typedef struct
 struct aeron_msg_t_stct;
 typedef struct aeron_msg_t_stct aeron_msg_t;
 
+struct aeron_transport_t_stct;
+typedef struct aeron_transport_t_stct aeron_transport_t;
+
+struct aeron_stream_t_stct;
+typedef struct aeron_stream_t_stct aeron_stream_t;
+
+struct aeron_term_t_stct;
+typedef struct aeron_term_t_stct aeron_term_t;
+
+struct aeron_fragment_t_stct;
+typedef struct aeron_fragment_t_stct aeron_fragment_t;
+
+/*
+    Analysis structures resolved for a frame on the first pass, so that re-dissection needs no lookups.
+    The term and fragment pointers are cleared if the term is evicted (streaming mode). The term ID may
+    since have been reused by a new term, so an evicted term is not looked up again.
+*/
+typedef struct
+{
+    aeron_transport_t * transport;
+    aeron_stream_t * stream;
+    aeron_term_t * term;
+    aeron_fragment_t * fragment;
+    gboolean term_evicted;                  /* The term has been evicted (streaming mode) */
+} aeron_frame_resolved_t;
+
+typedef struct
+{
+    guint32 terms;
+    guint32 fragments;
+    guint32 messages;
+    guint32 naks;
+} aeron_evicted_summary_t;
+
 struct aeron_frame_info_t_stct
 {
+    aeron_frame_info_t * next;              /* Next frame info (higher offset) within the same frame */
     guint32 frame;
     guint32 ofs;
     aeron_frame_link_t transport;
@@ -206,59 +266,114 @@ struct aeron_frame_info_t_stct
     aeron_nak_analysis_t * nak_analysis;
     aeron_msg_t * message;
     wmem_list_t * rx;
-    guint32 flags;
+    aeron_frame_resolved_t resolved;
+    aeron_evicted_summary_t * evicted;      /* Terms of the stream evicted by this frame (streaming mode), or NULL */
+    guint32 flags;                          /* AERON_FRAME_INFO_FLAGS_* (in packet-aeron.h) */
 };
-#define AERON_FRAME_INFO_FLAGS_RETRANSMISSION  0x00000001
-#define AERON_FRAME_INFO_FLAGS_KEEPALIVE       0x00000002
-#define AERON_FRAME_INFO_FLAGS_REASSEMBLED_MSG 0x00000004
 
-static wmem_tree_key_t * aeron_frame_info_key_build(guint32 frame, guint32 ofs)
-{
-    wmem_tree_key_t * fkey;
-    guint32 * key;
+/*
+    Frame information is kept in a dense, frame-number-indexed store. The store is a
+    directory of fixed-size chunks, each chunk holding one slot per frame number. A slot
+    is the head of a (short, usually single-entry) list of frame info entries for that
+    frame, ordered by the offset of the Aeron frame within the packet.
+*/
+#define AERON_FRAME_INFO_CHUNK_SHIFT 10
+#define AERON_FRAME_INFO_CHUNK_SIZE (1 << AERON_FRAME_INFO_CHUNK_SHIFT)
+#define AERON_FRAME_INFO_CHUNK_MASK (AERON_FRAME_INFO_CHUNK_SIZE - 1)
+#define AERON_FRAME_INFO_DIRECTORY_INITIAL_SIZE 64
 
-    fkey = wmem_alloc_array(wmem_packet_scope(), wmem_tree_key_t, 2);
-    key = wmem_alloc_array(wmem_packet_scope(), guint32, 2);
-    key[0] = frame;
-    key[1] = ofs;
-    fkey[0].length = 2;
-    fkey[0].key = key;
-    fkey[1].length = 0;
-    fkey[1].key = NULL;
-    return (fkey);
+static aeron_frame_info_t *** aeron_frame_info_directory = NULL;
+static guint32 aeron_frame_info_directory_size = 0;
+
+static void aeron_frame_info_init(void)
+{
+    /* The previous directory (if any) belonged to the previous file scope, and has already been freed. */
+    aeron_frame_info_directory = NULL;
+    aeron_frame_info_directory_size = 0;
 }
 
-static aeron_frame_info_t * aeron_frame_info_lookup(wmem_tree_key_t * key)
+static aeron_frame_info_t ** aeron_frame_info_slot(guint32 frame, gboolean create)
 {
-    aeron_frame_info_t * fi = NULL;
+    guint32 chunk_index = frame >> AERON_FRAME_INFO_CHUNK_SHIFT;
+    aeron_frame_info_t ** chunk = NULL;
 
-    fi = (aeron_frame_info_t *) wmem_tree_lookup32_array(aeron_frame_info_tree, key);
-    return (fi);
+    if (chunk_index >= aeron_frame_info_directory_size)
+    {
+        guint32 new_size = aeron_frame_info_directory_size;
+
+        if (!create)
+        {
+            return (NULL);
+        }
+        if (new_size == 0)
+        {
+            new_size = AERON_FRAME_INFO_DIRECTORY_INITIAL_SIZE;
+        }
+        while (chunk_index >= new_size)
+        {
+            new_size *= 2;
+        }
+        aeron_frame_info_directory = (aeron_frame_info_t ***) wmem_realloc(wmem_file_scope(), (void *) aeron_frame_info_directory, new_size * sizeof(aeron_frame_info_t **));
+        memset((void *) (aeron_frame_info_directory + aeron_frame_info_directory_size), 0, (new_size - aeron_frame_info_directory_size) * sizeof(aeron_frame_info_t **));
+        aeron_frame_info_directory_size = new_size;
+    }
+    chunk = aeron_frame_info_directory[chunk_index];
+    if (chunk == NULL)
+    {
+        if (!create)
+        {
+            return (NULL);
+        }
+        chunk = wmem_alloc0_array(wmem_file_scope(), aeron_frame_info_t *, AERON_FRAME_INFO_CHUNK_SIZE);
+        aeron_frame_info_directory[chunk_index] = chunk;
+    }
+    return (&(chunk[frame & AERON_FRAME_INFO_CHUNK_MASK]));
 }
 
 static aeron_frame_info_t * aeron_frame_info_find(guint32 frame, guint32 ofs)
 {
-    wmem_tree_key_t * key = aeron_frame_info_key_build(frame, ofs);
-    return (aeron_frame_info_lookup(key));
+    aeron_frame_info_t ** slot = aeron_frame_info_slot(frame, FALSE);
+    aeron_frame_info_t * fi = NULL;
+
+    if (slot == NULL)
+    {
+        return (NULL);
+    }
+    fi = *slot;
+    while ((fi != NULL) && (fi->ofs < ofs))
+    {
+        fi = fi->next;
+    }
+    if ((fi != NULL) && (fi->ofs == ofs))
+    {
+        return (fi);
+    }
+    return (NULL);
 }
 
 static aeron_frame_info_t * aeron_frame_info_add(guint32 frame, guint32 ofs)
 {
+    aeron_frame_info_t ** slot = aeron_frame_info_slot(frame, TRUE);
     aeron_frame_info_t * fi = NULL;
-    wmem_tree_key_t * key = aeron_frame_info_key_build(frame, ofs);
 
-    fi = aeron_frame_info_lookup(key);
-    if (fi == NULL)
+    /* Find the insertion point, keeping the per-frame list ordered by offset */
+    while ((*slot != NULL) && ((*slot)->ofs < ofs))
     {
-        fi = wmem_new0(wmem_file_scope(), aeron_frame_info_t);
-        fi->frame = frame;
-        fi->ofs = ofs;
-        if (aeron_sequence_analysis && aeron_stream_analysis)
-        {
-            fi->rx = wmem_list_new(wmem_file_scope());
-        }
-        wmem_tree_insert32_array(aeron_frame_info_tree, key, (void *) fi);
+        slot = &((*slot)->next);
+    }
+    if ((*slot != NULL) && ((*slot)->ofs == ofs))
+    {
+        return (*slot);
+    }
+    fi = wmem_new0(wmem_file_scope(), aeron_frame_info_t);
+    fi->frame = frame;
+    fi->ofs = ofs;
+    if (aeron_sequence_analysis && aeron_stream_analysis)
+    {
+        fi->rx = wmem_list_new(wmem_file_scope());
     }
+    fi->next = *slot;
+    *slot = fi;
     return (fi);
 }
 
@@ -289,32 +404,26 @@ typedef struct
     guint16 port2;
 } aeron_conversation_info_t;
 
-struct aeron_transport_t_stct;
-typedef struct aeron_transport_t_stct aeron_transport_t;
-
-struct aeron_stream_t_stct;
-typedef struct aeron_stream_t_stct aeron_stream_t;
-
-struct aeron_term_t_stct;
-typedef struct aeron_term_t_stct aeron_term_t;
-
-struct aeron_fragment_t_stct;
-typedef struct aeron_fragment_t_stct aeron_fragment_t;
-
 struct aeron_transport_t_stct
 {
     guint64 channel_id;
     wmem_tree_t * stream;                   /* Tree of all streams (aeron_stream_t) in this transport, keyed by stream ID */
+    wmem_tree_t * payload_heur;             /* Tree of the payload heuristic dissectors (heur_dtbl_entry_t) last matched on the first pass, keyed by stream ID */
     aeron_frame_info_t * last_frame;
     address addr1;
     address addr2;
     guint32 session_id;
     guint16 port1;
     guint16 port2;
+    const char * transport_uri;             /* Transport URI (shared with all transports in the conversation) */
 };
 
-struct aeron_stream_rcv_t_stct;
-typedef struct aeron_stream_rcv_t_stct aeron_stream_rcv_t;
+/* Aeron state for a conversation, kept as the conversation's proto data. */
+typedef struct
+{
+    wmem_tree_t * session;                  /* Tree of all transports (aeron_transport_t) in this conversation, keyed by session ID */
+    const char * transport_uri;             /* Transport URI for the Info column, rendered when the conversation is first seen */
+} aeron_conversation_t;
 
 struct aeron_stream_rcv_t_stct
 {
@@ -322,40 +431,80 @@ struct aeron_stream_rcv_t_stct
     guint16 port;                           /* Receiver's (sending) port */
     aeron_pos_t completed;
     guint32 receiver_window;
+    guint64 send_index;                     /* Absolute index of the first entry in the stream send timeline not yet completed by this receiver */
+    guint32 heap_index;                     /* Index of this receiver in the stream's receiver heap */
+    nstime_t last_sm_time;                  /* Time of this receiver's latest SM */
+    const char * name;                      /* Printable receiver address and port */
 };
 
+typedef struct
+{
+    aeron_pos_t end;                        /* Stream position at the end of the data */
+    nstime_t send_time;                     /* Time the data was first sent */
+    guint32 frame;                          /* Frame in which the data was first sent */
+} aeron_stream_send_t;
+
 struct aeron_stream_t_stct
 {
     aeron_transport_t * transport;          /* Parent transport */
     wmem_tree_t * term;                     /* Tree of all terms (aeron_term_t) in this stream, keyed by term ID */
-    wmem_list_t * rcv;                      /* List of receivers (aeron_stream_rcv_t) */
+    wmem_map_t * rcv;                       /* Map of receivers (aeron_stream_rcv_t), keyed by address and port */
+    aeron_stream_rcv_t ** rcv_heap;         /* Receivers as a binary min-heap on completed position, so rcv_heap[0] is the slowest */
+    guint32 rcv_heap_size;                  /* Allocated size of rcv_heap (rcv_count entries are in use) */
     guint32 rcv_count;
+    nstime_t rcv_sweep_time;                /* Time at which idle receivers were last looked for */
     aeron_frame_info_t * last_frame;
     guint32 stream_id;
     guint32 term_length;
     guint32 mtu;
     guint32 flags;
     aeron_pos_t high;
+    aeron_stream_send_t * send;             /* Ring of data (aeron_stream_send_t) which advanced the high position, in send order */
+    guint32 send_size;                      /* Allocated size of the send ring (a power of 2) */
+    guint32 send_head;                      /* Ring index of the oldest entry */
+    guint32 send_count;                     /* Number of entries in the ring */
+    guint64 send_base;                      /* Absolute index of the oldest entry */
+    wmem_list_t * live_term;                /* List of terms (aeron_term_t) not yet evicted, in creation order (streaming mode only) */
+    aeron_evicted_summary_t evicted;        /* Summary of evicted terms (streaming mode only) */
 };
 #define AERON_STREAM_FLAGS_HIGH_VALID 0x1
 
-typedef struct
+struct aeron_nak_t_stct;
+typedef struct aeron_nak_t_stct aeron_nak_t;
+
+/*
+    The NAKs of a term form an interval tree: an AVL tree keyed by NAK term offset, in which each
+    node also holds the highest NAK end in its subtree. NAKs with the same term offset go left.
+*/
+struct aeron_nak_t_stct
 {
     aeron_term_t * term;                    /* Parent term */
     aeron_frame_info_t * frame_info;        /* Frame info (aeron_frame_info_t) in which this NAK occurred */
     guint32 term_offset;                    /* NAK term offset */
-    guint32 length;                         /* Length of NAK */
-} aeron_nak_t;
+    guint32 length;                         /* Length of NAK, clamped to the term */
+    aeron_nak_t * left;                     /* NAKs with a lower or equal term offset */
+    aeron_nak_t * right;                    /* NAKs with a higher term offset */
+    guint32 max_end;                        /* Highest NAK end (term offset + length) in this subtree */
+    guint32 height;                         /* Height of this subtree */
+};
 
 struct aeron_term_t_stct
 {
+    wmem_allocator_t * scope;               /* Allocator for everything owned by this term (the term's own allocator in streaming mode) */
     aeron_stream_t * stream;                /* Parent stream */
     wmem_tree_t * fragment;                 /* Tree of all fragments (aeron_fragment_t) in this term, keyed by term offset */
     wmem_tree_t * message;                  /* Tree of all fragmented messages (aeron_msg_t) in this term, keyed by lowest term offset */
-    wmem_list_t * orphan_fragment;
+    wmem_tree_t * message_pending;          /* Tree of incomplete fragmented messages (aeron_msg_t) in this term, keyed by next expected term offset */
+    wmem_tree_t * orphan_fragment;          /* Tree of fragments (aeron_msg_fragment_t) not yet part of a message, keyed by term offset */
+    guint32 orphan_fragment_count;
     aeron_frame_info_t * last_frame;        /* Pointer to last frame seen for this term */
-    wmem_list_t * nak;                      /* List of all NAKs (aeron_nak_t) in this term */
+    aeron_nak_t * nak;                      /* Interval tree of all NAKs (aeron_nak_t) in this term */
     guint32 term_id;
+    guint32 fragment_count;
+    guint32 message_count;
+    guint32 nak_count;
+    wmem_list_t * reassembled_frame;        /* List of frames (aeron_frame_info_t) referencing a message in this term (streaming mode only) */
+    wmem_list_t * reassembled_tvb;          /* List of reassembled message tvbs (tvbuff_t) to free with this term (streaming mode only) */
 };
 
 struct aeron_fragment_t_stct
@@ -371,6 +520,77 @@ struct aeron_fragment_t_stct
     guint32 frame_count;
 };
 
+/*----------------------------------------------------------------------------*/
+/* Utilioty functions.                                                        */
+/*----------------------------------------------------------------------------*/
+static gboolean aeron_is_address_multicast(const address * addr)
+{
+    guint8 * addr_data = (guint8 *) addr->data;
+
+    switch (addr->type)
+    {
+        case AT_IPv4:
+            if ((addr_data[0] & 0xf0) == 0xe0)
+            {
+                return (TRUE);
+            }
+            break;
+        case AT_IPv6:
+            if (addr_data[0] == 0xff)
+            {
+                return (TRUE);
+            }
+            break;
+        default:
+            break;
+    }
+    return (FALSE);
+}
+
+static char * aeron_format_transport_uri(wmem_allocator_t * scope, const aeron_conversation_info_t * cinfo)
+{
+    wmem_strbuf_t * uri = NULL;
+
+    uri = wmem_strbuf_new(scope, "aeron:");
+    switch (cinfo->ptype)
+    {
+        case PT_UDP:
+            wmem_strbuf_append(uri, "udp");
+            break;
+        default:
+            wmem_strbuf_append(uri, "unknown");
+            break;
+    }
+    wmem_strbuf_append_c(uri, '?');
+    if (aeron_is_address_multicast(cinfo->addr2))
+    {
+        switch (cinfo->addr2->type)
+        {
+            case AT_IPv6:
+                wmem_strbuf_append_printf(uri, "group=[%s]:%" G_GUINT16_FORMAT, address_to_str(wmem_packet_scope(), cinfo->addr2), cinfo->port2);
+                break;
+            case AT_IPv4:
+            default:
+                wmem_strbuf_append_printf(uri, "group=%s:%" G_GUINT16_FORMAT, address_to_str(wmem_packet_scope(), cinfo->addr2), cinfo->port2);
+                break;
+        }
+    }
+    else
+    {
+        switch (cinfo->addr2->type)
+        {
+            case AT_IPv6:
+                wmem_strbuf_append_printf(uri, "remote=[%s]:%" G_GUINT16_FORMAT, address_to_str(wmem_packet_scope(), cinfo->addr2), cinfo->port2);
+                break;
+            case AT_IPv4:
+            default:
+                wmem_strbuf_append_printf(uri, "remote=%s:%" G_GUINT16_FORMAT, address_to_str(wmem_packet_scope(), cinfo->addr2), cinfo->port2);
+                break;
+        }
+    }
+    return (wmem_strbuf_finalize(uri));
+}
+
 /*----------------------------------------------------------------------------*/
 /* Aeron transport management.                                                */
 /*----------------------------------------------------------------------------*/
@@ -378,7 +598,7 @@ static aeron_transport_t * aeron_transport_add(const aeron_conversation_info_t *
 {
     aeron_transport_t * transport;
     conversation_t * conv = NULL;
-    wmem_tree_t * session_tree = NULL;
+    aeron_conversation_t * aconv = NULL;
 
     conv = find_conversation(frame, cinfo->addr1, cinfo->addr2, cinfo->ptype, cinfo->port1, cinfo->port2, 0);
     if (conv == NULL)
@@ -389,13 +609,15 @@ static aeron_transport_t * aeron_transport_add(const aeron_conversation_info_t *
     {
         conv->last_frame = frame;
     }
-    session_tree = (wmem_tree_t *) conversation_get_proto_data(conv, proto_aeron);
-    if (session_tree == NULL)
+    aconv = (aeron_conversation_t *) conversation_get_proto_data(conv, proto_aeron);
+    if (aconv == NULL)
     {
-        session_tree = wmem_tree_new(wmem_file_scope());
-        conversation_add_proto_data(conv, proto_aeron, (void *) session_tree);
+        aconv = wmem_new0(wmem_file_scope(), aeron_conversation_t);
+        aconv->session = wmem_tree_new(wmem_file_scope());
+        aconv->transport_uri = aeron_format_transport_uri(wmem_file_scope(), cinfo);
+        conversation_add_proto_data(conv, proto_aeron, (void *) aconv);
     }
-    transport = (aeron_transport_t *) wmem_tree_lookup32(session_tree, session_id);
+    transport = (aeron_transport_t *) wmem_tree_lookup32(aconv->session, session_id);
     if (transport != NULL)
     {
         return (transport);
@@ -403,16 +625,74 @@ static aeron_transport_t * aeron_transport_add(const aeron_conversation_info_t *
     transport = wmem_new0(wmem_file_scope(), aeron_transport_t);
     transport->channel_id = aeron_channel_id_assign();
     transport->stream = wmem_tree_new(wmem_file_scope());
+    transport->payload_heur = wmem_tree_new(wmem_file_scope());
     transport->last_frame = NULL;
     WMEM_COPY_ADDRESS(wmem_file_scope(), &(transport->addr1), cinfo->addr1);
     WMEM_COPY_ADDRESS(wmem_file_scope(), &(transport->addr2), cinfo->addr2);
     transport->session_id = session_id;
     transport->port1 = cinfo->port1;
     transport->port2 = cinfo->port2;
-    wmem_tree_insert32(session_tree, session_id, (void *) transport);
+    transport->transport_uri = aconv->transport_uri;
+    wmem_tree_insert32(aconv->session, session_id, (void *) transport);
     return (transport);
 }
 
+static aeron_transport_t * aeron_transport_get(const aeron_conversation_info_t * cinfo, guint32 session_id, packet_info * pinfo, aeron_frame_info_t * finfo)
+{
+    aeron_transport_t * transport = NULL;
+
+    if ((finfo != NULL) && (finfo->resolved.transport != NULL))
+    {
+        return (finfo->resolved.transport);
+    }
+    transport = aeron_transport_add(cinfo, session_id, pinfo->fd->num);
+    if (finfo != NULL)
+    {
+        finfo->resolved.transport = transport;
+    }
+    return (transport);
+}
+
+static const char * aeron_transport_uri(const aeron_conversation_info_t * cinfo, guint32 frame)
+{
+    aeron_frame_info_t * finfo = NULL;
+    conversation_t * conv = NULL;
+    aeron_conversation_t * aconv = NULL;
+
+    /* On re-dissection, the first Aeron frame in the packet already knows its transport. */
+    finfo = aeron_frame_info_find(frame, 0);
+    if ((finfo != NULL) && (finfo->resolved.transport != NULL))
+    {
+        return (finfo->resolved.transport->transport_uri);
+    }
+    conv = find_conversation(frame, cinfo->addr1, cinfo->addr2, cinfo->ptype, cinfo->port1, cinfo->port2, 0);
+    if (conv != NULL)
+    {
+        aconv = (aeron_conversation_t *) conversation_get_proto_data(conv, proto_aeron);
+        if (aconv != NULL)
+        {
+            return (aconv->transport_uri);
+        }
+    }
+    /* First packet of the conversation: the URI is kept once the transport has been added. */
+    return (aeron_format_transport_uri(wmem_packet_scope(), cinfo));
+}
+
+static guint aeron_stream_rcv_hash(gconstpointer key)
+{
+    const aeron_stream_rcv_t * rcv = (const aeron_stream_rcv_t *) key;
+
+    return (add_address_to_hash((guint) rcv->port, &(rcv->addr)));
+}
+
+static gboolean aeron_stream_rcv_equal(gconstpointer key1, gconstpointer key2)
+{
+    const aeron_stream_rcv_t * rcv1 = (const aeron_stream_rcv_t *) key1;
+    const aeron_stream_rcv_t * rcv2 = (const aeron_stream_rcv_t *) key2;
+
+    return ((rcv1->port == rcv2->port) && (cmp_address(&(rcv1->addr), &(rcv2->addr)) == 0));
+}
+
 static aeron_stream_t * aeron_transport_stream_find(aeron_transport_t * transport, guint32 stream_id)
 {
     aeron_stream_t * stream = NULL;
@@ -431,8 +711,11 @@ static aeron_stream_t * aeron_transport_stream_add(aeron_transport_t * transport
         stream = wmem_new0(wmem_file_scope(), aeron_stream_t);
         stream->transport = transport;
         stream->term = wmem_tree_new(wmem_file_scope());
-        stream->rcv = wmem_list_new(wmem_file_scope());
+        stream->rcv = wmem_map_new(wmem_file_scope(), aeron_stream_rcv_hash, aeron_stream_rcv_equal);
+        stream->rcv_heap = NULL;
+        stream->rcv_heap_size = 0;
         stream->rcv_count = 0;
+        nstime_set_zero(&(stream->rcv_sweep_time));
         stream->last_frame = NULL;
         stream->stream_id = stream_id;
         stream->term_length = 0;
@@ -440,6 +723,12 @@ static aeron_stream_t * aeron_transport_stream_add(aeron_transport_t * transport
         stream->flags = 0;
         stream->high.term_id = 0;
         stream->high.term_offset = 0;
+        stream->send = NULL;
+        stream->send_size = 0;
+        stream->send_head = 0;
+        stream->send_count = 0;
+        stream->send_base = 0;
+        stream->live_term = wmem_list_new(wmem_file_scope());
         wmem_tree_insert32(transport->stream, stream_id, (void *) stream);
     }
     return (stream);
@@ -460,6 +749,99 @@ static void aeron_transport_frame_add(aeron_transport_t * transport, aeron_frame
     transport->last_frame = finfo;
 }
 
+/*----------------------------------------------------------------------------*/
+/* Aeron term storage.                                                        */
+/*----------------------------------------------------------------------------*/
+/*
+    Normally everything owned by a term lives in file scope. In streaming mode each term gets its own
+    allocator instead, so that the whole term (fragments, messages, reassembled data, and NAKs) can be
+    released once it falls outside the term window. Live terms are tracked here so any left over when
+    the capture file is closed are released too.
+*/
+static GHashTable * aeron_term_live = NULL;
+
+static wmem_allocator_t * aeron_term_scope_new(void)
+{
+    if (aeron_streaming_term_window == 0)
+    {
+        return (wmem_file_scope());
+    }
+    /* Not a block allocator: each of those reserves a whole block, however small the term. */
+    return (wmem_allocator_new(WMEM_ALLOCATOR_SIMPLE));
+}
+
+static void aeron_term_release(aeron_term_t * term, gboolean clear_frames)
+{
+    wmem_list_frame_t * lf = NULL;
+
+    if (clear_frames)
+    {
+        guint32 frame = ((term->last_frame != NULL) ? term->last_frame->frame : 0);
+
+        /* The frames themselves outlive the term, so make sure they no longer reference its messages. */
+        lf = wmem_list_head(term->reassembled_frame);
+        while (lf != NULL)
+        {
+            aeron_frame_info_t * finfo = (aeron_frame_info_t *) wmem_list_frame_data(lf);
+            finfo->message = NULL;
+            finfo->flags &= ~AERON_FRAME_INFO_FLAGS_REASSEMBLED_MSG;
+            lf = wmem_list_frame_next(lf);
+        }
+        /* Likewise for the resolved term and fragment pointers, walking the term's frames from the last one back. */
+        while (frame != 0)
+        {
+            aeron_frame_info_t ** slot = aeron_frame_info_slot(frame, FALSE);
+            aeron_frame_info_t * finfo = ((slot != NULL) ? *slot : NULL);
+            guint32 previous = 0;
+
+            while (finfo != NULL)
+            {
+                if (finfo->resolved.term == term)
+                {
+                    finfo->resolved.term = NULL;
+                    finfo->resolved.term_evicted = TRUE;
+                    finfo->resolved.fragment = NULL;
+                    if (finfo->term.previous != frame)
+                    {
+                        previous = finfo->term.previous;
+                    }
+                }
+                finfo = finfo->next;
+            }
+            frame = previous;
+        }
+    }
+    lf = wmem_list_head(term->reassembled_tvb);
+    while (lf != NULL)
+    {
+        tvb_free_chain((tvbuff_t *) wmem_list_frame_data(lf));
+        lf = wmem_list_frame_next(lf);
+    }
+    g_hash_table_remove(aeron_term_live, (gconstpointer) term);
+    wmem_destroy_allocator(term->scope);
+}
+
+static void aeron_term_live_init(void)
+{
+    GHashTableIter iter;
+    gpointer key;
+
+    if (aeron_term_live == NULL)
+    {
+        aeron_term_live = g_hash_table_new(g_direct_hash, g_direct_equal);
+        return;
+    }
+    /* The frame information has already gone with the previous file scope, so only release the terms. */
+    g_hash_table_iter_init(&iter, aeron_term_live);
+    while (g_hash_table_iter_next(&iter, &key, NULL))
+    {
+        aeron_term_t * term = (aeron_term_t *) key;
+
+        g_hash_table_iter_steal(&iter);
+        aeron_term_release(term, FALSE);
+    }
+}
+
 /*----------------------------------------------------------------------------*/
 /* Aeron stream management.                                                   */
 /*----------------------------------------------------------------------------*/
@@ -478,37 +860,108 @@ static aeron_term_t * aeron_stream_term_add(aeron_stream_t * stream, guint32 ter
     term = aeron_stream_term_find(stream, term_id);
     if (term == NULL)
     {
-        term = wmem_new0(wmem_file_scope(), aeron_term_t);
+        wmem_allocator_t * scope = aeron_term_scope_new();
+
+        term = wmem_new0(scope, aeron_term_t);
+        term->scope = scope;
         term->stream = stream;
-        term->fragment = wmem_tree_new(wmem_file_scope());
-        term->message = wmem_tree_new(wmem_file_scope());
-        term->orphan_fragment = wmem_list_new(wmem_file_scope());
-        term->nak = wmem_list_new(wmem_file_scope());
+        term->fragment = wmem_tree_new(scope);
+        term->message = wmem_tree_new(scope);
+        term->message_pending = wmem_tree_new(scope);
+        term->orphan_fragment = wmem_tree_new(scope);
+        term->orphan_fragment_count = 0;
+        term->nak = NULL;
         term->term_id = term_id;
+        term->fragment_count = 0;
+        term->message_count = 0;
+        term->nak_count = 0;
         wmem_tree_insert32(stream->term, term_id, (void *) term);
+        if (aeron_streaming_term_window > 0)
+        {
+            term->reassembled_frame = wmem_list_new(scope);
+            term->reassembled_tvb = wmem_list_new(scope);
+            wmem_list_append(stream->live_term, (void *) term);
+            g_hash_table_insert(aeron_term_live, (gpointer) term, (gpointer) term);
+        }
+    }
+    return (term);
+}
+
+static aeron_stream_rcv_t * aeron_stream_rcv_find(aeron_stream_t * stream, const address * addr, guint16 port)
+{
+    aeron_stream_rcv_t key;
+
+    /* Only the address and port are used by the map's hash and equality functions. */
+    key.addr = *addr;
+    key.port = port;
+    return ((aeron_stream_rcv_t *) wmem_map_lookup(stream->rcv, (const void *) &key));
+}
+
+/*
+    The receivers of a stream are also kept in a binary min-heap ordered by completed position. A receiver's
+    position changes only with its own SMs, so each SM costs O(log n) to keep the slowest receiver at the root.
+*/
+static void aeron_stream_rcv_heap_update(aeron_stream_t * stream, aeron_stream_rcv_t * rcv)
+{
+    aeron_stream_rcv_t ** heap = stream->rcv_heap;
+    guint32 idx = rcv->heap_index;
+
+    /* Move towards the root while less than the parent. */
+    while (idx > 0)
+    {
+        guint32 parent = (idx - 1) / 2;
+
+        if (aeron_pos_compare(&(heap[parent]->completed), &(rcv->completed)) <= 0)
+        {
+            break;
+        }
+        heap[idx] = heap[parent];
+        heap[idx]->heap_index = idx;
+        idx = parent;
+    }
+    /* Move away from the root while greater than the lesser child. */
+    while (((2 * idx) + 1) < stream->rcv_count)
+    {
+        guint32 child = (2 * idx) + 1;
+
+        if (((child + 1) < stream->rcv_count) && (aeron_pos_compare(&(heap[child + 1]->completed), &(heap[child]->completed)) < 0))
+        {
+            child++;
+        }
+        if (aeron_pos_compare(&(heap[child]->completed), &(rcv->completed)) >= 0)
+        {
+            break;
+        }
+        heap[idx] = heap[child];
+        heap[idx]->heap_index = idx;
+        idx = child;
+    }
+    heap[idx] = rcv;
+    rcv->heap_index = idx;
+}
+
+/* Remove a receiver from the heap and the map. It stays allocated, as frames may still reference it. */
+static void aeron_stream_rcv_remove(aeron_stream_t * stream, aeron_stream_rcv_t * rcv)
+{
+    guint32 idx = rcv->heap_index;
+
+    wmem_map_remove(stream->rcv, (const void *) rcv);
+    stream->rcv_count--;
+    if (idx < stream->rcv_count)
+    {
+        stream->rcv_heap[idx] = stream->rcv_heap[stream->rcv_count];
+        stream->rcv_heap[idx]->heap_index = idx;
+        aeron_stream_rcv_heap_update(stream, stream->rcv_heap[idx]);
     }
-    return (term);
 }
 
-static aeron_stream_rcv_t * aeron_stream_rcv_find(aeron_stream_t * stream, const address * addr, guint16 port)
+static aeron_stream_rcv_t * aeron_stream_rcv_slowest(aeron_stream_t * stream)
 {
-    wmem_list_frame_t * lf = wmem_list_head(stream->rcv);
-    aeron_stream_rcv_t * rcv = NULL;
-
-    while (lf != NULL)
+    if (stream->rcv_count == 0)
     {
-        aeron_stream_rcv_t * cur = (aeron_stream_rcv_t *) wmem_list_frame_data(lf);
-        if (cur != NULL)
-        {
-            if ((cmp_address(&(cur->addr), addr) == 0) && (cur->port == port))
-            {
-                rcv = cur;
-                break;
-            }
-        }
-        lf = wmem_list_frame_next(lf);
+        return (NULL);
     }
-    return (rcv);
+    return (stream->rcv_heap[0]);
 }
 
 static aeron_stream_rcv_t * aeron_stream_rcv_add(aeron_stream_t * stream, const address * addr, guint16 port)
@@ -526,8 +979,26 @@ static aeron_stream_rcv_t * aeron_stream_rcv_add(aeron_stream_t * stream, const
     rcv->completed.term_id = 0;
     rcv->completed.term_offset = 0;
     rcv->receiver_window = 0;
-    wmem_list_append(stream->rcv, (void *) rcv);
+    rcv->send_index = stream->send_base;
+    nstime_set_zero(&(rcv->last_sm_time));
+    if (addr->type == AT_IPv6)
+    {
+        rcv->name = wmem_strdup_printf(wmem_file_scope(), "[%s]:%" G_GUINT16_FORMAT, address_to_str(wmem_packet_scope(), addr), port);
+    }
+    else
+    {
+        rcv->name = wmem_strdup_printf(wmem_file_scope(), "%s:%" G_GUINT16_FORMAT, address_to_str(wmem_packet_scope(), addr), port);
+    }
+    wmem_map_insert(stream->rcv, (const void *) rcv, (void *) rcv);
+    if (stream->rcv_count == stream->rcv_heap_size)
+    {
+        stream->rcv_heap_size = ((stream->rcv_heap_size == 0) ? 8 : (stream->rcv_heap_size * 2));
+        stream->rcv_heap = (aeron_stream_rcv_t **) wmem_realloc(wmem_file_scope(), (void *) stream->rcv_heap, stream->rcv_heap_size * sizeof(aeron_stream_rcv_t *));
+    }
+    rcv->heap_index = stream->rcv_count;
+    stream->rcv_heap[stream->rcv_count] = rcv;
     stream->rcv_count++;
+    aeron_stream_rcv_heap_update(stream, rcv);
     return (rcv);
 }
 
@@ -565,9 +1036,9 @@ static aeron_fragment_t * aeron_term_fragment_add(aeron_term_t * term, guint32 t
     fragment = (aeron_fragment_t *) wmem_tree_lookup32(term->fragment, term_offset);
     if (fragment == NULL)
     {
-        fragment = wmem_new0(wmem_file_scope(), aeron_fragment_t);
+        fragment = wmem_new0(term->scope, aeron_fragment_t);
         fragment->term = term;
-        fragment->frame = wmem_list_new(wmem_file_scope());
+        fragment->frame = wmem_list_new(term->scope);
         fragment->first_frame = NULL;
         fragment->last_frame = NULL;
         fragment->first_data_frame = NULL;
@@ -576,6 +1047,7 @@ static aeron_fragment_t * aeron_term_fragment_add(aeron_term_t * term, guint32 t
         fragment->data_length = data_length;
         fragment->frame_count = 0;
         wmem_tree_insert32(term->fragment, term_offset, (void *) fragment);
+        term->fragment_count++;
     }
     return (fragment);
 }
@@ -596,6 +1068,48 @@ static void aeron_term_frame_add(aeron_term_t * term, aeron_frame_info_t * finfo
     aeron_stream_frame_add(term->stream, finfo, 0);
 }
 
+static void aeron_stream_term_evict(aeron_stream_t * stream, guint32 newest_term_id, aeron_frame_info_t * finfo)
+{
+    wmem_list_frame_t * lf = wmem_list_head(stream->live_term);
+    guint32 frame = finfo->frame;
+    aeron_evicted_summary_t evicted;
+
+    memset((void *) &evicted, 0, sizeof(aeron_evicted_summary_t));
+
+    while (lf != NULL)
+    {
+        wmem_list_frame_t * next = wmem_list_frame_next(lf);
+        aeron_term_t * term = (aeron_term_t *) wmem_list_frame_data(lf);
+        guint32 age = newest_term_id - term->term_id;
+
+        /*
+            Evict terms at least the term window behind the newest term (allowing for term ID wrap), but
+            never one touched by the current frame, since its data may still be referenced by this packet.
+        */
+        if ((age >= aeron_streaming_term_window) && (age < 0x80000000)
+            && ((term->last_frame == NULL) || (term->last_frame->frame < frame)))
+        {
+            evicted.terms++;
+            evicted.fragments += term->fragment_count;
+            evicted.messages += term->message_count;
+            evicted.naks += term->nak_count;
+            wmem_tree_insert32(stream->term, term->term_id, NULL);
+            wmem_list_remove_frame(stream->live_term, lf);
+            aeron_term_release(term, TRUE);
+        }
+        lf = next;
+    }
+    if (evicted.terms > 0)
+    {
+        stream->evicted.terms += evicted.terms;
+        stream->evicted.fragments += evicted.fragments;
+        stream->evicted.messages += evicted.messages;
+        stream->evicted.naks += evicted.naks;
+        /* Kept with the frame, so that taps see each eviction once, on any pass. */
+        finfo->evicted = (aeron_evicted_summary_t *) wmem_memdup(wmem_file_scope(), (const void *) &evicted, sizeof(aeron_evicted_summary_t));
+    }
+}
+
 /*----------------------------------------------------------------------------*/
 /* Aeron fragment management.                                                 */
 /*----------------------------------------------------------------------------*/
@@ -629,74 +1143,109 @@ static void aeron_fragment_frame_add(aeron_fragment_t * fragment, aeron_frame_in
 }
 
 /*----------------------------------------------------------------------------*/
-/* Utilioty functions.                                                        */
+/* Resolved frame info lookups.                                               */
 /*----------------------------------------------------------------------------*/
-static gboolean aeron_is_address_multicast(const address * addr)
+/*
+    These return the stream, term, or fragment for a frame, using the pointers kept in the frame info by the
+    first pass where possible, and falling back to a lookup otherwise (no sequence analysis, or an evicted term).
+*/
+static aeron_stream_t * aeron_resolved_stream(aeron_frame_info_t * finfo, aeron_transport_t * transport, guint32 stream_id)
 {
-    guint8 * addr_data = (guint8 *) addr->data;
+    if ((finfo != NULL) && (finfo->resolved.stream != NULL))
+    {
+        return (finfo->resolved.stream);
+    }
+    return (aeron_transport_stream_find(transport, stream_id));
+}
 
-    switch (addr->type)
+static aeron_term_t * aeron_resolved_term(aeron_frame_info_t * finfo, aeron_stream_t * stream, guint32 term_id)
+{
+    if ((finfo != NULL) && (finfo->resolved.term != NULL))
     {
-        case AT_IPv4:
-            if ((addr_data[0] & 0xf0) == 0xe0)
-            {
-                return (TRUE);
-            }
-            break;
-        case AT_IPv6:
-            if (addr_data[0] == 0xff)
-            {
-                return (TRUE);
-            }
-            break;
-        default:
-            break;
+        return (finfo->resolved.term);
     }
-    return (FALSE);
+    if ((finfo != NULL) && finfo->resolved.term_evicted)
+    {
+        return (NULL);
+    }
+    return (aeron_stream_term_find(stream, term_id));
 }
 
-static char * aeron_format_transport_uri(const aeron_conversation_info_t * cinfo)
+static aeron_fragment_t * aeron_resolved_fragment(aeron_frame_info_t * finfo, aeron_term_t * term, guint32 term_offset)
 {
-    wmem_strbuf_t * uri = NULL;
+    if ((finfo != NULL) && (finfo->resolved.fragment != NULL))
+    {
+        return (finfo->resolved.fragment);
+    }
+    return (aeron_term_fragment_find(term, term_offset));
+}
 
-    uri = wmem_strbuf_new(wmem_file_scope(), "aeron:");
-    switch (cinfo->ptype)
+/*----------------------------------------------------------------------------*/
+/* Heuristic verdict cache.                                                   */
+/*----------------------------------------------------------------------------*/
+/*
+    The UDP heuristic is run for every UDP packet not claimed by a port. To avoid re-probing flows which
+    are clearly not Aeron, the probe results of each UDP conversation are remembered. A conversation is
+    rejected without probing for all later frames only once AERON_HEUR_VERDICT_REJECT_PROBES probes have
+    failed and none has succeeded, so a single non-Aeron or truncated datagram never hides a flow. A
+    conversation with a successful probe is always probed. The rejecting frame number is kept so that
+    re-dissection gives the same results as the first pass.
+*/
+#define AERON_HEUR_VERDICT_REJECT_PROBES 8
+
+typedef struct
+{
+    guint32 failed_probes;                  /* Failed probes so far (first pass only) */
+    guint32 reject_frame;                   /* Frame at which the conversation was rejected, or 0 if not rejected */
+    gboolean accepted;                      /* A probe succeeded, so the conversation is never rejected */
+} aeron_heur_verdict_t;
+
+static wmem_map_t * aeron_heur_verdict_map = NULL;
+
+static void aeron_heur_verdict_init(void)
+{
+    aeron_heur_verdict_map = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+}
+
+static gboolean aeron_heur_verdict_rejected(packet_info * pinfo, conversation_t ** conv_out)
+{
+    conversation_t * conv = find_or_create_conversation(pinfo);
+    aeron_heur_verdict_t * verdict = (aeron_heur_verdict_t *) wmem_map_lookup(aeron_heur_verdict_map, (const void *) conv);
+
+    *conv_out = conv;
+    if (verdict == NULL)
     {
-        case PT_UDP:
-            wmem_strbuf_append(uri, "udp");
-            break;
-        default:
-            wmem_strbuf_append(uri, "unknown");
-            break;
+        return (FALSE);
     }
-    wmem_strbuf_append_c(uri, '?');
-    if (aeron_is_address_multicast(cinfo->addr2))
+    return ((verdict->reject_frame != 0) && (pinfo->fd->num > verdict->reject_frame));
+}
+
+static void aeron_heur_verdict_set(packet_info * pinfo, conversation_t * conv, gboolean accepted)
+{
+    aeron_heur_verdict_t * verdict = NULL;
+
+    if (PINFO_FD_VISITED(pinfo) != 0)
     {
-        switch (cinfo->addr2->type)
-        {
-            case AT_IPv6:
-                wmem_strbuf_append_printf(uri, "group=[%s]:%" G_GUINT16_FORMAT, address_to_str(wmem_packet_scope(), cinfo->addr2), cinfo->port2);
-                break;
-            case AT_IPv4:
-            default:
-                wmem_strbuf_append_printf(uri, "group=%s:%" G_GUINT16_FORMAT, address_to_str(wmem_packet_scope(), cinfo->addr2), cinfo->port2);
-                break;
-        }
+        return;
     }
-    else
+    verdict = (aeron_heur_verdict_t *) wmem_map_lookup(aeron_heur_verdict_map, (const void *) conv);
+    if (verdict == NULL)
     {
-        switch (cinfo->addr2->type)
+        verdict = wmem_new0(wmem_file_scope(), aeron_heur_verdict_t);
+        wmem_map_insert(aeron_heur_verdict_map, (const void *) conv, (void *) verdict);
+    }
+    if (accepted)
+    {
+        verdict->accepted = TRUE;
+    }
+    else if (!verdict->accepted && (verdict->reject_frame == 0))
+    {
+        verdict->failed_probes++;
+        if (verdict->failed_probes >= AERON_HEUR_VERDICT_REJECT_PROBES)
         {
-            case AT_IPv6:
-                wmem_strbuf_append_printf(uri, "remote=[%s]:%" G_GUINT16_FORMAT, address_to_str(wmem_packet_scope(), cinfo->addr2), cinfo->port2);
-                break;
-            case AT_IPv4:
-            default:
-                wmem_strbuf_append_printf(uri, "remote=%s:%" G_GUINT16_FORMAT, address_to_str(wmem_packet_scope(), cinfo->addr2), cinfo->port2);
-                break;
+            verdict->reject_frame = pinfo->fd->num;
         }
     }
-    return (wmem_strbuf_finalize(uri));
 }
 
 /*----------------------------------------------------------------------------*/
@@ -784,13 +1333,7 @@ static char * aeron_format_transport_uri(const aeron_conversation_info_t * cinfo
 
 #define HDR_LENGTH_MIN 12
 
-#define HDR_TYPE_PAD 0x0000
-#define HDR_TYPE_DATA 0x0001
-#define HDR_TYPE_NAK 0x0002
-#define HDR_TYPE_SM 0x0003
-#define HDR_TYPE_ERR 0x0004
-#define HDR_TYPE_SETUP 0x0005
-#define HDR_TYPE_EXT 0xFFFF
+/* HDR_TYPE_* frame types are in packet-aeron.h */
 
 #define DATA_FLAGS_BEGIN 0x80
 #define DATA_FLAGS_END 0x40
@@ -1080,6 +1623,13 @@ static int hf_aeron_stream_analysis_high_term_offset = -1;
 static int hf_aeron_stream_analysis_completed_term_id = -1;
 static int hf_aeron_stream_analysis_completed_term_offset = -1;
 static int hf_aeron_stream_analysis_outstanding_bytes = -1;
+static int hf_aeron_stream_analysis_receiver_lag = -1;
+static int hf_aeron_stream_analysis_receiver_lag_frame = -1;
+static int hf_aeron_stream_analysis_receiver_count = -1;
+static int hf_aeron_stream_analysis_slowest_receiver = -1;
+static int hf_aeron_stream_analysis_min_completed_term_id = -1;
+static int hf_aeron_stream_analysis_min_completed_term_offset = -1;
+static int hf_aeron_stream_analysis_min_outstanding_bytes = -1;
 
 /* Expert info handles */
 static expert_field ei_aeron_analysis_nak = EI_INIT;
@@ -1120,21 +1670,20 @@ static void aeron_frame_nak_rx_add(aeron_frame_info_t * nak_info, aeron_frame_in
 {
     if (nak_info->nak_analysis->unrecovered_length >= length)
     {
-        wmem_list_frame_t * lf = wmem_list_head(nak_info->nak_analysis->rx);
+        guint32 rx_key_value[2];
+        wmem_tree_key_t rx_key[2];
         aeron_rx_info_t * rx = NULL;
 
-        while (lf != NULL)
+        rx_key_value[0] = term_offset;
+        rx_key_value[1] = length;
+        rx_key[0].length = 2;
+        rx_key[0].key = rx_key_value;
+        rx_key[1].length = 0;
+        rx_key[1].key = NULL;
+        if (wmem_tree_lookup32_array(nak_info->nak_analysis->rx_index, rx_key) != NULL)
         {
-            rx = (aeron_rx_info_t *) wmem_list_frame_data(lf);
-            if (rx != NULL)
-            {
-                if ((rx->term_offset == term_offset) && (rx->length == length))
-                {
-                    /* Already have this RX */
-                    return;
-                }
-            }
-            lf = wmem_list_frame_next(lf);
+            /* Already have this RX */
+            return;
         }
         /* This RX frame isn't in the list, so add it */
         rx = wmem_new0(wmem_file_scope(), aeron_rx_info_t);
@@ -1142,49 +1691,304 @@ static void aeron_frame_nak_rx_add(aeron_frame_info_t * nak_info, aeron_frame_in
         rx->term_offset = term_offset;
         rx->length = length;
         wmem_list_append(nak_info->nak_analysis->rx, (void *) rx);
+        wmem_tree_insert32_array(nak_info->nak_analysis->rx_index, rx_key, (void *) rx);
         nak_info->nak_analysis->unrecovered_length -= length;
         wmem_list_append(rx_info->rx, (void *) nak_info);
     }
 }
 
+/*----------------------------------------------------------------------------*/
+/* NAK interval tree.                                                         */
+/*----------------------------------------------------------------------------*/
+static guint32 aeron_nak_height(const aeron_nak_t * nak)
+{
+    return ((nak != NULL) ? nak->height : 0);
+}
+
+static void aeron_nak_update(aeron_nak_t * nak)
+{
+    nak->height = MAX(aeron_nak_height(nak->left), aeron_nak_height(nak->right)) + 1;
+    nak->max_end = nak->term_offset + nak->length;
+    if ((nak->left != NULL) && (nak->left->max_end > nak->max_end))
+    {
+        nak->max_end = nak->left->max_end;
+    }
+    if ((nak->right != NULL) && (nak->right->max_end > nak->max_end))
+    {
+        nak->max_end = nak->right->max_end;
+    }
+}
+
+static aeron_nak_t * aeron_nak_rotate_right(aeron_nak_t * nak)
+{
+    aeron_nak_t * top = nak->left;
+
+    nak->left = top->right;
+    top->right = nak;
+    aeron_nak_update(nak);
+    aeron_nak_update(top);
+    return (top);
+}
+
+static aeron_nak_t * aeron_nak_rotate_left(aeron_nak_t * nak)
+{
+    aeron_nak_t * top = nak->right;
+
+    nak->right = top->left;
+    top->left = nak;
+    aeron_nak_update(nak);
+    aeron_nak_update(top);
+    return (top);
+}
+
+static aeron_nak_t * aeron_nak_insert(aeron_nak_t * root, aeron_nak_t * nak)
+{
+    guint32 left_height;
+    guint32 right_height;
+
+    if (root == NULL)
+    {
+        aeron_nak_update(nak);
+        return (nak);
+    }
+    if (nak->term_offset <= root->term_offset)
+    {
+        root->left = aeron_nak_insert(root->left, nak);
+    }
+    else
+    {
+        root->right = aeron_nak_insert(root->right, nak);
+    }
+    aeron_nak_update(root);
+    left_height = aeron_nak_height(root->left);
+    right_height = aeron_nak_height(root->right);
+    if (left_height > right_height + 1)
+    {
+        if (aeron_nak_height(root->left->right) > aeron_nak_height(root->left->left))
+        {
+            root->left = aeron_nak_rotate_left(root->left);
+        }
+        return (aeron_nak_rotate_right(root));
+    }
+    if (right_height > left_height + 1)
+    {
+        if (aeron_nak_height(root->right->left) > aeron_nak_height(root->right->right))
+        {
+            root->right = aeron_nak_rotate_right(root->right);
+        }
+        return (aeron_nak_rotate_left(root));
+    }
+    return (root);
+}
+
+/*
+    Match a retransmitted data frame to every NAK which covers it: a NAK starting at or before
+    rx_offset and ending at or after rx_end. Subtrees whose highest end is below rx_end cannot hold
+    such a NAK and are skipped, as are NAKs starting after rx_offset, so however long the NAKs are,
+    only the branches leading to a NAK that ends late enough are walked. NAKs are visited from the
+    highest term offset down.
+*/
+static void aeron_nak_match_rx(aeron_nak_t * nak, aeron_packet_info_t * info, aeron_frame_info_t * finfo, guint32 rx_end)
+{
+    while ((nak != NULL) && (nak->max_end >= rx_end))
+    {
+        if (nak->term_offset <= info->term_offset)
+        {
+            aeron_nak_match_rx(nak->right, info, finfo, rx_end);
+            if (((nak->term_offset + nak->length) >= rx_end) && (nak->frame_info->frame <= finfo->frame))
+            {
+                /* This data frame falls entirely within the NAK range */
+                aeron_frame_nak_rx_add(nak->frame_info, finfo, info->term_offset, info->length);
+            }
+        }
+        nak = nak->left;
+    }
+}
+
 static void aeron_frame_process_rx(aeron_packet_info_t * info, aeron_frame_info_t * finfo, aeron_term_t * term)
 {
-    wmem_list_frame_t * lf = NULL;
+    if (info->length > G_MAXUINT32 - info->term_offset)
+    {
+        /* Malformed; no NAK can cover it */
+        return;
+    }
+    aeron_nak_match_rx(term->nak, info, finfo, info->term_offset + info->length);
+}
 
-    lf = wmem_list_head(term->nak);
-    while (lf != NULL)
+static void aeron_frame_nak_analysis_setup(aeron_packet_info_t * info, aeron_frame_info_t * finfo, aeron_term_t * term)
+{
+    aeron_nak_t * nak = wmem_new0(term->scope, aeron_nak_t);
+    guint32 term_length = term->stream->term_length;
+
+    if (term_length == 0)
+    {
+        /* No SETUP seen yet, so only keep the NAK end within 32 bits */
+        term_length = G_MAXUINT32;
+    }
+    nak->term = term;
+    nak->frame_info = finfo;
+    nak->term_offset = info->nak_term_offset;
+    if (nak->term_offset >= term_length)
+    {
+        nak->length = 0;
+    }
+    else
+    {
+        nak->length = MIN(info->nak_length, term_length - nak->term_offset);
+    }
+    term->nak = aeron_nak_insert(term->nak, nak);
+    term->nak_count++;
+
+    finfo->nak_analysis = wmem_new0(wmem_file_scope(), aeron_nak_analysis_t);
+    finfo->nak_analysis->frame_info = finfo;
+    finfo->nak_analysis->rx = wmem_list_new(wmem_file_scope());
+    finfo->nak_analysis->rx_index = wmem_tree_new(wmem_file_scope());
+    finfo->nak_analysis->nak_term_offset = info->nak_term_offset;
+    finfo->nak_analysis->nak_length = info->nak_length;
+    finfo->nak_analysis->unrecovered_length = info->nak_length;
+}
+
+/*
+    The send timeline is a ring of the data which advanced the high position. Receivers retire entries as their
+    SMs cover them, and entries which every receiver has retired are dropped from the ring. No entry is kept for
+    more than AERON_STREAM_SEND_MAX_TERMS terms behind the high position, as a publisher cannot get further ahead
+    of a receiver than its term buffers; this also bounds the ring when a receiver stops sending SMs. A receiver
+    whose entries were dropped resumes from the oldest remaining entry.
+*/
+#define AERON_STREAM_SEND_INITIAL_SIZE 64
+#define AERON_STREAM_SEND_MAX_TERMS 3
+
+static aeron_stream_send_t * aeron_stream_send_get(aeron_stream_t * stream, guint64 index)
+{
+    return (&(stream->send[(stream->send_head + (guint32) (index - stream->send_base)) & (stream->send_size - 1)]));
+}
+
+static void aeron_stream_send_resize(aeron_stream_t * stream, guint32 size)
+{
+    aeron_stream_send_t * send = wmem_alloc_array(wmem_file_scope(), aeron_stream_send_t, size);
+    guint32 idx;
+
+    for (idx = 0; idx < stream->send_count; idx++)
+    {
+        send[idx] = stream->send[(stream->send_head + idx) & (stream->send_size - 1)];
+    }
+    wmem_free(wmem_file_scope(), (void *) stream->send);
+    stream->send = send;
+    stream->send_size = size;
+    stream->send_head = 0;
+}
+
+static void aeron_stream_send_append(aeron_stream_t * stream, const aeron_stream_send_t * send)
+{
+    if (stream->send_count == stream->send_size)
+    {
+        aeron_stream_send_resize(stream, ((stream->send_size == 0) ? AERON_STREAM_SEND_INITIAL_SIZE : (stream->send_size * 2)));
+    }
+    stream->send[(stream->send_head + stream->send_count) & (stream->send_size - 1)] = *send;
+    stream->send_count++;
+}
+
+static void aeron_stream_send_trim(aeron_stream_t * stream)
+{
+    while (stream->send_count > 0)
+    {
+        if ((stream->high.term_id - stream->send[stream->send_head].end.term_id) <= AERON_STREAM_SEND_MAX_TERMS)
+        {
+            /* The slowest receiver has retired the fewest entries. */
+            if ((stream->rcv_count == 0) || (stream->send_base >= stream->rcv_heap[0]->send_index))
+            {
+                break;
+            }
+        }
+        stream->send_head = (stream->send_head + 1) & (stream->send_size - 1);
+        stream->send_count--;
+        stream->send_base++;
+    }
+    if ((stream->send_size > AERON_STREAM_SEND_INITIAL_SIZE) && (stream->send_count <= (stream->send_size / 4)))
+    {
+        aeron_stream_send_resize(stream, stream->send_size / 2);
+    }
+}
+
+static void aeron_stream_rcv_lag_update(aeron_stream_t * stream, aeron_stream_rcv_t * rcv, aeron_stream_analysis_t * analysis, const nstime_t * sm_time, gboolean first_sm)
+{
+    guint64 end = stream->send_base + stream->send_count;
+
+    /*
+        Retire every send timeline entry now completed by this receiver. The oldest of them determines the lag.
+        On a receiver's first SM the entries are retired without computing a lag, since the receiver may have
+        joined part way through the stream.
+    */
+    if (rcv->send_index < stream->send_base)
+    {
+        rcv->send_index = stream->send_base;
+    }
+    while (rcv->send_index < end)
+    {
+        aeron_stream_send_t * send = aeron_stream_send_get(stream, rcv->send_index);
+
+        if (aeron_pos_compare(&(send->end), &(rcv->completed)) > 0)
+        {
+            break;
+        }
+        if (!first_sm && ((analysis->flags2 & AERON_STREAM_ANALYSIS_FLAGS2_LAG_VALID) == 0))
+        {
+            nstime_delta(&(analysis->receiver_lag), sm_time, &(send->send_time));
+            analysis->receiver_lag_frame = send->frame;
+            analysis->flags2 |= AERON_STREAM_ANALYSIS_FLAGS2_LAG_VALID;
+        }
+        rcv->send_index++;
+    }
+    aeron_stream_send_trim(stream);
+}
+
+/*
+    A receiver which has sent no SM for aeron_receiver_timeout seconds has left the stream, so it is removed; otherwise
+    its last completed position would be reported as the slowest receiver forever. The slowest receiver is checked on
+    every frame of the stream, and all the receivers once per timeout.
+*/
+static gboolean aeron_stream_rcv_idle(const aeron_stream_rcv_t * rcv, const nstime_t * now)
+{
+    nstime_t idle;
+
+    nstime_delta(&idle, now, &(rcv->last_sm_time));
+    return (nstime_to_sec(&idle) > (double) aeron_receiver_timeout);
+}
+
+static void aeron_stream_rcv_expire(aeron_stream_t * stream, const nstime_t * now)
+{
+    nstime_t since_sweep;
+
+    if ((aeron_receiver_timeout == 0) || (stream->rcv_count == 0))
     {
-        aeron_nak_t * nak = (aeron_nak_t *) wmem_list_frame_data(lf);
-        if (nak != NULL)
+        return;
+    }
+    while ((stream->rcv_count > 0) && aeron_stream_rcv_idle(stream->rcv_heap[0], now))
+    {
+        aeron_stream_rcv_remove(stream, stream->rcv_heap[0]);
+    }
+    nstime_delta(&since_sweep, now, &(stream->rcv_sweep_time));
+    if (nstime_to_sec(&since_sweep) >= (double) aeron_receiver_timeout)
+    {
+        aeron_stream_rcv_t ** idle = wmem_alloc_array(wmem_packet_scope(), aeron_stream_rcv_t *, MAX(stream->rcv_count, 1));
+        guint32 idle_count = 0;
+        guint32 idx;
+
+        /* Removing a receiver reorders the heap, so collect the idle receivers first. */
+        for (idx = 0; idx < stream->rcv_count; idx++)
         {
-            if (nak->frame_info->frame <= finfo->frame)
+            if (aeron_stream_rcv_idle(stream->rcv_heap[idx], now))
             {
-                if ((nak->term_offset <= info->term_offset) && (nak->length >= info->length))
-                {
-                    /* This data frame falls entirely within the NAK range */
-                    aeron_frame_nak_rx_add(nak->frame_info, finfo, info->term_offset, info->length);
-                }
+                idle[idle_count++] = stream->rcv_heap[idx];
             }
         }
-        lf = wmem_list_frame_next(lf);
+        for (idx = 0; idx < idle_count; idx++)
+        {
+            aeron_stream_rcv_remove(stream, idle[idx]);
+        }
+        stream->rcv_sweep_time = *now;
     }
-}
-
-static void aeron_frame_nak_analysis_setup(aeron_packet_info_t * info, aeron_frame_info_t * finfo, aeron_term_t * term)
-{
-    aeron_nak_t * nak = wmem_new0(wmem_file_scope(), aeron_nak_t);
-    nak->term = term;
-    nak->frame_info = finfo;
-    nak->term_offset = info->nak_term_offset;
-    nak->length = info->nak_length;
-    wmem_list_append(term->nak, (void *) nak);
-
-    finfo->nak_analysis = wmem_new0(wmem_file_scope(), aeron_nak_analysis_t);
-    finfo->nak_analysis->frame_info = finfo;
-    finfo->nak_analysis->rx = wmem_list_new(wmem_file_scope());
-    finfo->nak_analysis->nak_term_offset = info->nak_term_offset;
-    finfo->nak_analysis->nak_length = info->nak_length;
-    finfo->nak_analysis->unrecovered_length = info->nak_length;
+    aeron_stream_send_trim(stream);
 }
 
 static void aeron_frame_stream_analysis_setup(packet_info * pinfo, aeron_packet_info_t * info, aeron_frame_info_t * finfo, aeron_stream_t * stream, aeron_term_t * term, gboolean new_term)
@@ -1224,7 +2028,10 @@ static void aeron_frame_stream_analysis_setup(packet_info * pinfo, aeron_packet_
             prp = rcv->completed;
             cur_receiver_window = rcv->receiver_window;
         }
+        rcv->last_sm_time = pinfo->fd->abs_ts;
     }
+    /* After the SM's own receiver has been refreshed, so that it is never expired by its own SM. */
+    aeron_stream_rcv_expire(stream, &(pinfo->fd->abs_ts));
     switch (info->type)
     {
         case HDR_TYPE_DATA:
@@ -1272,6 +2079,7 @@ static void aeron_frame_stream_analysis_setup(packet_info * pinfo, aeron_packet_
                 rcv->completed.term_offset = rp.term_offset;
             }
             rcv->receiver_window = info->receiver_window;
+            aeron_stream_rcv_heap_update(stream, rcv);
             break;
         default:
             break;
@@ -1292,9 +2100,20 @@ static void aeron_frame_stream_analysis_setup(packet_info * pinfo, aeron_packet_
             case HDR_TYPE_PAD:
                 finfo->stream_analysis->high.term_id = stream->high.term_id;
                 finfo->stream_analysis->high.term_offset = stream->high.term_offset;
+                if (stream->rcv_count > 0)
+                {
+                    aeron_stream_rcv_t * slowest = aeron_stream_rcv_slowest(stream);
+
+                    finfo->stream_analysis->flags2 |= AERON_STREAM_ANALYSIS_FLAGS2_SLOWEST_VALID;
+                    finfo->stream_analysis->slowest = slowest;
+                    finfo->stream_analysis->rcv_count = stream->rcv_count;
+                    finfo->stream_analysis->min_completed = slowest->completed;
+                    finfo->stream_analysis->min_outstanding_bytes = aeron_pos_delta(&(finfo->stream_analysis->high), &(slowest->completed), stream->term_length);
+                }
                 if (rcv != NULL)
                 {
                     finfo->stream_analysis->flags2 |= AERON_STREAM_ANALYSIS_FLAGS2_RCV_VALID;
+                    finfo->stream_analysis->rcv = rcv;
                     finfo->stream_analysis->completed.term_id = rcv->completed.term_id;
                     finfo->stream_analysis->completed.term_offset = rcv->completed.term_offset;
                     finfo->stream_analysis->receiver_window = rcv->receiver_window;
@@ -1371,6 +2190,8 @@ static void aeron_frame_stream_analysis_setup(packet_info * pinfo, aeron_packet_
                         else if (erc < 0)
                         {
                             finfo->stream_analysis->flags |= AERON_STREAM_ANALYSIS_FLAGS_OOO_GAP;
+                            finfo->stream_analysis->gap_start = pdp;
+                            finfo->stream_analysis->gap_length = aeron_pos_delta(&dp, &expected_dp, stream->term_length);
                         }
                     }
                 }
@@ -1378,6 +2199,17 @@ static void aeron_frame_stream_analysis_setup(packet_info * pinfo, aeron_packet_
                 {
                     finfo->stream_analysis->flags |= AERON_STREAM_ANALYSIS_FLAGS_TERM_ID_CHANGE;
                 }
+                if ((info->length > 0) && (!pdpv || (aeron_pos_compare(&dp, &pdp) > 0)))
+                {
+                    /* New data advanced the high position, so add it to the send timeline. */
+                    aeron_stream_send_t send;
+
+                    send.end = dp;
+                    send.send_time = pinfo->fd->abs_ts;
+                    send.frame = finfo->frame;
+                    aeron_stream_send_append(stream, &send);
+                    aeron_stream_send_trim(stream);
+                }
                 break;
             case HDR_TYPE_SM:
                 if (prpv)
@@ -1397,6 +2229,7 @@ static void aeron_frame_stream_analysis_setup(packet_info * pinfo, aeron_packet_
                         finfo->stream_analysis->flags |= AERON_STREAM_ANALYSIS_FLAGS_WINDOW_RESIZE;
                     }
                 }
+                aeron_stream_rcv_lag_update(stream, rcv, finfo->stream_analysis, &(pinfo->fd->abs_ts), !prpv);
                 break;
             default:
                 break;
@@ -1411,6 +2244,7 @@ static void aeron_frame_stream_analysis_setup(packet_info * pinfo, aeron_packet_
         {
             fragment = aeron_term_fragment_add(term, info->term_offset, info->length, info->data_length);
         }
+        finfo->resolved.fragment = fragment;
         aeron_fragment_frame_add(fragment, finfo, frame_flags, info->length);
     }
     else
@@ -1436,6 +2270,7 @@ static void aeron_frame_info_setup(packet_info * pinfo, aeron_transport_t * tran
                     {
                         stream = aeron_transport_stream_add(transport, info->stream_id);
                     }
+                    finfo->resolved.stream = stream;
                     if ((info->info_flags & AERON_PACKET_INFO_FLAGS_TERM_ID_VALID) != 0)
                     {
                         aeron_term_t * term = NULL;
@@ -1446,7 +2281,12 @@ static void aeron_frame_info_setup(packet_info * pinfo, aeron_transport_t * tran
                         {
                             term = aeron_stream_term_add(stream, info->term_id);
                             new_term = TRUE;
+                            if (aeron_streaming_term_window > 0)
+                            {
+                                aeron_stream_term_evict(stream, info->term_id, finfo);
+                            }
                         }
+                        finfo->resolved.term = term;
                         if ((info->info_flags & AERON_PACKET_INFO_FLAGS_TERM_OFFSET_VALID) != 0)
                         {
                             aeron_frame_stream_analysis_setup(pinfo, info, finfo, stream, term, new_term);
@@ -1474,6 +2314,155 @@ static void aeron_frame_info_setup(packet_info * pinfo, aeron_transport_t * tran
     }
 }
 
+/*----------------------------------------------------------------------------*/
+/* Tap support.                                                               */
+/*----------------------------------------------------------------------------*/
+static void aeron_tap_queue(packet_info * pinfo, aeron_transport_t * transport, aeron_packet_info_t * info, aeron_frame_info_t * finfo)
+{
+    aeron_tap_info_t * tapinfo = NULL;
+
+    if (!have_tap_listener(aeron_tap_handle))
+    {
+        return;
+    }
+    tapinfo = wmem_new0(wmem_packet_scope(), aeron_tap_info_t);
+    tapinfo->addr1 = &(transport->addr1);
+    tapinfo->addr2 = &(transport->addr2);
+    tapinfo->port1 = transport->port1;
+    tapinfo->port2 = transport->port2;
+    tapinfo->channel_id = transport->channel_id;
+    tapinfo->session_id = transport->session_id;
+    tapinfo->stream_id = info->stream_id;
+    tapinfo->term_id = info->term_id;
+    tapinfo->type = info->type;
+    tapinfo->flags = info->flags;
+    if (info->type == HDR_TYPE_NAK)
+    {
+        tapinfo->term_offset = info->nak_term_offset;
+        tapinfo->length = info->nak_length;
+    }
+    else
+    {
+        tapinfo->term_offset = info->term_offset;
+        tapinfo->length = info->length;
+    }
+    tapinfo->receiver_window = info->receiver_window;
+    if ((finfo != NULL) && (finfo->evicted != NULL))
+    {
+        tapinfo->evicted_terms = finfo->evicted->terms;
+        tapinfo->evicted_fragments = finfo->evicted->fragments;
+        tapinfo->evicted_messages = finfo->evicted->messages;
+        tapinfo->evicted_naks = finfo->evicted->naks;
+    }
+    if (finfo != NULL)
+    {
+        tapinfo->frame_flags = finfo->flags;
+        if (finfo->stream_analysis != NULL)
+        {
+            tapinfo->stream_analysis_flags = finfo->stream_analysis->flags;
+            if ((finfo->stream_analysis->flags2 & AERON_STREAM_ANALYSIS_FLAGS2_LAG_VALID) != 0)
+            {
+                tapinfo->receiver_lag_valid = TRUE;
+                tapinfo->receiver_lag = finfo->stream_analysis->receiver_lag;
+            }
+            if ((finfo->stream_analysis->flags & AERON_STREAM_ANALYSIS_FLAGS_OOO_GAP) != 0)
+            {
+                tapinfo->gap_term_id = finfo->stream_analysis->gap_start.term_id;
+                tapinfo->gap_term_offset = finfo->stream_analysis->gap_start.term_offset;
+                tapinfo->gap_length = finfo->stream_analysis->gap_length;
+            }
+            if ((finfo->stream_analysis->flags2 & AERON_STREAM_ANALYSIS_FLAGS2_RCV_VALID) != 0)
+            {
+                tapinfo->receiver = finfo->stream_analysis->rcv->name;
+                tapinfo->outstanding_bytes = finfo->stream_analysis->outstanding_bytes;
+            }
+            if ((finfo->stream_analysis->flags2 & AERON_STREAM_ANALYSIS_FLAGS2_SLOWEST_VALID) != 0)
+            {
+                tapinfo->slowest_receiver = finfo->stream_analysis->slowest->name;
+                tapinfo->receiver_count = finfo->stream_analysis->rcv_count;
+                tapinfo->min_completed_term_id = finfo->stream_analysis->min_completed.term_id;
+                tapinfo->min_completed_term_offset = finfo->stream_analysis->min_completed.term_offset;
+                tapinfo->min_outstanding_bytes = finfo->stream_analysis->min_outstanding_bytes;
+            }
+        }
+        if (finfo->nak_analysis != NULL)
+        {
+            tapinfo->nak_unrecovered = finfo->nak_analysis->unrecovered_length;
+        }
+        if (finfo->rx != NULL)
+        {
+            tapinfo->rx_nak_count = wmem_list_count(finfo->rx);
+        }
+        if (tapinfo->rx_nak_count > 0)
+        {
+            guint32 * nak_frame = wmem_alloc_array(wmem_packet_scope(), guint32, tapinfo->rx_nak_count);
+            guint32 * nak_unrecovered = wmem_alloc_array(wmem_packet_scope(), guint32, tapinfo->rx_nak_count);
+            wmem_list_frame_t * lf = wmem_list_head(finfo->rx);
+            guint32 idx = 0;
+
+            while ((lf != NULL) && (idx < tapinfo->rx_nak_count))
+            {
+                aeron_frame_info_t * nak = (aeron_frame_info_t *) wmem_list_frame_data(lf);
+                if (nak != NULL)
+                {
+                    nak_frame[idx] = nak->frame;
+                    nak_unrecovered[idx] = nak->nak_analysis->unrecovered_length;
+                    idx++;
+                }
+                lf = wmem_list_frame_next(lf);
+            }
+            tapinfo->rx_nak_count = idx;
+            tapinfo->rx_nak_frame = nak_frame;
+            tapinfo->rx_nak_unrecovered = nak_unrecovered;
+        }
+    }
+    tap_queue_packet(aeron_tap_handle, pinfo, (void *) tapinfo);
+}
+
+static void aeron_follow_queue(packet_info * pinfo, aeron_transport_t * transport, aeron_frame_info_t * finfo, guint16 type, guint32 stream_id, guint32 term_id, guint32 term_offset, guint32 frame_length, guint32 term_length, tvbuff_t * tvb, int data_offset)
+{
+    aeron_follow_info_t * followinfo = NULL;
+
+    if (!have_tap_listener(aeron_follow_tap_handle))
+    {
+        return;
+    }
+    followinfo = wmem_new0(wmem_packet_scope(), aeron_follow_info_t);
+    followinfo->channel_id = transport->channel_id;
+    followinfo->session_id = transport->session_id;
+    followinfo->stream_id = stream_id;
+    followinfo->term_id = term_id;
+    followinfo->term_offset = term_offset;
+    followinfo->frame_length = frame_length;
+    followinfo->term_length = term_length;
+    if (tvb != NULL)
+    {
+        followinfo->data = tvb_new_subset_length(tvb, data_offset, (gint) (frame_length - L_AERON_DATA));
+    }
+    followinfo->type = type;
+    if (aeron_sequence_analysis && ((type == HDR_TYPE_DATA) || (type == HDR_TYPE_PAD)))
+    {
+        /* Use the fragment index to spot data already carried by an earlier frame */
+        aeron_stream_t * stream = aeron_resolved_stream(finfo, transport, stream_id);
+        aeron_term_t * term = NULL;
+        aeron_fragment_t * fragment = NULL;
+
+        if (stream != NULL)
+        {
+            term = aeron_resolved_term(finfo, stream, term_id);
+        }
+        if (term != NULL)
+        {
+            fragment = aeron_resolved_fragment(finfo, term, term_offset);
+        }
+        if ((fragment != NULL) && (fragment->first_data_frame != NULL) && (fragment->first_data_frame->frame != pinfo->fd->num))
+        {
+            followinfo->duplicate = TRUE;
+        }
+    }
+    tap_queue_packet(aeron_follow_tap_handle, pinfo, (void *) followinfo);
+}
+
 static void aeron_sequence_report_frame(tvbuff_t * tvb, proto_tree * tree, aeron_frame_info_t * finfo)
 {
     proto_item * item = NULL;
@@ -1519,7 +2508,7 @@ static void aeron_sequence_report(tvbuff_t * tvb, packet_info * pinfo, proto_tre
             {
                 aeron_stream_t * stream = NULL;
 
-                stream = aeron_transport_stream_find(transport, info->stream_id);
+                stream = aeron_resolved_stream(finfo, transport, info->stream_id);
                 if (stream != NULL)
                 {
                     if (finfo->stream.previous != 0)
@@ -1536,7 +2525,7 @@ static void aeron_sequence_report(tvbuff_t * tvb, packet_info * pinfo, proto_tre
                     {
                         aeron_term_t * term = NULL;
 
-                        term = aeron_stream_term_find(stream, info->term_id);
+                        term = aeron_resolved_term(finfo, stream, info->term_id);
                         if (term != NULL)
                         {
                             if (finfo->term.previous != 0)
@@ -1555,7 +2544,7 @@ static void aeron_sequence_report(tvbuff_t * tvb, packet_info * pinfo, proto_tre
                                 {
                                     aeron_fragment_t * fragment = NULL;
 
-                                    fragment = aeron_term_fragment_find(term, info->term_offset);
+                                    fragment = aeron_resolved_fragment(finfo, term, info->term_offset);
                                     if (fragment != NULL)
                                     {
                                         proto_item * fei_item = NULL;
@@ -1718,16 +2707,36 @@ static void aeron_stream_report(tvbuff_t * tvb, packet_info * pinfo, proto_tree
                     expert_add_info(pinfo, item, &ei_aeron_analysis_window_full);
                 }
             }
+            if ((finfo->stream_analysis->flags2 & AERON_STREAM_ANALYSIS_FLAGS2_LAG_VALID) != 0)
+            {
+                item = proto_tree_add_time(subtree, hf_aeron_stream_analysis_receiver_lag, tvb, 0, 0, &(finfo->stream_analysis->receiver_lag));
+                PROTO_ITEM_SET_GENERATED(item);
+                item = proto_tree_add_uint(subtree, hf_aeron_stream_analysis_receiver_lag_frame, tvb, 0, 0, finfo->stream_analysis->receiver_lag_frame);
+                PROTO_ITEM_SET_GENERATED(item);
+            }
+            if ((finfo->stream_analysis->flags2 & AERON_STREAM_ANALYSIS_FLAGS2_SLOWEST_VALID) != 0)
+            {
+                item = proto_tree_add_uint(subtree, hf_aeron_stream_analysis_receiver_count, tvb, 0, 0, finfo->stream_analysis->rcv_count);
+                PROTO_ITEM_SET_GENERATED(item);
+                item = proto_tree_add_string(subtree, hf_aeron_stream_analysis_slowest_receiver, tvb, 0, 0, finfo->stream_analysis->slowest->name);
+                PROTO_ITEM_SET_GENERATED(item);
+                item = proto_tree_add_uint(subtree, hf_aeron_stream_analysis_min_completed_term_id, tvb, 0, 0, finfo->stream_analysis->min_completed.term_id);
+                PROTO_ITEM_SET_GENERATED(item);
+                item = proto_tree_add_uint(subtree, hf_aeron_stream_analysis_min_completed_term_offset, tvb, 0, 0, finfo->stream_analysis->min_completed.term_offset);
+                PROTO_ITEM_SET_GENERATED(item);
+                item = proto_tree_add_uint(subtree, hf_aeron_stream_analysis_min_outstanding_bytes, tvb, 0, 0, finfo->stream_analysis->min_outstanding_bytes);
+                PROTO_ITEM_SET_GENERATED(item);
+            }
         }
     }
 }
 
-static void aeron_next_offset_report(tvbuff_t * tvb, proto_tree * tree, aeron_transport_t * transport, guint32 stream_id, guint32 term_id, guint32 term_offset, guint32 length)
+static void aeron_next_offset_report(tvbuff_t * tvb, proto_tree * tree, aeron_transport_t * transport, aeron_frame_info_t * finfo, guint32 stream_id, guint32 term_id, guint32 term_offset, guint32 length)
 {
     aeron_stream_t * stream = NULL;
     proto_item * item = NULL;
 
-    stream = aeron_transport_stream_find(transport, stream_id);
+    stream = aeron_resolved_stream(finfo, transport, stream_id);
     if (stream != NULL)
     {
         aeron_term_t * term = NULL;
@@ -1735,10 +2744,10 @@ static void aeron_next_offset_report(tvbuff_t * tvb, proto_tree * tree, aeron_tr
         {
             stream->term_length = length;
         }
-        term = aeron_stream_term_find(stream, term_id);
+        term = aeron_resolved_term(finfo, stream, term_id);
         if (term != NULL)
         {
-            aeron_fragment_t * fragment = aeron_term_fragment_find(term, term_offset);
+            aeron_fragment_t * fragment = aeron_resolved_fragment(finfo, term, term_offset);
             if (fragment != NULL)
             {
                 guint32 next_offset = term_offset + length;
@@ -1873,6 +2882,11 @@ struct aeron_msg_fragment_t_stct
 
 static void aeron_msg_fragment_add(aeron_msg_t * msg, aeron_msg_fragment_t * fragment)
 {
+    /* The message will no longer be waiting at its current next expected term offset */
+    if (wmem_tree_lookup32(msg->term->message_pending, msg->next_expected_term_offset) == (void *) msg)
+    {
+        wmem_tree_insert32(msg->term->message_pending, msg->next_expected_term_offset, NULL);
+    }
     /* Add the fragment to the message */
     wmem_list_append(msg->fragment, (void *) fragment);
     /* Update the message */
@@ -1888,7 +2902,11 @@ static void aeron_msg_fragment_add(aeron_msg_t * msg, aeron_msg_fragment_t * fra
         msg->last_frame = fragment->frame;
     }
     msg->next_expected_term_offset += fragment->frame_length;
-    if ((fragment->flags & DATA_FLAGS_END) == DATA_FLAGS_END)
+    if ((fragment->flags & DATA_FLAGS_END) != DATA_FLAGS_END)
+    {
+        wmem_tree_insert32(msg->term->message_pending, msg->next_expected_term_offset, (void *) msg);
+    }
+    else
     {
         gchar * buf = NULL;
         wmem_list_frame_t * lf = NULL;
@@ -1900,7 +2918,7 @@ static void aeron_msg_fragment_add(aeron_msg_t * msg, aeron_msg_fragment_t * fra
 
         msg->complete = TRUE;
         msg->end_frame = fragment->frame;
-        buf = (gchar *) wmem_alloc(wmem_file_scope(), (size_t) msg->length);
+        buf = (gchar *) wmem_alloc(msg->term->scope, (size_t) msg->length);
         lf = wmem_list_head(msg->fragment);
         while (lf != NULL)
         {
@@ -1913,6 +2931,9 @@ static void aeron_msg_fragment_add(aeron_msg_t * msg, aeron_msg_fragment_t * fra
                     last_frame_found = TRUE;
                 }
                 memcpy((void *) (buf + ofs), (void *) cur_frag->data, (size_t) cur_frag->data_length);
+                /* The fragment data now lives in the message buffer, so release the fragment copy. */
+                wmem_free(msg->term->scope, (void *) cur_frag->data);
+                cur_frag->data = NULL;
                 ofs += (size_t) cur_frag->data_length;
                 accum_len += (size_t) cur_frag->data_length;
             }
@@ -1925,78 +2946,53 @@ static void aeron_msg_fragment_add(aeron_msg_t * msg, aeron_msg_fragment_t * fra
             finfo = aeron_frame_info_find(msg->last_frame, last_frame_offset);
         }
         msg->reassembled_data = tvb_new_real_data(buf, msg->length, msg->length);
+        if (msg->term->reassembled_tvb != NULL)
+        {
+            wmem_list_append(msg->term->reassembled_tvb, (void *) msg->reassembled_data);
+        }
         DISSECTOR_ASSERT(finfo != NULL);
         if (finfo != NULL)
         {
             finfo->flags |= AERON_FRAME_INFO_FLAGS_REASSEMBLED_MSG;
             finfo->message = msg;
+            if (msg->term->reassembled_frame != NULL)
+            {
+                wmem_list_append(msg->term->reassembled_frame, (void *) finfo);
+            }
         }
     }
 }
 
-static gboolean aeron_msg_process_orphan_fragments_msg_cb(void * value, void * userdata)
+static void aeron_msg_process_orphan_fragments(aeron_msg_t * msg)
 {
-    aeron_msg_t * msg = (aeron_msg_t *) value;
-    aeron_term_t * term = (aeron_term_t *) userdata;
-    gboolean frag_found = FALSE;
-    wmem_list_frame_t * lf = NULL;
-    aeron_msg_fragment_t * frag = NULL;
+    aeron_term_t * term = msg->term;
 
-    if (msg->complete)
-    {
-        /* This message is complete, no need to check for orphans */
-        return (FALSE);
-    }
-    /* Scan through the orphan fragments */
-    while (TRUE)
+    /* Pull in orphan fragments for as long as one sits at the message's next expected term offset */
+    while (!msg->complete && (term->orphan_fragment_count > 0))
     {
-        lf = wmem_list_head(term->orphan_fragment);
-        while (lf != NULL)
-        {
-            frag = (aeron_msg_fragment_t *) wmem_list_frame_data(lf);
-            if (frag != NULL)
-            {
-                if (msg->next_expected_term_offset == frag->term_offset)
-                {
-                    /* Found one! Remove it from the orphan list, and add it to the message */
-                    wmem_list_remove_frame(term->orphan_fragment, lf);
-                    aeron_msg_fragment_add(msg, frag);
-                    frag_found = TRUE;
-                    break;
-                }
-            }
-            lf = wmem_list_frame_next(lf);
-        }
-        if (!frag_found)
+        aeron_msg_fragment_t * frag = (aeron_msg_fragment_t *) wmem_tree_lookup32(term->orphan_fragment, msg->next_expected_term_offset);
+        if (frag == NULL)
         {
             break;
         }
-        frag_found = FALSE;
-    }
-    return (FALSE);
-}
-
-static void aeron_msg_process_orphan_fragments(aeron_term_t * term)
-{
-    /* If we have no orphan fragments to process, nothing to do. */
-    if (wmem_list_count(term->orphan_fragment) == 0)
-    {
-        return;
+        /* Found one! Remove it from the orphans, and add it to the message */
+        wmem_tree_insert32(term->orphan_fragment, frag->term_offset, NULL);
+        term->orphan_fragment_count--;
+        aeron_msg_fragment_add(msg, frag);
     }
-    wmem_tree_foreach(term->message, aeron_msg_process_orphan_fragments_msg_cb, (void *) term);
 }
 
-static aeron_msg_fragment_t * aeron_msg_fragment_create(tvbuff_t * tvb, int offset, packet_info * pinfo, aeron_packet_info_t * info)
+static aeron_msg_fragment_t * aeron_msg_fragment_create(aeron_term_t * term, tvbuff_t * tvb, int offset, packet_info * pinfo, aeron_packet_info_t * info)
 {
     aeron_msg_fragment_t * frag = NULL;
 
-    frag = wmem_new0(wmem_file_scope(), aeron_msg_fragment_t);
+    frag = wmem_new0(term->scope, aeron_msg_fragment_t);
     frag->term_offset = info->term_offset;
     frag->frame_length = info->length;
     frag->data_length = info->data_length;
     frag->frame = pinfo->fd->num;
     frag->frame_offset = offset;
-    frag->data = (gchar *) tvb_memdup(wmem_file_scope(), tvb, frag->frame_offset + O_AERON_DATA_DATA, (size_t) frag->data_length);
+    frag->data = (gchar *) tvb_memdup(term->scope, tvb, frag->frame_offset + O_AERON_DATA_DATA, (size_t) frag->data_length);
     frag->flags = info->flags;
     return (frag);
 }
@@ -2043,8 +3039,8 @@ static aeron_msg_t * aeron_term_msg_add(aeron_term_t * term, packet_info * pinfo
     {
         return (pos);
     }
-    msg = wmem_new0(wmem_file_scope(), aeron_msg_t);
-    msg->fragment = wmem_list_new(wmem_file_scope());
+    msg = wmem_new0(term->scope, aeron_msg_t);
+    msg->fragment = wmem_list_new(term->scope);
     msg->term = term;
     msg->reassembled_data = NULL;
     msg->first_fragment_term_offset = info->term_offset;
@@ -2059,19 +3055,21 @@ static aeron_msg_t * aeron_term_msg_add(aeron_term_t * term, packet_info * pinfo
     msg->last_frame = 0;
     msg->complete = FALSE;
     wmem_tree_insert32(term->message, msg->first_fragment_term_offset, (void *) msg);
+    term->message_count++;
+    wmem_tree_insert32(term->message_pending, msg->next_expected_term_offset, (void *) msg);
     return (msg);
 }
 
-static void aeron_msg_process(tvbuff_t * tvb, int offset, packet_info * pinfo, aeron_transport_t * transport, aeron_packet_info_t * info, aeron_frame_info_t * finfo _U_)
+static void aeron_msg_process(tvbuff_t * tvb, int offset, packet_info * pinfo, aeron_transport_t * transport, aeron_packet_info_t * info, aeron_frame_info_t * finfo)
 {
     if (aeron_reassemble_fragments && (PINFO_FD_VISITED(pinfo) == 0))
     {
         if ((info->flags & DATA_FLAGS_COMPLETE) != DATA_FLAGS_COMPLETE)
         {
-            aeron_stream_t * stream = aeron_transport_stream_find(transport, info->stream_id);
+            aeron_stream_t * stream = aeron_resolved_stream(finfo, transport, info->stream_id);
             if (stream != NULL)
             {
-                aeron_term_t * term = aeron_stream_term_find(stream, info->term_id);
+                aeron_term_t * term = aeron_resolved_term(finfo, stream, info->term_id);
                 if (term != NULL)
                 {
                     aeron_msg_t * msg = NULL;
@@ -2098,6 +3096,11 @@ static void aeron_msg_process(tvbuff_t * tvb, int offset, packet_info * pinfo, a
                         {
                             msg = aeron_term_msg_add(term, pinfo, info);
                         }
+                        else if (aeron_msg_fragment_find(msg, info) != NULL)
+                        {
+                            /* Already have the first fragment of this message */
+                            return;
+                        }
                     }
                     else
                     {
@@ -2126,21 +3129,31 @@ static void aeron_msg_process(tvbuff_t * tvb, int offset, packet_info * pinfo, a
                                 }
                             }
                         }
+                        if (msg == NULL)
+                        {
+                            /* Some other incomplete message may be waiting for exactly this fragment. */
+                            msg = (aeron_msg_t *) wmem_tree_lookup32(term->message_pending, info->term_offset);
+                        }
                     }
-                    /* Create the fragment */
-                    frag = aeron_msg_fragment_create(tvb, offset, pinfo, info);
                     if (msg == NULL)
                     {
-                        /* Add the fragment to the list of orphaned fragments */
-                        wmem_list_append(term->orphan_fragment, (void *) frag);
+                        if (wmem_tree_lookup32(term->orphan_fragment, info->term_offset) != NULL)
+                        {
+                            /* Already have this orphan fragment */
+                            return;
+                        }
+                        /* Add the fragment to the orphaned fragments */
+                        frag = aeron_msg_fragment_create(term, tvb, offset, pinfo, info);
+                        wmem_tree_insert32(term->orphan_fragment, frag->term_offset, (void *) frag);
+                        term->orphan_fragment_count++;
                     }
                     else
                     {
-                        /* Add the fragment to the message */
+                        /* Add the fragment to the message, then pull in any orphans which now follow it */
+                        frag = aeron_msg_fragment_create(term, tvb, offset, pinfo, info);
                         aeron_msg_fragment_add(msg, frag);
+                        aeron_msg_process_orphan_fragments(msg);
                     }
-                    /* Process the orphan list */
-                    aeron_msg_process_orphan_fragments(term);
                 }
             }
         }
@@ -2169,7 +3182,7 @@ static int dissect_aeron_pad(tvbuff_t * tvb, int offset, packet_info * pinfo, pr
     rounded_length = (int) aeron_pos_roundup(frame_length);
     term_offset = tvb_get_letohl(tvb, offset + O_AERON_PAD_TERM_OFFSET);
     session_id = tvb_get_letohl(tvb, offset + O_AERON_PAD_SESSION_ID);
-    transport = aeron_transport_add(cinfo, session_id, pinfo->fd->num);
+    transport = aeron_transport_get(cinfo, session_id, pinfo, finfo);
     stream_id = tvb_get_letohl(tvb, offset + O_AERON_PAD_STREAM_ID);
     term_id = tvb_get_letohl(tvb, offset + O_AERON_PAD_TERM_ID);
     pad_length = frame_length - L_AERON_PAD;
@@ -2183,6 +3196,8 @@ static int dissect_aeron_pad(tvbuff_t * tvb, int offset, packet_info * pinfo, pr
     pktinfo.type = HDR_TYPE_PAD;
     pktinfo.flags = tvb_get_guint8(tvb, offset + O_AERON_PAD_FLAGS);
     aeron_frame_info_setup(pinfo, transport, &pktinfo, finfo);
+    aeron_tap_queue(pinfo, transport, &pktinfo, finfo);
+    aeron_follow_queue(pinfo, transport, finfo, HDR_TYPE_PAD, stream_id, term_id, term_offset, frame_length, 0, NULL, 0);
 
     aeron_info_stream_progress_report(pinfo, HDR_TYPE_PAD, pktinfo.flags, term_id, term_offset, finfo);
     item = proto_tree_add_none_format(tree, hf_aeron_pad, tvb, offset, -1, "Pad Frame: Term 0x%x, Ofs %" G_GUINT32_FORMAT ", Len %" G_GUINT32_FORMAT "(%d)",
@@ -2195,7 +3210,7 @@ static int dissect_aeron_pad(tvbuff_t * tvb, int offset, packet_info * pinfo, pr
     proto_tree_add_item(subtree, hf_aeron_pad_type, tvb, offset + O_AERON_PAD_TYPE, 2, ENC_LITTLE_ENDIAN);
     proto_tree_add_item(subtree, hf_aeron_pad_frame_length, tvb, offset + O_AERON_PAD_FRAME_LENGTH, 4, ENC_LITTLE_ENDIAN);
     proto_tree_add_item(subtree, hf_aeron_pad_term_offset, tvb, offset + O_AERON_PAD_TERM_OFFSET, 4, ENC_LITTLE_ENDIAN);
-    aeron_next_offset_report(tvb, subtree, transport, stream_id, term_id, term_offset, (guint32) rounded_length);
+    aeron_next_offset_report(tvb, subtree, transport, finfo, stream_id, term_id, term_offset, (guint32) rounded_length);
     proto_tree_add_item(subtree, hf_aeron_pad_session_id, tvb, offset + O_AERON_PAD_SESSION_ID, 4, ENC_LITTLE_ENDIAN);
     proto_tree_add_item(subtree, hf_aeron_pad_stream_id, tvb, offset + O_AERON_PAD_STREAM_ID, 4, ENC_LITTLE_ENDIAN);
     proto_tree_add_item(subtree, hf_aeron_pad_term_id, tvb, offset + O_AERON_PAD_TERM_ID, 4, ENC_LITTLE_ENDIAN);
@@ -2205,6 +3220,97 @@ static int dissect_aeron_pad(tvbuff_t * tvb, int offset, packet_info * pinfo, pr
     return (L_AERON_PAD);
 }
 
+/*----------------------------------------------------------------------------*/
+/* Aeron payload dissection.                                                  */
+/*----------------------------------------------------------------------------*/
+static void aeron_stream_id_decode_as_set(packet_info * pinfo, guint32 stream_id)
+{
+    guint32 * value = (guint32 *) p_get_proto_data(pinfo->pool, pinfo, proto_aeron, AERON_PROTO_DATA_STREAM_ID);
+
+    if (value == NULL)
+    {
+        value = wmem_new(pinfo->pool, guint32);
+        p_add_proto_data(pinfo->pool, pinfo, proto_aeron, AERON_PROTO_DATA_STREAM_ID, (void *) value);
+    }
+    *value = stream_id;
+}
+
+static void aeron_stream_id_decode_as_prompt(packet_info * pinfo, gchar * result)
+{
+    guint32 * value = (guint32 *) p_get_proto_data(pinfo->pool, pinfo, proto_aeron, AERON_PROTO_DATA_STREAM_ID);
+
+    if (value != NULL)
+    {
+        g_snprintf(result, MAX_DECODE_AS_PROMPT_LEN, "Aeron stream ID %" G_GUINT32_FORMAT " as", *value);
+    }
+    else
+    {
+        g_snprintf(result, MAX_DECODE_AS_PROMPT_LEN, "Unknown Aeron stream ID");
+    }
+}
+
+static gpointer aeron_stream_id_decode_as_value(packet_info * pinfo)
+{
+    guint32 * value = (guint32 *) p_get_proto_data(pinfo->pool, pinfo, proto_aeron, AERON_PROTO_DATA_STREAM_ID);
+
+    if (value != NULL)
+    {
+        return (GUINT_TO_POINTER(*value));
+    }
+    return (NULL);
+}
+
+/*
+    The heuristic which matched a payload on the first pass is kept with the frame, so that later passes call
+    the same one. On the first pass, the heuristic which last matched the (session, stream) is tried first.
+*/
+static heur_dtbl_entry_t aeron_payload_heur_none;
+
+static gboolean aeron_payload_dissect(tvbuff_t * tvb, int offset, packet_info * pinfo, proto_tree * tree, aeron_transport_t * transport, aeron_payload_info_t * payload_info)
+{
+    heur_dtbl_entry_t * sticky_entry = NULL;
+    heur_dtbl_entry_t * hdtbl_entry = NULL;
+
+    /* A dissector registered (or chosen via Decode As) for the stream ID always wins. */
+    if (dissector_try_uint_new(aeron_stream_id_dissector_table, payload_info->stream_id, tvb, pinfo, tree, TRUE, (void *) payload_info) > 0)
+    {
+        return (TRUE);
+    }
+    if (!aeron_use_heuristic_subdissectors)
+    {
+        return (FALSE);
+    }
+    if (PINFO_FD_VISITED(pinfo))
+    {
+        hdtbl_entry = (heur_dtbl_entry_t *) p_get_proto_data(wmem_file_scope(), pinfo, proto_aeron, AERON_PROTO_DATA_PAYLOAD_HEUR(offset));
+        if (hdtbl_entry == &aeron_payload_heur_none)
+        {
+            return (FALSE);
+        }
+        if (hdtbl_entry != NULL)
+        {
+            return (dissector_try_heuristic_entry(hdtbl_entry, tvb, pinfo, tree, (void *) payload_info));
+        }
+        /* Not dissected on the first pass, so probe the whole list, without remembering anything. */
+        return (dissector_try_heuristic(aeron_heuristic_subdissector_list, tvb, pinfo, tree, &hdtbl_entry, (void *) payload_info));
+    }
+    sticky_entry = (heur_dtbl_entry_t *) wmem_tree_lookup32(transport->payload_heur, payload_info->stream_id);
+    if ((sticky_entry != NULL) && dissector_try_heuristic_entry(sticky_entry, tvb, pinfo, tree, (void *) payload_info))
+    {
+        hdtbl_entry = sticky_entry;
+    }
+    else if (dissector_try_heuristic(aeron_heuristic_subdissector_list, tvb, pinfo, tree, &hdtbl_entry, (void *) payload_info))
+    {
+        if (hdtbl_entry != sticky_entry)
+        {
+            wmem_tree_insert32(transport->payload_heur, payload_info->stream_id, (void *) hdtbl_entry);
+        }
+    }
+    p_add_proto_data(wmem_file_scope(), pinfo, proto_aeron, AERON_PROTO_DATA_PAYLOAD_HEUR(offset),
+        (void *) ((hdtbl_entry != NULL) ? hdtbl_entry : &aeron_payload_heur_none));
+    return (hdtbl_entry != NULL);
+}
+
 /*----------------------------------------------------------------------------*/
 /* Aeron data message packet dissection functions.                            */
 /*----------------------------------------------------------------------------*/
@@ -2303,7 +3409,7 @@ static int dissect_aeron_data(tvbuff_t * tvb, int offset, packet_info * pinfo, p
     }
     term_offset = tvb_get_letohl(tvb, offset + O_AERON_DATA_TERM_OFFSET);
     session_id = tvb_get_letohl(tvb, offset + O_AERON_DATA_SESSION_ID);
-    transport = aeron_transport_add(cinfo, session_id, pinfo->fd->num);
+    transport = aeron_transport_get(cinfo, session_id, pinfo, finfo);
     stream_id = tvb_get_letohl(tvb, offset + O_AERON_DATA_STREAM_ID);
     term_id = tvb_get_letohl(tvb, offset + O_AERON_DATA_TERM_ID);
     memset((void *) &pktinfo, 0, sizeof(aeron_packet_info_t));
@@ -2316,6 +3422,12 @@ static int dissect_aeron_data(tvbuff_t * tvb, int offset, packet_info * pinfo, p
     pktinfo.type = HDR_TYPE_DATA;
     pktinfo.flags = tvb_get_guint8(tvb, offset + O_AERON_DATA_FLAGS);
     aeron_frame_info_setup(pinfo, transport, &pktinfo, finfo);
+    aeron_tap_queue(pinfo, transport, &pktinfo, finfo);
+    if ((frame_length >= L_AERON_DATA) && tvb_bytes_exist(tvb, offset + O_AERON_DATA_DATA, (gint) data_length))
+    {
+        /* Keepalives carry no term data, and truncated frames can't be followed */
+        aeron_follow_queue(pinfo, transport, finfo, HDR_TYPE_DATA, stream_id, term_id, term_offset, frame_length, 0, tvb, offset + O_AERON_DATA_DATA);
+    }
 
     aeron_info_stream_progress_report(pinfo, HDR_TYPE_DATA, pktinfo.flags, term_id, term_offset, finfo);
     item = proto_tree_add_none_format(tree, hf_aeron_data, tvb, offset, -1, "Data Frame: Term 0x%x, Ofs %" G_GUINT32_FORMAT ", Len %" G_GUINT32_FORMAT "(%d)",
@@ -2328,17 +3440,19 @@ static int dissect_aeron_data(tvbuff_t * tvb, int offset, packet_info * pinfo, p
     proto_tree_add_item(subtree, hf_aeron_data_type, tvb, offset + O_AERON_DATA_TYPE, 2, ENC_LITTLE_ENDIAN);
     proto_tree_add_item(subtree, hf_aeron_data_frame_length, tvb, offset + O_AERON_DATA_FRAME_LENGTH, 4, ENC_LITTLE_ENDIAN);
     proto_tree_add_item(subtree, hf_aeron_data_term_offset, tvb, offset + O_AERON_DATA_TERM_OFFSET, 4, ENC_LITTLE_ENDIAN);
-    aeron_next_offset_report(tvb, subtree, transport, stream_id, term_id, term_offset, offset_increment);
+    aeron_next_offset_report(tvb, subtree, transport, finfo, stream_id, term_id, term_offset, offset_increment);
     proto_tree_add_item(subtree, hf_aeron_data_session_id, tvb, offset + O_AERON_DATA_SESSION_ID, 4, ENC_LITTLE_ENDIAN);
     proto_tree_add_item(subtree, hf_aeron_data_stream_id, tvb, offset + O_AERON_DATA_STREAM_ID, 4, ENC_LITTLE_ENDIAN);
     proto_tree_add_item(subtree, hf_aeron_data_term_id, tvb, offset + O_AERON_DATA_TERM_ID, 4, ENC_LITTLE_ENDIAN);
+    aeron_stream_id_decode_as_set(pinfo, stream_id);
     if (data_length > 0)
     {
         tvbuff_t * data_tvb = NULL;
         gboolean can_call_subdissector = FALSE;
         gboolean dissector_found = FALSE;
-        heur_dtbl_entry_t * hdtbl_entry;
+        aeron_payload_info_t payload_info;
 
+        memset((void *) &payload_info, 0, sizeof(aeron_payload_info_t));
         aeron_msg_process(tvb, offset, pinfo, transport, &pktinfo, finfo);
         if ((pktinfo.flags & DATA_FLAGS_COMPLETE) == DATA_FLAGS_COMPLETE)
         {
@@ -2351,6 +3465,7 @@ static int dissect_aeron_data(tvbuff_t * tvb, int offset, packet_info * pinfo, p
                 dissect_aeron_reassembled_data(pinfo, subtree, finfo);
                 data_tvb = finfo->message->reassembled_data;
                 can_call_subdissector = TRUE;
+                payload_info.reassembled = TRUE;
             }
             else
             {
@@ -2361,9 +3476,21 @@ static int dissect_aeron_data(tvbuff_t * tvb, int offset, packet_info * pinfo, p
         {
             data_tvb = tvb_new_subset_length(tvb, offset + O_AERON_DATA_DATA, data_length);
         }
-        if (can_call_subdissector && aeron_use_heuristic_subdissectors)
+        if (can_call_subdissector)
         {
-            dissector_found = dissector_try_heuristic(aeron_heuristic_subdissector_list, data_tvb, pinfo, subtree, &hdtbl_entry, NULL);
+            payload_info.channel_id = transport->channel_id;
+            payload_info.session_id = session_id;
+            payload_info.stream_id = stream_id;
+            payload_info.term_id = term_id;
+            if (payload_info.reassembled)
+            {
+                payload_info.term_offset = finfo->message->first_fragment_term_offset;
+            }
+            else
+            {
+                payload_info.term_offset = term_offset;
+            }
+            dissector_found = aeron_payload_dissect(data_tvb, offset, pinfo, subtree, transport, &payload_info);
         }
         if (!dissector_found)
         {
@@ -2398,7 +3525,7 @@ static int dissect_aeron_nak(tvbuff_t * tvb, int offset, packet_info * pinfo, pr
     frame_length = tvb_get_letohl(tvb, offset + O_AERON_NAK_FRAME_LENGTH);
     rounded_length = (int) aeron_pos_roundup(frame_length);
     session_id = tvb_get_letohl(tvb, offset + O_AERON_NAK_SESSION_ID);
-    transport = aeron_transport_add(cinfo, session_id, pinfo->fd->num);
+    transport = aeron_transport_get(cinfo, session_id, pinfo, finfo);
     stream_id = tvb_get_letohl(tvb, offset + O_AERON_NAK_STREAM_ID);
     term_id = tvb_get_letohl(tvb, offset + O_AERON_NAK_TERM_ID);
     nak_term_offset = tvb_get_letohl(tvb, offset + O_AERON_NAK_TERM_OFFSET);
@@ -2412,6 +3539,7 @@ static int dissect_aeron_nak(tvbuff_t * tvb, int offset, packet_info * pinfo, pr
     pktinfo.type = HDR_TYPE_NAK;
     pktinfo.flags = tvb_get_guint8(tvb, offset + O_AERON_NAK_FLAGS);
     aeron_frame_info_setup(pinfo, transport, &pktinfo, finfo);
+    aeron_tap_queue(pinfo, transport, &pktinfo, finfo);
 
     col_append_sep_str(pinfo->cinfo, COL_INFO, ", ", "NAK");
     item = proto_tree_add_none_format(tree, hf_aeron_nak, tvb, offset, -1, "NAK Frame: Term 0x%x, Ofs %" G_GUINT32_FORMAT ", Len %" G_GUINT32_FORMAT,
@@ -2473,7 +3601,7 @@ static int dissect_aeron_sm(tvbuff_t * tvb, int offset, packet_info * pinfo, pro
     feedback_length = frame_length - O_AERON_SM_FEEDBACK;
     rounded_length = (int) aeron_pos_roundup(frame_length);
     session_id = tvb_get_letohl(tvb, offset + O_AERON_SM_SESSION_ID);
-    transport = aeron_transport_add(cinfo, session_id, pinfo->fd->num);
+    transport = aeron_transport_get(cinfo, session_id, pinfo, finfo);
     stream_id = tvb_get_letohl(tvb, offset + O_AERON_SM_STREAM_ID);
     term_id = tvb_get_letohl(tvb, offset + O_AERON_SM_TERM_ID);
     comp_offset = tvb_get_letohl(tvb, offset + O_AERON_SM_COMPLETED_TERM_OFFSET);
@@ -2499,6 +3627,7 @@ static int dissect_aeron_sm(tvbuff_t * tvb, int offset, packet_info * pinfo, pro
     pktinfo.data_length = 0;
     pktinfo.type = HDR_TYPE_SM;
     aeron_frame_info_setup(pinfo, transport, &pktinfo, finfo);
+    aeron_tap_queue(pinfo, transport, &pktinfo, finfo);
 
     aeron_info_stream_progress_report(pinfo, HDR_TYPE_SM, pktinfo.flags, term_id, comp_offset, finfo);
     item = proto_tree_add_none_format(tree, hf_aeron_sm, tvb, offset, -1, "Status Message: Term 0x%x, CompletedOfs %" G_GUINT32_FORMAT ", RcvWindow %" G_GUINT32_FORMAT,
@@ -2598,7 +3727,7 @@ static int dissect_aeron_setup(tvbuff_t * tvb, int offset, packet_info * pinfo,
     rounded_length = (int) aeron_pos_roundup(frame_length);
     term_offset = tvb_get_letohl(tvb, offset + O_AERON_SETUP_TERM_OFFSET);
     session_id = tvb_get_letohl(tvb, offset + O_AERON_SETUP_SESSION_ID);
-    transport = aeron_transport_add(cinfo, session_id, pinfo->fd->num);
+    transport = aeron_transport_get(cinfo, session_id, pinfo, finfo);
     stream_id = tvb_get_letohl(tvb, offset + O_AERON_SETUP_STREAM_ID);
     initial_term_id = tvb_get_letohl(tvb, offset + O_AERON_SETUP_INITIAL_TERM_ID);
     active_term_id = tvb_get_letohl(tvb, offset + O_AERON_SETUP_ACTIVE_TERM_ID);
@@ -2613,9 +3742,11 @@ static int dissect_aeron_setup(tvbuff_t * tvb, int offset, packet_info * pinfo,
     pktinfo.type = HDR_TYPE_SETUP;
     pktinfo.flags = 0;
     aeron_frame_info_setup(pinfo, transport, &pktinfo, finfo);
+    aeron_tap_queue(pinfo, transport, &pktinfo, finfo);
     term_length = tvb_get_letohl(tvb, offset + O_AERON_SETUP_TERM_LENGTH);
     mtu = tvb_get_letohl(tvb, offset + O_AERON_SETUP_MTU);
     aeron_set_stream_mtu_term_length(pinfo, transport, stream_id, mtu, term_length);
+    aeron_follow_queue(pinfo, transport, finfo, HDR_TYPE_SETUP, stream_id, active_term_id, term_offset, 0, term_length, NULL, 0);
 
     col_append_sep_str(pinfo->cinfo, COL_INFO, ", ", "Setup");
     item = proto_tree_add_none_format(tree, hf_aeron_setup, tvb, offset, -1, "Setup Frame: InitTerm 0x%x, ActiveTerm 0x%x, TermLen %" G_GUINT32_FORMAT ", Ofs %" G_GUINT32_FORMAT ", MTU %" G_GUINT32_FORMAT,
@@ -2662,7 +3793,7 @@ static int dissect_aeron(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree,
     }
     col_add_str(pinfo->cinfo, COL_PROTOCOL, "Aeron");
     col_clear(pinfo->cinfo, COL_INFO);
-    col_add_str(pinfo->cinfo, COL_INFO, aeron_format_transport_uri(cinfo));
+    col_add_str(pinfo->cinfo, COL_INFO, aeron_transport_uri(cinfo, pinfo->fd->num));
     col_set_fence(pinfo->cinfo, COL_INFO);
 
     length_remaining = tvb_reported_length(tvb);
@@ -2710,13 +3841,24 @@ static int dissect_aeron(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree,
     return (total_dissected_length);
 }
 
-static gboolean test_aeron_packet(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree, void * user_data)
+static gboolean aeron_is_configured_multicast_group(const address * addr)
+{
+    guint32 addr_h;
+
+    if ((addr->type != AT_IPv4) || (aeron_mc_address_low_host == 0))
+    {
+        return (FALSE);
+    }
+    addr_h = pntoh32(addr->data);
+    return ((addr_h >= aeron_mc_address_low_host) && (addr_h <= aeron_mc_address_high_host));
+}
+
+static gboolean test_aeron_packet_probe(tvbuff_t * tvb)
 {
     guint8 ver = 0;
     guint16 packet_type = 0;
     gint length;
     gint length_remaining;
-    int rc;
 
     length_remaining = tvb_reported_length_remaining(tvb, 0);
     if (length_remaining < HDR_LENGTH_MIN)
@@ -2766,7 +3908,40 @@ static gboolean test_aeron_packet(tvbuff_t * tvb, packet_info * pinfo, proto_tre
             return (FALSE);
         }
     }
+    return (TRUE);
+}
+
+static gboolean test_aeron_packet(tvbuff_t * tvb, packet_info * pinfo, proto_tree * tree, void * user_data)
+{
+    conversation_t * conv = NULL;
+    int rc;
+
+    if (aeron_is_configured_multicast_group(&(pinfo->dst)))
+    {
+        /* Configured Aeron multicast group, dispatch directly. */
+        rc = dissect_aeron(tvb, pinfo, tree, user_data);
+        return (rc != -1);
+    }
+    if (aeron_heuristic_verdict_cache)
+    {
+        if (aeron_heur_verdict_rejected(pinfo, &conv))
+        {
+            return (FALSE);
+        }
+    }
+    if (!test_aeron_packet_probe(tvb))
+    {
+        if (conv != NULL)
+        {
+            aeron_heur_verdict_set(pinfo, conv, FALSE);
+        }
+        return (FALSE);
+    }
     rc = dissect_aeron(tvb, pinfo, tree, user_data);
+    if (conv != NULL)
+    {
+        aeron_heur_verdict_set(pinfo, conv, (rc != -1));
+    }
     if (rc == -1)
     {
         return (FALSE);
@@ -2776,7 +3951,10 @@ static gboolean test_aeron_packet(tvbuff_t * tvb, packet_info * pinfo, proto_tre
 
 static void aeron_init(void)
 {
+    aeron_frame_info_init();
     aeron_channel_id_init();
+    aeron_heur_verdict_init();
+    aeron_term_live_init();
 }
 
 /* Register all the bits needed with the filtering engine */
@@ -2963,7 +4141,21 @@ void proto_register_aeron(void)
         { &hf_aeron_stream_analysis_completed_term_offset,
             { "Completed term offset", "aeron.stream_analysis.completed_term_offset", FT_UINT32, BASE_DEC_HEX, NULL, 0x0, NULL, HFILL } },
         { &hf_aeron_stream_analysis_outstanding_bytes,
-            { "Outstanding bytes", "aeron.stream_analysis.outstanding_bytes", FT_UINT32, BASE_DEC, NULL, 0x0, NULL, HFILL } }
+            { "Outstanding bytes", "aeron.stream_analysis.outstanding_bytes", FT_UINT32, BASE_DEC, NULL, 0x0, NULL, HFILL } },
+        { &hf_aeron_stream_analysis_receiver_lag,
+            { "Receiver lag", "aeron.stream_analysis.receiver_lag", FT_RELATIVE_TIME, BASE_NONE, NULL, 0x0, "Time between sending the oldest data completed by this SM and this SM", HFILL } },
+        { &hf_aeron_stream_analysis_receiver_lag_frame,
+            { "Receiver lag data frame", "aeron.stream_analysis.receiver_lag_frame", FT_FRAMENUM, BASE_NONE, NULL, 0x0, "Frame containing the oldest data completed by this SM", HFILL } },
+        { &hf_aeron_stream_analysis_receiver_count,
+            { "Receivers", "aeron.stream_analysis.receiver_count", FT_UINT32, BASE_DEC, NULL, 0x0, "Number of receivers which have sent an SM for this stream", HFILL } },
+        { &hf_aeron_stream_analysis_slowest_receiver,
+            { "Slowest receiver", "aeron.stream_analysis.slowest_receiver", FT_STRING, BASE_NONE, NULL, 0x0, "Receiver with the lowest completed position", HFILL } },
+        { &hf_aeron_stream_analysis_min_completed_term_id,
+            { "Slowest receiver completed term ID", "aeron.stream_analysis.min_completed_term_id", FT_UINT32, BASE_DEC_HEX, NULL, 0x0, NULL, HFILL } },
+        { &hf_aeron_stream_analysis_min_completed_term_offset,
+            { "Slowest receiver completed term offset", "aeron.stream_analysis.min_completed_term_offset", FT_UINT32, BASE_DEC_HEX, NULL, 0x0, NULL, HFILL } },
+        { &hf_aeron_stream_analysis_min_outstanding_bytes,
+            { "Slowest receiver outstanding bytes", "aeron.stream_analysis.min_outstanding_bytes", FT_UINT32, BASE_DEC, NULL, 0x0, "Bytes sent but not yet completed by the slowest receiver", HFILL } }
     };
     static gint * ett[] =
     {
@@ -2999,6 +4191,13 @@ void proto_register_aeron(void)
         { &ei_aeron_analysis_rx, { "aeron.analysis.rx", PI_SEQUENCE, PI_NOTE, "This frame contains a (likely) retransmission", EXPFILL } },
         { &ei_aeron_analysis_term_id_change, { "aeron.analysis.term_id_change", PI_SEQUENCE, PI_CHAT, "This frame contains a new term ID", EXPFILL } }
     };
+    static build_valid_func aeron_stream_id_da_build_value[1] = { aeron_stream_id_decode_as_value };
+    static decode_as_value_t aeron_stream_id_da_values = { aeron_stream_id_decode_as_prompt, 1, aeron_stream_id_da_build_value };
+    static decode_as_t aeron_stream_id_da =
+    {
+        "aeron", "Aeron Stream ID", "aeron.stream_id", 1, 0, &aeron_stream_id_da_values, NULL, NULL,
+        decode_as_default_populate_list, decode_as_default_reset, decode_as_default_change, NULL
+    };
     module_t * aeron_module;
     expert_module_t * expert_aeron;
 
@@ -3010,6 +4209,8 @@ void proto_register_aeron(void)
     expert_register_field_array(expert_aeron, ei, array_length(ei));
     aeron_module = prefs_register_protocol(proto_aeron, proto_reg_handoff_aeron);
     aeron_heuristic_subdissector_list = register_heur_dissector_list("aeron_msg_payload");
+    aeron_stream_id_dissector_table = register_dissector_table("aeron.stream_id", "Aeron stream ID", FT_UINT32, BASE_DEC);
+    register_decode_as(&aeron_stream_id_da);
 
     prefs_register_bool_preference(aeron_module,
         "sequence_analysis",
@@ -3031,17 +4232,95 @@ void proto_register_aeron(void)
         "Use heuristic sub-dissectors",
         "Use a registered heuristic sub-dissector to decode the payload data. Requires \"Analyze transport sequencing\", \"Analyze stream sequencing\", and \"Reassemble fragmented data\".",
         &aeron_use_heuristic_subdissectors);
+    range_convert_str(&global_aeron_udp_port_range, "", MAX_UDP_PORT);
+    prefs_register_range_preference(aeron_module,
+        "udp_ports",
+        "UDP ports",
+        "UDP ports (and port ranges) on which all traffic is decoded as Aeron, without running the UDP heuristic.",
+        &global_aeron_udp_port_range,
+        MAX_UDP_PORT);
+    prefs_register_string_preference(aeron_module,
+        "mc_address_low",
+        "Multicast address range low",
+        "Set the low end of the IPv4 multicast address range decoded as Aeron without running the UDP heuristic (empty to disable).",
+        &global_aeron_mc_address_low);
+    prefs_register_string_preference(aeron_module,
+        "mc_address_high",
+        "Multicast address range high",
+        "Set the high end of the IPv4 multicast address range decoded as Aeron without running the UDP heuristic (empty to disable).",
+        &global_aeron_mc_address_high);
+    prefs_register_uint_preference(aeron_module,
+        "streaming_term_window",
+        "Streaming term window",
+        "Keep analysis and reassembly state for only this many of the most recent terms of each stream, releasing older terms (0 keeps everything). "
+        "Bounds memory use when reading very large captures in a single pass. Reassembled messages in released terms are no longer available when frames are re-dissected.",
+        10,
+        &aeron_streaming_term_window);
+    prefs_register_uint_preference(aeron_module,
+        "receiver_timeout",
+        "Receiver timeout (seconds)",
+        "Consider a receiver gone once it has sent no status message for this many seconds, and leave it out of the slowest receiver "
+        "and minimum completed position (0, the default, keeps every receiver). Requires \"Analyze stream sequencing\".",
+        0,
+        &aeron_receiver_timeout);
+    prefs_register_bool_preference(aeron_module,
+        "heuristic_verdict_cache",
+        "Remember rejected UDP conversations",
+        "When the UDP heuristic has rejected the first 8 probed packets of a UDP conversation and accepted none, reject the rest of the conversation without probing it. "
+        "Aeron traffic in a conversation which starts with 8 or more other datagrams is then not dissected.",
+        &aeron_heuristic_verdict_cache);
     register_init_routine(aeron_init);
-    aeron_frame_info_tree = wmem_tree_new_autoreset(wmem_epan_scope(), wmem_file_scope());
+    aeron_tap_handle = register_tap("aeron");
+    aeron_follow_tap_handle = register_tap("aeron_follow");
 }
 
 /* The registration hand-off routine */
 void proto_reg_handoff_aeron(void)
 {
-    aeron_dissector_handle = new_create_dissector_handle(dissect_aeron, proto_aeron);
-    dissector_add_for_decode_as("udp.port", aeron_dissector_handle);
-    heur_dissector_add("udp", test_aeron_packet, proto_aeron);
-    aeron_data_dissector_handle = find_dissector("data");
+    static gboolean already_registered = FALSE;
+    static range_t * aeron_udp_port_range = NULL;
+    struct in_addr addr;
+    guint32 mc_addr_h_low = 0;
+    guint32 mc_addr_h_high = 0;
+
+    if (!already_registered)
+    {
+        aeron_dissector_handle = new_create_dissector_handle(dissect_aeron, proto_aeron);
+        dissector_add_for_decode_as("udp.port", aeron_dissector_handle);
+        heur_dissector_add("udp", test_aeron_packet, proto_aeron);
+        aeron_data_dissector_handle = find_dissector("data");
+        already_registered = TRUE;
+    }
+    else
+    {
+        dissector_delete_uint_range("udp.port", aeron_udp_port_range, aeron_dissector_handle);
+        g_free(aeron_udp_port_range);
+    }
+    aeron_udp_port_range = range_copy(global_aeron_udp_port_range);
+    dissector_add_uint_range("udp.port", aeron_udp_port_range, aeron_dissector_handle);
+
+    /* The analysis must see every Aeron frame, even when the filters don't. */
+    set_dissection_depth_stateful(proto_aeron, aeron_sequence_analysis || aeron_stream_analysis);
+
+    /* Only use the multicast range if both ends are valid multicast addresses and low <= high. */
+    if ((global_aeron_mc_address_low != NULL) && (global_aeron_mc_address_low[0] != '\0') && (inet_aton(global_aeron_mc_address_low, &addr) != 0))
+    {
+        mc_addr_h_low = g_ntohl(addr.s_addr);
+    }
+    if ((global_aeron_mc_address_high != NULL) && (global_aeron_mc_address_high[0] != '\0') && (inet_aton(global_aeron_mc_address_high, &addr) != 0))
+    {
+        mc_addr_h_high = g_ntohl(addr.s_addr);
+    }
+    if (((mc_addr_h_low & 0xf0000000) == 0xe0000000) && ((mc_addr_h_high & 0xf0000000) == 0xe0000000) && (mc_addr_h_low <= mc_addr_h_high))
+    {
+        aeron_mc_address_low_host = mc_addr_h_low;
+        aeron_mc_address_high_host = mc_addr_h_high;
+    }
+    else
+    {
+        aeron_mc_address_low_host = 0;
+        aeron_mc_address_high_host = 0;
+    }
 }
 
 /*
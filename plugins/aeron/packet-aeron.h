@@ -0,0 +1,142 @@
+/* packet-aeron.h
+ * Definitions shared between the Aeron dissector and its tap listeners.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef PACKET_AERON_H_INCLUDED
+#define PACKET_AERON_H_INCLUDED
+
+/* Frame types */
+#define HDR_TYPE_PAD 0x0000
+#define HDR_TYPE_DATA 0x0001
+#define HDR_TYPE_NAK 0x0002
+#define HDR_TYPE_SM 0x0003
+#define HDR_TYPE_ERR 0x0004
+#define HDR_TYPE_SETUP 0x0005
+#define HDR_TYPE_EXT 0xFFFF
+
+/* Stream analysis flags */
+#define AERON_STREAM_ANALYSIS_FLAGS_WINDOW_FULL      0x00000001
+#define AERON_STREAM_ANALYSIS_FLAGS_IDLE_RX          0x00000002
+#define AERON_STREAM_ANALYSIS_FLAGS_PACING_RX        0x00000004
+#define AERON_STREAM_ANALYSIS_FLAGS_OOO              0x00000008
+#define AERON_STREAM_ANALYSIS_FLAGS_OOO_GAP          0x00000010
+#define AERON_STREAM_ANALYSIS_FLAGS_KEEPALIVE        0x00000020
+#define AERON_STREAM_ANALYSIS_FLAGS_WINDOW_RESIZE    0x00000040
+#define AERON_STREAM_ANALYSIS_FLAGS_OOO_SM           0x00000080
+#define AERON_STREAM_ANALYSIS_FLAGS_KEEPALIVE_SM     0x00000100
+#define AERON_STREAM_ANALYSIS_FLAGS_RX               0x00000200
+#define AERON_STREAM_ANALYSIS_FLAGS_TERM_ID_CHANGE   0x00000400
+
+/* Frame (sequence analysis) flags */
+#define AERON_FRAME_INFO_FLAGS_RETRANSMISSION  0x00000001
+#define AERON_FRAME_INFO_FLAGS_KEEPALIVE       0x00000002
+#define AERON_FRAME_INFO_FLAGS_REASSEMBLED_MSG 0x00000004
+
+/*
+    Tap information, queued to the "aeron" tap once per Aeron frame (so possibly several times
+    per packet). Analysis flags are only set when the corresponding analysis preferences are
+    enabled.
+*/
+typedef struct
+{
+    const address * addr1;                  /* Transport address 1 (publisher, or control group for multicast) */
+    const address * addr2;                  /* Transport address 2 (subscriber, or data group for multicast) */
+    guint64 channel_id;                     /* Transport channel ID */
+    guint32 session_id;
+    guint32 stream_id;
+    guint32 term_id;
+    guint32 term_offset;                    /* Term offset (DATA/PAD), completed term offset (SM), or NAK term offset (NAK) */
+    guint32 length;                         /* Frame length (DATA/PAD), or NAK length (NAK) */
+    guint32 receiver_window;                /* Receiver window (SM) */
+    guint32 stream_analysis_flags;          /* AERON_STREAM_ANALYSIS_FLAGS_* */
+    guint32 frame_flags;                    /* AERON_FRAME_INFO_FLAGS_* */
+    nstime_t receiver_lag;                  /* Time from sending the oldest data completed by this SM to the SM */
+    gboolean receiver_lag_valid;            /* TRUE if receiver_lag is set (SM, with stream analysis) */
+    guint32 gap_term_id;                    /* Start of the skipped data (DATA/PAD with AERON_STREAM_ANALYSIS_FLAGS_OOO_GAP) */
+    guint32 gap_term_offset;
+    guint32 gap_length;                     /* Number of bytes skipped */
+    guint32 nak_unrecovered;                /* Bytes of this NAK not (yet) recovered by RX (NAK) */
+    guint32 rx_nak_count;                   /* Number of NAKs this retransmission answers (DATA/PAD) */
+    const guint32 * rx_nak_frame;           /* Frame number of each NAK */
+    const guint32 * rx_nak_unrecovered;     /* Bytes of each NAK not (yet) recovered, including this RX */
+    guint32 evicted_terms;                  /* Totals for terms of this stream released by this frame (streaming mode) */
+    guint32 evicted_fragments;
+    guint32 evicted_messages;
+    guint32 evicted_naks;
+    const gchar * receiver;                 /* Receiver (address:port) which sent this SM (SM, with stream analysis) */
+    guint32 outstanding_bytes;              /* Bytes sent but not yet completed by this receiver (SM, with stream analysis) */
+    const gchar * slowest_receiver;         /* Receiver with the lowest completed position, or NULL before the first SM (with stream analysis) */
+    guint32 receiver_count;                 /* Number of receivers seen for the stream (with stream analysis) */
+    guint32 min_completed_term_id;          /* Completed position of the slowest receiver */
+    guint32 min_completed_term_offset;
+    guint32 min_outstanding_bytes;          /* Bytes sent but not yet completed by the slowest receiver */
+    guint16 port1;
+    guint16 port2;
+    guint16 type;                           /* HDR_TYPE_* */
+    guint8 flags;                           /* Frame header flags */
+} aeron_tap_info_t;
+
+/*
+    Payload information, passed as the data parameter to dissectors in the "aeron.stream_id" table and
+    the "aeron_msg_payload" heuristic list.
+*/
+typedef struct
+{
+    guint64 channel_id;                     /* Transport channel ID */
+    guint32 session_id;
+    guint32 stream_id;
+    guint32 term_id;
+    guint32 term_offset;                    /* Term offset of the (first) fragment of the message */
+    gboolean reassembled;                   /* TRUE if the payload was reassembled from several fragments */
+} aeron_payload_info_t;
+
+/*
+    Follow information, queued to the "aeron_follow" tap for each DATA (other than keepalives), PAD and SETUP
+    frame, so that the term data of a stream can be written out without building protocol trees.
+*/
+typedef struct
+{
+    guint64 channel_id;                     /* Transport channel ID */
+    guint32 session_id;
+    guint32 stream_id;
+    guint32 term_id;                        /* Term ID (DATA/PAD), or active term ID (SETUP) */
+    guint32 term_offset;
+    guint32 frame_length;                   /* Frame length, including the header (DATA/PAD) */
+    guint32 term_length;                    /* Term length (SETUP) */
+    tvbuff_t * data;                        /* Frame payload (DATA), NULL otherwise */
+    gboolean duplicate;                     /* TRUE if an earlier frame carried this term offset (DATA/PAD, with sequence analysis) */
+    guint16 type;                           /* HDR_TYPE_* */
+} aeron_follow_info_t;
+
+#endif
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 4
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=4 expandtab:
+ * :indentSize=4:tabSize=4:noTabs=true:
+ */
@@ -341,8 +341,116 @@ clopts_suite_tshark_capture_options() {
 	test_step_add  "Invalid TShark capture interface index 0" clopts_step_tshark_invalid_interfaces_index
 }
 
+# check that the display filter in $DFILTER matches the same packets of
+# dhcp.pcap whether or not its tests are simplified and reordered when it
+# is compiled
+clopts_step_dfilter_optimized() {
+	$TSHARK -r "${CAPTURE_DIR}dhcp.pcap" -Y "$DFILTER" > ./testout.txt 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_output_print ./testout.txt
+		test_step_failed "exit status: $RETURNVALUE"
+		return
+	fi
+	WIRESHARK_DFILTER_NO_OPTIMIZE=1 $TSHARK -r "${CAPTURE_DIR}dhcp.pcap" -Y "$DFILTER" > ./testout2.txt 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_output_print ./testout2.txt
+		test_step_failed "exit status without optimization: $RETURNVALUE"
+		return
+	fi
+	diff ./testout.txt ./testout2.txt > /dev/null
+	if [ $? -eq 0 ]; then
+		test_step_ok
+	else
+		test_step_output_print ./testout.txt ./testout2.txt
+		test_step_failed "The optimized filter matched different packets"
+	fi
+}
+
+# filters whose tests are reordered or simplified by the optimizer
+clopts_suite_dfilter_optimize() {
+	for DFILTER in \
+		'frame contains "MSFT" && udp.srcport == 68' \
+		'bootp.hw.mac_addr[0:3] == 00:0b:82 || bootp.type == 2' \
+		'!(udp.dstport == 67) || frame.len > 300 && bootp.option.dhcp == 3' \
+		'bootp.option.dhcp || bootp.option.dhcp == 1' \
+		'bootp.type && bootp.type == 1' \
+		'bootp && udp.port == 67 && bootp' \
+		'not not bootp.option.dhcp == 5'
+	do
+		test_step_add "Optimized display filter $DFILTER" clopts_step_dfilter_optimized
+	done
+}
+
+# check that with --filter-depth, the display filter in $DFILTER selects as
+# many packets of $DEPTH_CAPTURE, read with the options in $DEPTH_ARGS, as
+# with a full dissection
+clopts_step_filter_depth() {
+	$TSHARK -q -r "${CAPTURE_DIR}${DEPTH_CAPTURE}" $DEPTH_ARGS -Y "$DFILTER" -w ./testout.pcap > ./testout.txt 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_output_print ./testout.txt
+		test_step_failed "exit status: $RETURNVALUE"
+		return
+	fi
+	$TSHARK -q -r "${CAPTURE_DIR}${DEPTH_CAPTURE}" $DEPTH_ARGS -Y "$DFILTER" --filter-depth -w ./testout2.pcap > ./testout2.txt 2>&1
+	RETURNVALUE=$?
+	if [ ! $RETURNVALUE -eq $EXIT_OK ]; then
+		test_step_output_print ./testout2.txt
+		test_step_failed "exit status with --filter-depth: $RETURNVALUE"
+		return
+	fi
+	grep -i 'is ignored' ./testout2.txt > /dev/null
+	if [ $? -eq 0 ]; then
+		test_step_output_print ./testout2.txt
+		test_step_failed "--filter-depth was ignored"
+		return
+	fi
+	$TSHARK -r ./testout.pcap > ./testout.txt 2>&1
+	$TSHARK -r ./testout2.pcap > ./testout2.txt 2>&1
+	COUNT=`wc -l < ./testout.txt`
+	COUNT_DEPTH=`wc -l < ./testout2.txt`
+	if [ $COUNT -eq 0 ]; then
+		test_step_failed "No packets matched"
+	elif [ $COUNT -ne $COUNT_DEPTH ]; then
+		test_step_output_print ./testout.txt ./testout2.txt
+		test_step_failed "$COUNT_DEPTH packets matched with --filter-depth instead of $COUNT"
+	else
+		test_step_ok
+	fi
+}
+
+clopts_suite_filter_depth() {
+	DEPTH_CAPTURE=dhcp.pcap
+	DEPTH_ARGS=
+	for DFILTER in \
+		'udp.dstport == 67' \
+		'ip.src == 0.0.0.0' \
+		'eth.dst == ff:ff:ff:ff:ff:ff && udp' \
+		'udp.port == 68 && bootp.type == 2'
+	do
+		test_step_add "--filter-depth with display filter $DFILTER" clopts_step_filter_depth
+	done
+}
+
+# Segments carrying several HTTP/2 frames, some of them spanning segments,
+# so that TCP reassembly calls HTTP/2 again after it was seen in the packet
+clopts_suite_filter_depth_tcp() {
+	DEPTH_CAPTURE=packet-h2-14_headers.pcapng
+	DEPTH_ARGS="-d tcp.port==3000,http2"
+	for DFILTER in \
+		'http2.type == 0' \
+		'http2.type == 1' \
+		'http2.flags.ack.settings == 1' \
+		'tcp.len > 0 && http2'
+	do
+		test_step_add "--filter-depth with display filter $DFILTER" clopts_step_filter_depth
+	done
+}
+
 clopts_post_step() {
-	rm -f ./testout.txt ./testout2.txt
+	rm -f ./testout.txt ./testout2.txt ./testout.pcap ./testout2.pcap
 }
 
 clopt_suite() {
@@ -357,6 +465,9 @@ clopt_suite() {
 	test_suite_add "Interface-specific TShark single char options" clopts_suite_tshark_interface_chars
 	test_suite_add "Capture filter/interface options tests" clopts_suite_tshark_capture_options
 	test_suite_add "Dump glossaries" clopts_suite_dump_glossaries
+	test_suite_add "Display filter optimization" clopts_suite_dfilter_optimize
+	test_suite_add "Filter-driven dissection depth" clopts_suite_filter_depth
+	test_suite_add "Filter-driven dissection depth, TCP with several PDUs" clopts_suite_filter_depth_tcp
 	test_step_add  "Valid name resolution options -N (1s)" clopts_step_valid_name_resolving
 	#test_remark_add "Options currently unchecked: S, V, l, n, p, q and x"
 }
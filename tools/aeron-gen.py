@@ -0,0 +1,366 @@
+#!/usr/bin/env python
+#
+# Generate synthetic Aeron captures, for benchmarking the Aeron dissector
+# and its analysis on inputs of any size.
+#
+# Wireshark - Network traffic analyzer
+# By Gerald Combs <gerald@wireshark.org>
+# Copyright 1998 Gerald Combs
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+"""
+Writes a pcap or pcapng file of Ethernet/IPv4/UDP packets carrying valid
+Aeron traffic: for each (session, stream), a setup exchange (SM with the
+setup flag, then SETUP), followed by DATA frames (fragmented as the MTU
+requires), PAD frames at the end of each term, periodic status messages,
+and NAKs followed by retransmissions for lost frames. With --burst, each
+loss drops a run of consecutive frames, as a congested link would.
+
+The output only depends on the options (including --seed), so a corpus can
+be regenerated on demand instead of being stored. For example:
+
+    tools/aeron-gen.py --sessions 4 --streams 2 --messages 5000000 \\
+        --loss 0.001 --reorder 0.001 -o aeron-bench.pcapng
+    tshark -r aeron-bench.pcapng -o aeron.sequence_analysis:TRUE \\
+        -o aeron.stream_analysis:TRUE -o aeron.udp_ports:40123 -q -z aeron,stat
+
+Message payloads use the "aerondata" format understood by the aeron-hsd
+plugin (magic, CRC-32 of the message data, sequence number), so they can be
+checked with -o aerondata.checksum:crc32, unless --raw-payload is given.
+"""
+
+from __future__ import print_function
+
+from optparse import OptionParser
+import random
+import struct
+import sys
+import zlib
+
+# Aeron frame types, flags and header lengths (see plugins/aeron/packet-aeron.c)
+HDR_TYPE_PAD = 0x0000
+HDR_TYPE_DATA = 0x0001
+HDR_TYPE_NAK = 0x0002
+HDR_TYPE_SM = 0x0003
+HDR_TYPE_SETUP = 0x0005
+
+DATA_FLAGS_BEGIN = 0x80
+DATA_FLAGS_END = 0x40
+STATUS_FLAGS_SETUP = 0x80
+
+L_AERON_DATA = 24
+L_AERON_NAK = 28
+L_AERON_SM = 28
+L_AERON_SETUP = 36
+
+AERONDATA_MAGIC = 0x0dd01221
+L_AERONDATA_HEADER = 12
+
+def align(length):
+    '''Round up to the frame alignment used by the dissector.'''
+    return (length + 7) & ~7
+
+class CaptureWriter:
+    '''Writes Ethernet frames to a pcap or pcapng file.'''
+
+    def __init__(self, name, pcapng):
+        try:
+            self.fh = open(name, 'wb')
+        except IOError as err:
+            sys.exit(err)
+        self.pcapng = pcapng
+        self.bytes_written = 0
+        if pcapng:
+            # Section header block, then an Ethernet interface description block
+            self._write(struct.pack('<IIIHHq', 0x0A0D0D0A, 28, 0x1A2B3C4D, 1, 0, -1) + struct.pack('<I', 28))
+            self._write(struct.pack('<IIHHII', 1, 20, 1, 0, 65535, 20))
+        else:
+            self._write(struct.pack('<IHHiIII', 0xa1b2c3d4, 2, 4, 0, 0, 65535, 1))
+
+    def _write(self, data):
+        self.fh.write(data)
+        self.bytes_written += len(data)
+
+    def write(self, ts_usec, frame):
+        length = len(frame)
+        if self.pcapng:
+            pad = (4 - (length % 4)) % 4
+            block_length = 32 + length + pad
+            self._write(struct.pack('<IIIIIII', 6, block_length, 0, (ts_usec >> 32) & 0xffffffff, ts_usec & 0xffffffff, length, length)
+                + frame + (b'\0' * pad) + struct.pack('<I', block_length))
+        else:
+            self._write(struct.pack('<IIII', ts_usec // 1000000, ts_usec % 1000000, length, length) + frame)
+
+    def close(self):
+        self.fh.close()
+
+def ip_checksum(header):
+    total = sum(struct.unpack('!10H', header))
+    while total > 0xffff:
+        total = (total & 0xffff) + (total >> 16)
+    return (~total) & 0xffff
+
+class Stream:
+    '''Publisher and receiver state for one (session, stream) pair.'''
+
+    def __init__(self, session_id, stream_id, publisher, receiver, term_length, initial_term_id):
+        self.session_id = session_id
+        self.stream_id = stream_id
+        self.publisher = publisher              # (address, port)
+        self.receiver = receiver
+        self.term_length = term_length
+        self.initial_term_id = initial_term_id
+        self.term_id = initial_term_id
+        self.term_offset = 0
+        self.sqn = 0
+        self.data_frames = 0
+        self.lost = []                          # (term_id, term_offset, aligned length, frame) not yet NAKed
+        self.frames_since_loss = 0
+        self.burst_left = 0                     # DATA frames still to be lost in the current burst
+        self.held = None                        # Frame held back to be sent out of order
+
+class Generator:
+    def __init__(self, options, writer):
+        self.options = options
+        self.writer = writer
+        self.rng = random.Random(options.seed)
+        self.ts_usec = 1400000000 * 1000000
+        self.ts_step = max(1, int(1000000 / options.rate))
+        self.ip_id = 0
+        self.packets = 0
+        self.max_payload = options.mtu - L_AERON_DATA
+        # Messages are never longer than an eighth of a term, as in Aeron.
+        self.max_message = min(options.max_message, options.term_length // 8 - L_AERON_DATA)
+        self.fill = bytearray(self.rng.getrandbits(8) for _ in range(self.max_message + 64))
+        self.streams = []
+        receiver = (options.receiver, options.port)
+        for session in range(options.sessions):
+            publisher = ('10.0.0.%d' % (1 + (session % 250)), 50000 + session)
+            session_id = self.rng.getrandbits(32)
+            for stream in range(options.streams):
+                self.streams.append(Stream(session_id, options.first_stream_id + stream, publisher, receiver,
+                    options.term_length, self.rng.getrandbits(31)))
+
+    def emit(self, src, dst, payload):
+        '''Write one UDP datagram from src to dst ((address, port) tuples).'''
+        udp_length = 8 + len(payload)
+        ip = bytearray(struct.pack('!BBHHHBBH4s4s', 0x45, 0, 20 + udp_length, self.ip_id, 0x4000, 64, 17, 0,
+            bytes(bytearray(int(x) for x in src[0].split('.'))), bytes(bytearray(int(x) for x in dst[0].split('.')))))
+        struct.pack_into('!H', ip, 10, ip_checksum(bytes(ip)))
+        self.ip_id = (self.ip_id + 1) & 0xffff
+        frame = (b'\x00\x11\x22\x33\x44\x55\x00\x66\x77\x88\x99\xaa\x08\x00' + bytes(ip)
+            + struct.pack('!HHHH', src[1], dst[1], udp_length, 0) + payload)
+        self.writer.write(self.ts_usec, frame)
+        self.ts_usec += self.ts_step
+        self.packets += 1
+
+    # Aeron frames
+
+    def setup(self, stream):
+        sm = struct.pack('<BBHIIIIII', 0, STATUS_FLAGS_SETUP, HDR_TYPE_SM, L_AERON_SM, stream.session_id, stream.stream_id,
+            stream.term_id, stream.term_offset, self.options.window)
+        self.emit(stream.receiver, stream.publisher, sm)
+        setup = struct.pack('<BBHIIIIIIII', 0, 0, HDR_TYPE_SETUP, L_AERON_SETUP, stream.term_offset, stream.session_id,
+            stream.stream_id, stream.initial_term_id, stream.term_id, stream.term_length, self.options.mtu)
+        self.emit(stream.publisher, stream.receiver, setup)
+
+    def status(self, stream):
+        # The receiver has consumed up to the first frame it is still missing.
+        if stream.lost:
+            term_id, term_offset = stream.lost[0][0], stream.lost[0][1]
+        else:
+            term_id, term_offset = stream.term_id, stream.term_offset
+        sm = struct.pack('<BBHIIIIII', 0, 0, HDR_TYPE_SM, L_AERON_SM, stream.session_id, stream.stream_id,
+            term_id & 0xffffffff, term_offset, self.options.window)
+        self.emit(stream.receiver, stream.publisher, sm)
+
+    def nak(self, stream):
+        '''NAK the first run of contiguous lost frames, then (optionally) retransmit them.'''
+        first = stream.lost[0]
+        run = [first]
+        for entry in stream.lost[1:]:
+            last = run[-1]
+            if entry[0] != first[0] or entry[1] != last[1] + last[2]:
+                break
+            run.append(entry)
+        length = run[-1][1] + run[-1][2] - first[1]
+        nak = struct.pack('<BBHIIIIII', 0, 0, HDR_TYPE_NAK, L_AERON_NAK, stream.session_id, stream.stream_id,
+            first[0] & 0xffffffff, first[1], length)
+        self.emit(stream.receiver, stream.publisher, nak)
+        del stream.lost[:len(run)]
+        if self.options.retransmit:
+            for entry in run:
+                self.emit(stream.publisher, stream.receiver, entry[3])
+        stream.frames_since_loss = 0
+
+    def data(self, stream, frame, aligned_length):
+        '''Send a DATA frame, applying loss and reordering.'''
+        options = self.options
+        draw = self.rng.random()
+        if stream.burst_left > 0 or draw < options.loss:
+            if stream.burst_left == 0:
+                stream.burst_left = options.burst
+            stream.burst_left -= 1
+            stream.lost.append((stream.term_id, stream.term_offset, aligned_length, frame))
+        elif draw < options.loss + options.reorder and stream.held is None:
+            stream.held = frame
+        else:
+            self.emit(stream.publisher, stream.receiver, frame)
+            if stream.held is not None:
+                self.emit(stream.publisher, stream.receiver, stream.held)
+                stream.held = None
+        stream.term_offset += aligned_length
+        stream.data_frames += 1
+        # The receiver notices a burst once it is over, and NAKs it as a whole.
+        if stream.lost and stream.burst_left == 0:
+            stream.frames_since_loss += 1
+            if stream.frames_since_loss >= options.nak_delay:
+                self.nak(stream)
+        if stream.data_frames % options.sm_interval == 0:
+            self.status(stream)
+
+    def rotate(self, stream):
+        '''Pad out the rest of the term, and move on to the next one.'''
+        if stream.term_offset < stream.term_length:
+            pad = struct.pack('<BBHIIIII', 0, 0, HDR_TYPE_PAD, stream.term_length - stream.term_offset, stream.term_offset,
+                stream.session_id, stream.stream_id, stream.term_id & 0xffffffff)
+            self.emit(stream.publisher, stream.receiver, pad)
+        stream.term_id += 1
+        stream.term_offset = 0
+
+    def message(self, stream):
+        options = self.options
+        if self.rng.random() < options.fragment_ratio and self.max_message > self.max_payload:
+            length = self.rng.randint(self.max_payload + 1, self.max_message)
+        else:
+            length = self.rng.randint(min(options.min_message, self.max_payload), min(options.max_message, self.max_payload))
+        start = self.rng.randint(0, 63)
+        if options.raw_payload or length < L_AERONDATA_HEADER:
+            payload = bytes(self.fill[start:start + length])
+        else:
+            body = bytes(self.fill[start:start + length - L_AERONDATA_HEADER])
+            payload = struct.pack('<III', AERONDATA_MAGIC, zlib.crc32(body) & 0xffffffff, stream.sqn) + body
+        stream.sqn = (stream.sqn + 1) & 0xffffffff
+
+        fragments = [payload[ofs:ofs + self.max_payload] for ofs in range(0, len(payload), self.max_payload)]
+        required = sum(align(L_AERON_DATA + len(fragment)) for fragment in fragments)
+        if stream.term_offset + required > stream.term_length:
+            self.rotate(stream)
+        for idx, fragment in enumerate(fragments):
+            flags = (DATA_FLAGS_BEGIN if idx == 0 else 0) | (DATA_FLAGS_END if idx == len(fragments) - 1 else 0)
+            frame_length = L_AERON_DATA + len(fragment)
+            aligned_length = align(frame_length)
+            frame = struct.pack('<BBHIIIII', 0, flags, HDR_TYPE_DATA, frame_length, stream.term_offset, stream.session_id,
+                stream.stream_id, stream.term_id & 0xffffffff) + fragment + (b'\0' * (aligned_length - frame_length))
+            self.data(stream, frame, aligned_length)
+
+    def run(self):
+        options = self.options
+        for stream in self.streams:
+            self.setup(stream)
+        count = 0
+        while count < options.messages and (options.max_bytes == 0 or self.writer.bytes_written < options.max_bytes):
+            self.message(self.streams[self.rng.randrange(len(self.streams))])
+            count += 1
+        # Flush anything still held back or waiting for a NAK, so every stream ends complete.
+        for stream in self.streams:
+            if stream.held is not None:
+                self.emit(stream.publisher, stream.receiver, stream.held)
+                stream.held = None
+            while stream.lost:
+                self.nak(stream)
+            self.status(stream)
+        return count
+
+def parse_size(option, opt_str, value, parser):
+    multiplier = 1
+    suffixes = {'k': 1 << 10, 'm': 1 << 20, 'g': 1 << 30}
+    if value and value[-1].lower() in suffixes:
+        multiplier = suffixes[value[-1].lower()]
+        value = value[:-1]
+    setattr(parser.values, option.dest, int(value) * multiplier)
+
+def main():
+    parser = OptionParser(usage='%prog [options] -o FILE')
+    parser.add_option('-o', '--output', dest='output', help='output capture file')
+    parser.add_option('--pcap', dest='pcapng', action='store_false', default=True, help='write pcap instead of pcapng')
+    parser.add_option('--seed', dest='seed', type='int', default=1, help='random seed (default %default)')
+    parser.add_option('--sessions', dest='sessions', type='int', default=1, help='number of publisher sessions (default %default)')
+    parser.add_option('--streams', dest='streams', type='int', default=1, help='number of streams per session (default %default)')
+    parser.add_option('--first-stream-id', dest='first_stream_id', type='int', default=1, help='first stream ID (default %default)')
+    parser.add_option('--messages', dest='messages', type='int', default=100000, help='number of messages (default %default)')
+    parser.add_option('--max-bytes', dest='max_bytes', type='string', action='callback', callback=parse_size, default=0,
+        help='stop once the file reaches this size (k, m and g suffixes allowed)')
+    parser.add_option('--term-length', dest='term_length', type='int', default=65536, help='term length (default %default)')
+    parser.add_option('--mtu', dest='mtu', type='int', default=1408, help='MTU, including the DATA header (default %default)')
+    parser.add_option('--min-message', dest='min_message', type='int', default=32, help='minimum unfragmented message length (default %default)')
+    parser.add_option('--max-message', dest='max_message', type='int', default=8192, help='maximum message length (default %default)')
+    parser.add_option('--fragment-ratio', dest='fragment_ratio', type='float', default=0.1,
+        help='fraction of messages longer than the MTU, and so fragmented (default %default)')
+    parser.add_option('--loss', dest='loss', type='float', default=0.0,
+        help='fraction of DATA frames lost, each starting a burst of --burst frames (default %default)')
+    parser.add_option('--burst', dest='burst', type='int', default=1,
+        help='consecutive DATA frames of a stream lost at each loss (default %default)')
+    parser.add_option('--reorder', dest='reorder', type='float', default=0.0,
+        help='fraction of DATA frames sent after the following frame (default %default)')
+    parser.add_option('--nak-delay', dest='nak_delay', type='int', default=4,
+        help='DATA frames sent on a stream between a loss and its NAK (default %default)')
+    parser.add_option('--no-retransmit', dest='retransmit', action='store_false', default=True,
+        help="don't retransmit NAKed frames")
+    parser.add_option('--sm-interval', dest='sm_interval', type='int', default=16,
+        help='DATA frames per stream between status messages (default %default)')
+    parser.add_option('--window', dest='window', type='int', default=131072, help='receiver window (default %default)')
+    parser.add_option('--receiver', dest='receiver', default='10.0.1.1', help='receiver address (default %default)')
+    parser.add_option('--port', dest='port', type='int', default=40123, help='receiver UDP port (default %default)')
+    parser.add_option('--rate', dest='rate', type='float', default=100000.0, help='packets per second, for timestamps (default %default)')
+    parser.add_option('--raw-payload', dest='raw_payload', action='store_true', default=False,
+        help='fill messages with random bytes instead of aerondata messages')
+    (options, args) = parser.parse_args()
+
+    if options.output is None or args:
+        parser.error('an output file (and nothing else) must be given')
+    if options.mtu % 8 != 0 or options.mtu <= L_AERON_DATA or options.mtu > 65000:
+        parser.error('the MTU must be a multiple of 8, between %d and 65000' % (L_AERON_DATA + 8))
+    if options.term_length < 65536 or options.term_length & (options.term_length - 1):
+        parser.error('the term length must be a power of 2, at least 65536')
+    if options.sessions < 1 or options.streams < 1 or options.sm_interval < 1 or options.nak_delay < 1 or options.burst < 1:
+        parser.error('sessions, streams, SM interval, NAK delay and burst length must be at least 1')
+    if options.min_message < 1 or options.min_message > options.max_message:
+        parser.error('the minimum message length must be between 1 and the maximum message length')
+    if options.loss + options.reorder >= 1.0 or options.loss < 0.0 or options.reorder < 0.0:
+        parser.error('loss and reorder rates must be non-negative, and add up to less than 1')
+
+    writer = CaptureWriter(options.output, options.pcapng)
+    generator = Generator(options, writer)
+    messages = generator.run()
+    writer.close()
+    print('%s: %d messages, %d packets, %d bytes' % (options.output, messages, generator.packets, writer.bytes_written), file=sys.stderr)
+
+if __name__ == '__main__':
+    main()
+
+#
+# Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+#
+# Local variables:
+# c-basic-offset: 4
+# indent-tabs-mode: nil
+# End:
+#
+# vi: set shiftwidth=4 expandtab:
+# :indentSize=4:noTabs=true:
+#
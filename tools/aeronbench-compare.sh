@@ -0,0 +1,145 @@
+#!/bin/bash
+#
+# Builds aeronbench, from the aeronbench.c of this working tree, in two
+# revisions of Wireshark and compares their results, for instance before
+# and after a change to the Aeron analysis:
+#
+#   tools/aeronbench-compare.sh 0e93f2d^ 0e93f2d -c 1000000 -y data
+#
+# The options after the revisions are passed to aeronbench. Set JOBS to
+# the number of parallel build jobs (default 4).
+#
+# Wireshark - Network traffic analyzer
+# By Gerald Combs <gerald@wireshark.org>
+# Copyright 1998 Gerald Combs
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+set -e
+
+if test $# -lt 2; then
+	echo "Usage:"
+	echo "$0 <old revision> <new revision> [aeronbench options]"
+	echo "e.g. $0 0e93f2d^ 0e93f2d -c 1000000 -y data"
+	exit 1
+fi
+
+OLD_REV=$1
+NEW_REV=$2
+shift 2
+
+cd `git rev-parse --show-toplevel`
+# we are at top level
+
+WORK_DIR=`mktemp -d "${TMPDIR:-/tmp}/aeronbench-compare.XXXXXX"`
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+# Build and run aeronbench in a revision
+# $1 revision
+# $2 name of its results, $WORK_DIR/<name>.txt
+# $3... aeronbench options
+bench_revision() {
+	REV=$1
+	NAME=$2
+	shift 2
+	SRC_DIR="$WORK_DIR/$NAME/src"
+	BUILD_DIR="$WORK_DIR/$NAME/build"
+	BENCH_CFLAGS=
+
+	mkdir -p "$SRC_DIR" "$BUILD_DIR"
+	git archive $REV | tar -x -C "$SRC_DIR"
+	cp aeronbench.c "$SRC_DIR"
+
+	# Revisions from before aeronbench have no target for it, and those
+	# from before filter sets can only apply filters one by one.
+	if ! grep -q aeronbench "$SRC_DIR/CMakeLists.txt"; then
+		cat >> "$SRC_DIR/CMakeLists.txt" <<'EOF'
+
+add_executable(aeronbench EXCLUDE_FROM_ALL aeronbench.c)
+set_extra_executable_properties(aeronbench "Tests")
+target_link_libraries(aeronbench ${dftest_LIBS})
+EOF
+	fi
+	if ! grep -q dfilter_set_new "$SRC_DIR/epan/dfilter/dfilter.h"; then
+		BENCH_CFLAGS=-DAERONBENCH_NO_FILTER_SET
+	fi
+
+	echo "Building aeronbench at $REV..."
+	(cd "$BUILD_DIR" &&
+		cmake -DCMAKE_BUILD_TYPE=RelWithDebInfo -DCMAKE_C_FLAGS="$BENCH_CFLAGS" "$SRC_DIR" > build.log 2>&1 &&
+		make -j${JOBS:-4} aeronbench aeron >> build.log 2>&1) || {
+		echo "Building $REV failed; see $BUILD_DIR/build.log"
+		trap - EXIT
+		exit 1
+	}
+	WIRESHARK_RUN_FROM_BUILD_DIRECTORY=1 "$BUILD_DIR/run/aeronbench" "$@" > "$WORK_DIR/$NAME.txt"
+}
+
+bench_revision $OLD_REV old "$@"
+bench_revision $NEW_REV new "$@"
+
+echo
+echo "Old: $OLD_REV"
+cat "$WORK_DIR/old.txt"
+echo
+echo "New: $NEW_REV"
+cat "$WORK_DIR/new.txt"
+echo
+
+# Match the rows by frame type and analysis, the first 37 columns, and
+# show the new results relative to the old ones. With display filters
+# (-f or -t), the cost of applying them one by one and as a filter set is
+# shown too; a revision without filter sets reports no set cost ("-").
+awk '
+	function cost(ns) { return ns > 0 ? sprintf("%7.1f", ns) : sprintf("%7s", "-") }
+	FNR == 1 { table = 0 }
+	/^Frame type/ { table = 1; next }
+	!table || NF == 0 { next }
+	{
+		key = substr($0, 1, 37)
+		n = split(substr($0, 38), field, " ")
+		if (FILENAME == ARGV[1]) {
+			old_ns[key] = field[1]; old_bytes[key] = field[3]; old_file[key] = field[4]
+			old_filter[key] = field[5]; old_set[key] = field[6]
+			next
+		}
+		if (!(key in old_ns))
+			next
+		if (!header++) {
+			printf("%-37s %17s %17s %17s", "Frame type and analysis", "ns/frame", "bytes/frame", "file bytes")
+			if (n > 4)
+				printf(" %17s %17s", "filter ns", "set ns")
+			printf("\n")
+		}
+		printf("%-37s %7.1f -> %6.1f %7.1f -> %6.1f %7.1f -> %6.1f", key,
+		       old_ns[key], field[1], old_bytes[key], field[3], old_file[key], field[4])
+		if (n > 4)
+			printf(" %7.1f -> %6.1f %s -> %6s", old_filter[key], field[5], cost(old_set[key]), cost(field[6]))
+		printf("\n")
+	}
+' "$WORK_DIR/old.txt" "$WORK_DIR/new.txt"
+
+#
+# Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+#
+# Local variables:
+# c-basic-offset: 8
+# tab-width: 8
+# indent-tabs-mode: t
+# End:
+#
+# vi: set shiftwidth=8 tabstop=8 noexpandtab:
+# :indentSize=8:tabSize=8:noTabs=false:
+#
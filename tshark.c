@@ -342,6 +342,8 @@ print_usage(FILE *output)
   fprintf(output, "  -R <read filter>         packet Read filter in Wireshark display filter syntax\n");
   fprintf(output, "  -Y <display filter>      packet displaY filter in Wireshark display filter\n");
   fprintf(output, "                           syntax\n");
+  fprintf(output, "  --filter-depth           with -R/-Y and no packet output, stop dissecting\n");
+  fprintf(output, "                           packets below the protocols the filters use\n");
   fprintf(output, "  -n                       disable all name resolutions (def: all enabled)\n");
   fprintf(output, "  -N <name resolve flags>  enable specific name resolution(s): \"mntC\"\n");
   fprintf(output, "  -d %s ...\n", decode_as_arg_template);
@@ -942,6 +944,9 @@ get_tshark_runtime_version_info(GString *str)
     epan_get_runtime_version_info(str);
 }
 
+/* Long options not shared with the capture options */
+#define LONGOPT_FILTER_DEPTH  MIN_NON_CAPTURE_LONGOPT
+
 int
 main(int argc, char *argv[])
 {
@@ -953,6 +958,7 @@ DIAG_OFF(cast-qual)
   static const struct option long_options[] = {
     {(char *)"help", no_argument, NULL, 'h'},
     {(char *)"version", no_argument, NULL, 'v'},
+    {(char *)"filter-depth", no_argument, NULL, LONGOPT_FILTER_DEPTH},
     LONGOPT_CAPTURE_COMMON
     {0, 0, 0, 0 }
   };
@@ -996,6 +1002,7 @@ DIAG_ON(cast-qual)
 #endif
   dfilter_t           *rfcode = NULL;
   dfilter_t           *dfcode = NULL;
+  gboolean             filter_depth = FALSE;
   gchar               *err_msg;
   e_prefs             *prefs_p;
   char                 badopt;
@@ -1675,6 +1682,9 @@ DIAG_ON(cast-qual)
     case 'Y':
       dfilter = optarg;
       break;
+    case LONGOPT_FILTER_DEPTH:
+      filter_depth = TRUE;
+      break;
     case 'z':
       /* We won't call the init function for the stat this soon
          as it would disallow MATE's fields (which are registered
@@ -2079,6 +2089,25 @@ DIAG_ON(cast-qual)
   }
   cfile.dfcode = dfcode;
 
+  if (filter_depth) {
+    /* Only the filters and the taps look at the dissection, so the
+       dissectors below the protocols they use needn't be called. */
+    GArray *protos = g_array_new(FALSE, FALSE, sizeof(int));
+
+    if (print_packet_info) {
+      cmdarg_err("--filter-depth is ignored when packets are printed.");
+    } else if (!rfcode && !dfcode) {
+      cmdarg_err("--filter-depth is ignored without a read or display filter.");
+    } else if ((rfcode && !dfilter_needed_protocols(rfcode, protos)) ||
+               (dfcode && !dfilter_needed_protocols(dfcode, protos)) ||
+               !tap_listeners_needed_protocols(protos)) {
+      cmdarg_err("--filter-depth is ignored; the filters or taps need the full dissection.");
+    } else {
+      set_dissection_depth_protocols((const int *)protos->data, protos->len);
+    }
+    g_array_free(protos, TRUE);
+  }
+
   if (print_packet_info) {
     /* If we're printing as text or PostScript, we have
        to create a print stream. */
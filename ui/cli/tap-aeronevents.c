@@ -0,0 +1,316 @@
+/* tap-aeronevents.c
+ * Aeron per-stream analysis event summary
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Counts the stream analysis conditions which the Aeron dissector reports
+ * as expert info (window full, idle and pacing RX, out of order, keepalives,
+ * term ID changes, ...) per stream and, optionally, per time interval. The
+ * counts come straight from the analysis flags in the tap information, so
+ * without a filter no protocol tree or expert info is built.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <epan/packet.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <epan/to_str.h>
+#include <plugins/aeron/packet-aeron.h>
+
+void register_tap_listener_aeronevents(void);
+
+/* The stream analysis flags counted, in column order */
+static const struct {
+    guint32      flag;
+    const gchar *title;
+} aeronevents_event[] = {
+    { AERON_STREAM_ANALYSIS_FLAGS_WINDOW_FULL,    "Window Full" },
+    { AERON_STREAM_ANALYSIS_FLAGS_IDLE_RX,        "Idle RX" },
+    { AERON_STREAM_ANALYSIS_FLAGS_PACING_RX,      "Pacing RX" },
+    { AERON_STREAM_ANALYSIS_FLAGS_RX,             "RX" },
+    { AERON_STREAM_ANALYSIS_FLAGS_OOO,            "OOO" },
+    { AERON_STREAM_ANALYSIS_FLAGS_OOO_GAP,        "OOO Gap" },
+    { AERON_STREAM_ANALYSIS_FLAGS_KEEPALIVE,      "KA" },
+    { AERON_STREAM_ANALYSIS_FLAGS_OOO_SM,         "OOO SM" },
+    { AERON_STREAM_ANALYSIS_FLAGS_KEEPALIVE_SM,   "KA SM" },
+    { AERON_STREAM_ANALYSIS_FLAGS_WINDOW_RESIZE,  "Win Resize" },
+    { AERON_STREAM_ANALYSIS_FLAGS_TERM_ID_CHANGE, "Term Change" }
+};
+#define AERONEVENTS_EVENT_COUNT (sizeof(aeronevents_event) / sizeof(aeronevents_event[0]))
+
+/* Event counts for one stream, either in total or within one interval */
+typedef struct aeronevents_counts_t {
+    guint32 count[AERONEVENTS_EVENT_COUNT];
+} aeronevents_counts_t;
+
+typedef struct aeronevents_stream_t {
+    gint64                key;          /* (channel ID << 32) | stream ID */
+    guint64               channel_id;
+    guint32               session_id;
+    guint32               stream_id;
+    gchar                *transport;    /* Printable transport (address/port pairs) */
+    aeronevents_counts_t  total;
+    GHashTable           *interval;     /* aeronevents_counts_t, keyed by interval number, for the intervals with events */
+} aeronevents_stream_t;
+
+typedef struct aeronevents_t {
+    char       *filter;
+    guint64     interval;               /* Interval length in microseconds, or 0 for totals only */
+    GHashTable *streams;                /* aeronevents_stream_t, keyed by aeronevents_stream_t.key */
+    GPtrArray  *stream_order;           /* aeronevents_stream_t, in order of first appearance */
+} aeronevents_t;
+
+static void
+aeronevents_stream_free(gpointer data)
+{
+    aeronevents_stream_t *stream = (aeronevents_stream_t *)data;
+
+    g_hash_table_destroy(stream->interval);
+    g_free(stream->transport);
+    g_free(stream);
+}
+
+static void
+aeronevents_reset(void *tapdata)
+{
+    aeronevents_t *ep = (aeronevents_t *)tapdata;
+
+    g_ptr_array_set_size(ep->stream_order, 0);
+    g_hash_table_remove_all(ep->streams);
+}
+
+static aeronevents_stream_t *
+aeronevents_stream_get(aeronevents_t *ep, const aeron_tap_info_t *info)
+{
+    gint64                key = (gint64)((info->channel_id << 32) | (guint64)info->stream_id);
+    aeronevents_stream_t *stream;
+    gchar                *addr1;
+    gchar                *addr2;
+
+    stream = (aeronevents_stream_t *)g_hash_table_lookup(ep->streams, &key);
+    if (stream != NULL) {
+        return stream;
+    }
+    stream = g_new0(aeronevents_stream_t, 1);
+    stream->key = key;
+    stream->channel_id = info->channel_id;
+    stream->session_id = info->session_id;
+    stream->stream_id = info->stream_id;
+    addr1 = address_to_str(NULL, info->addr1);
+    addr2 = address_to_str(NULL, info->addr2);
+    stream->transport = g_strdup_printf("%s:%u-%s:%u", addr1, info->port1, addr2, info->port2);
+    wmem_free(NULL, addr1);
+    wmem_free(NULL, addr2);
+    stream->interval = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+    g_hash_table_insert(ep->streams, &(stream->key), stream);
+    g_ptr_array_add(ep->stream_order, stream);
+    return stream;
+}
+
+static int
+aeronevents_packet(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _U_, const void *data)
+{
+    aeronevents_t          *ep   = (aeronevents_t *)tapdata;
+    const aeron_tap_info_t *info = (const aeron_tap_info_t *)data;
+    aeronevents_stream_t   *stream;
+    aeronevents_counts_t   *counts = NULL;
+    guint                   idx;
+
+    if (info->stream_analysis_flags == 0) {
+        return 0;
+    }
+    stream = aeronevents_stream_get(ep, info);
+    if ((ep->interval > 0) && (pinfo->rel_ts.secs >= 0)) {
+        guint64 relative_time = ((guint64)pinfo->rel_ts.secs * G_GUINT64_CONSTANT(1000000)) +
+                                ((guint64)((pinfo->rel_ts.nsecs + 500) / 1000));
+        guint   interval_idx  = (guint)(relative_time / ep->interval);
+
+        counts = (aeronevents_counts_t *)g_hash_table_lookup(stream->interval, GUINT_TO_POINTER(interval_idx));
+        if (counts == NULL) {
+            counts = g_new0(aeronevents_counts_t, 1);
+            g_hash_table_insert(stream->interval, GUINT_TO_POINTER(interval_idx), counts);
+        }
+    }
+    for (idx = 0; idx < AERONEVENTS_EVENT_COUNT; idx++) {
+        if ((info->stream_analysis_flags & aeronevents_event[idx].flag) != 0) {
+            stream->total.count[idx]++;
+            if (counts != NULL) {
+                counts->count[idx]++;
+            }
+        }
+    }
+    return 1;
+}
+
+static void
+aeronevents_print_counts(const char *label, const aeronevents_counts_t *counts)
+{
+    guint idx;
+
+    printf("%-28s", label);
+    for (idx = 0; idx < AERONEVENTS_EVENT_COUNT; idx++) {
+        printf(" %11u", counts->count[idx]);
+    }
+    printf("\n");
+}
+
+static gint
+aeronevents_interval_compare(gconstpointer a, gconstpointer b)
+{
+    guint interval_a = GPOINTER_TO_UINT(a);
+    guint interval_b = GPOINTER_TO_UINT(b);
+
+    return (interval_a < interval_b) ? -1 : (interval_a > interval_b);
+}
+
+static void
+aeronevents_draw(void *tapdata)
+{
+    aeronevents_t *ep = (aeronevents_t *)tapdata;
+    guint          idx;
+
+    printf("\n");
+    printf("==================================================================================================================================================\n");
+    printf("Aeron Stream Analysis Events:\n");
+    if (ep->interval > 0) {
+        printf("Interval: %.3f secs\n", (double)ep->interval / 1000000.0);
+    }
+    printf("Filter: %s\n", ep->filter ? ep->filter : "<none>");
+    printf("%-28s", "");
+    for (idx = 0; idx < AERONEVENTS_EVENT_COUNT; idx++) {
+        printf(" %11s", aeronevents_event[idx].title);
+    }
+    printf("\n");
+    for (idx = 0; idx < ep->stream_order->len; idx++) {
+        aeronevents_stream_t *stream = (aeronevents_stream_t *)g_ptr_array_index(ep->stream_order, idx);
+        gchar                 label[64];
+        GList                *intervals;
+        GList                *node;
+
+        printf("Channel %" G_GINT64_MODIFIER "u, session 0x%08x, stream 0x%08x (%s)\n",
+               stream->channel_id, stream->session_id, stream->stream_id, stream->transport);
+        aeronevents_print_counts("  Total", &(stream->total));
+        intervals = g_list_sort(g_hash_table_get_keys(stream->interval), aeronevents_interval_compare);
+        for (node = intervals; node != NULL; node = g_list_next(node)) {
+            guint                       interval_idx = GPOINTER_TO_UINT(node->data);
+            const aeronevents_counts_t *counts = (const aeronevents_counts_t *)g_hash_table_lookup(stream->interval, node->data);
+            double                      start  = ((double)interval_idx * (double)ep->interval) / 1000000.0;
+            guint                       event;
+
+            /* Only list the intervals in which a counted event happened */
+            for (event = 0; event < AERONEVENTS_EVENT_COUNT; event++) {
+                if (counts->count[event] != 0) {
+                    break;
+                }
+            }
+            if (event == AERONEVENTS_EVENT_COUNT) {
+                continue;
+            }
+            g_snprintf(label, sizeof(label), "  %10.3f-%-10.3f", start, start + ((double)ep->interval / 1000000.0));
+            aeronevents_print_counts(label, counts);
+        }
+        g_list_free(intervals);
+    }
+    printf("==================================================================================================================================================\n");
+}
+
+static void
+aeronevents_init(const char *opt_arg, void *userdata _U_)
+{
+    aeronevents_t *ep;
+    const char    *filter = NULL;
+    double         interval = 0.0;
+    GString       *error_string;
+    int            idx = 0;
+
+    if (strncmp(opt_arg, "aeron,events,", 13) == 0) {
+        if (sscanf(opt_arg, "aeron,events,%lf%n", &interval, &idx) != 1) {
+            fprintf(stderr, "\ntshark: invalid \"-z aeron,events[,<interval>[,<filter>]]\" argument\n");
+            exit(1);
+        }
+        if (interval < 0.0) {
+            fprintf(stderr, "\ntshark: \"-z aeron,events\" interval must be >= 0 seconds\n");
+            exit(1);
+        }
+        if (opt_arg[idx] == ',') {
+            filter = opt_arg + idx + 1;
+        }
+        else if (opt_arg[idx] != '\0') {
+            fprintf(stderr, "\ntshark: invalid \"-z aeron,events[,<interval>[,<filter>]]\" argument\n");
+            exit(1);
+        }
+    }
+
+    ep = g_new0(aeronevents_t, 1);
+    ep->filter = g_strdup(filter);
+    ep->interval = (guint64)((interval * 1000000.0) + 0.5);
+    ep->streams = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL, aeronevents_stream_free);
+    ep->stream_order = g_ptr_array_new();
+
+    error_string = register_tap_listener("aeron", ep, filter, TL_REQUIRES_NOTHING,
+                                         aeronevents_reset,
+                                         aeronevents_packet,
+                                         aeronevents_draw);
+    if (error_string) {
+        /* error, we failed to attach to the tap. clean up */
+        g_ptr_array_free(ep->stream_order, TRUE);
+        g_hash_table_destroy(ep->streams);
+        g_free(ep->filter);
+        g_free(ep);
+        fprintf(stderr, "tshark: Couldn't register aeron,events tap: %s\n",
+                error_string->str);
+        g_string_free(error_string, TRUE);
+        exit(1);
+    }
+}
+
+static stat_tap_ui aeronevents_ui = {
+    REGISTER_STAT_GROUP_GENERIC,
+    NULL,
+    "aeron,events",
+    aeronevents_init,
+    0,
+    NULL
+};
+
+void
+register_tap_listener_aeronevents(void)
+{
+    register_stat_tap_ui(&aeronevents_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
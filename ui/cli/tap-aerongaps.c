@@ -0,0 +1,270 @@
+/* tap-aerongaps.c
+ * Aeron loss and gap report
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Writes one record per term-offset gap, NAK and retransmission to a file
+ * as each frame is dissected, so the report itself does not grow with the
+ * capture. The records go to a file rather than stdout so that they are
+ * never mixed with tshark's packet output. Retransmission records carry
+ * the NAK(s) they answer, along with the number of bytes of each NAK
+ * still unrecovered after this retransmission; the last such record for
+ * a NAK gives its final unrecovered length.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <epan/packet.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <plugins/aeron/packet-aeron.h>
+
+#include <wsutil/file_util.h>
+
+void register_tap_listener_aerongaps(void);
+
+typedef enum {
+    AERONGAPS_FORMAT_CSV,
+    AERONGAPS_FORMAT_JSON
+} aerongaps_format_t;
+
+typedef struct aerongaps_t {
+    char               *filter;
+    char               *file_name;
+    FILE               *out;
+    aerongaps_format_t  format;
+    gboolean            header_written;
+    guint32             gap_records;
+    guint32             nak_records;
+    guint32             rx_records;
+} aerongaps_t;
+
+static void
+aerongaps_reset(void *tapdata)
+{
+    aerongaps_t *gp = (aerongaps_t *)tapdata;
+
+    gp->gap_records = 0;
+    gp->nak_records = 0;
+    gp->rx_records = 0;
+}
+
+static void
+aerongaps_write(aerongaps_t *gp, const char *record, const packet_info *pinfo, const aeron_tap_info_t *info,
+                guint32 term_id, guint32 term_offset, guint32 length, const guint32 *nak_frame, const guint32 *unrecovered)
+{
+    const nstime_t *ts = &(pinfo->fd->abs_ts);
+
+    if (gp->format == AERONGAPS_FORMAT_JSON) {
+        fprintf(gp->out, "{\"record\":\"%s\",\"frame\":%u,\"time\":%lu.%09d,\"channel_id\":%" G_GINT64_MODIFIER "u,"
+               "\"session_id\":%u,\"stream_id\":%u,\"term_id\":%u,\"term_offset\":%u,\"length\":%u",
+               record, pinfo->fd->num, (unsigned long)ts->secs, ts->nsecs, info->channel_id,
+               info->session_id, info->stream_id, term_id, term_offset, length);
+        if (nak_frame != NULL) {
+            fprintf(gp->out, ",\"nak_frame\":%u", *nak_frame);
+        }
+        if (unrecovered != NULL) {
+            fprintf(gp->out, ",\"unrecovered\":%u", *unrecovered);
+        }
+        fprintf(gp->out, "}\n");
+        return;
+    }
+
+    if (!gp->header_written) {
+        fprintf(gp->out, "record,frame,time,channel_id,session_id,stream_id,term_id,term_offset,length,nak_frame,unrecovered\n");
+        gp->header_written = TRUE;
+    }
+    fprintf(gp->out, "%s,%u,%lu.%09d,%" G_GINT64_MODIFIER "u,%u,%u,%u,%u,%u,",
+           record, pinfo->fd->num, (unsigned long)ts->secs, ts->nsecs, info->channel_id,
+           info->session_id, info->stream_id, term_id, term_offset, length);
+    if (nak_frame != NULL) {
+        fprintf(gp->out, "%u", *nak_frame);
+    }
+    fprintf(gp->out, ",");
+    if (unrecovered != NULL) {
+        fprintf(gp->out, "%u", *unrecovered);
+    }
+    fprintf(gp->out, "\n");
+}
+
+static int
+aerongaps_packet(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _U_, const void *data)
+{
+    aerongaps_t            *gp   = (aerongaps_t *)tapdata;
+    const aeron_tap_info_t *info = (const aeron_tap_info_t *)data;
+    guint32                 idx;
+
+    switch (info->type) {
+        case HDR_TYPE_PAD:
+        case HDR_TYPE_DATA:
+            if ((info->stream_analysis_flags & AERON_STREAM_ANALYSIS_FLAGS_OOO_GAP) != 0) {
+                /* The gap runs from the previous high position up to this frame */
+                aerongaps_write(gp, "gap", pinfo, info, info->gap_term_id, info->gap_term_offset, info->gap_length, NULL, NULL);
+                gp->gap_records++;
+            }
+            if ((info->frame_flags & AERON_FRAME_INFO_FLAGS_RETRANSMISSION) == 0) {
+                break;
+            }
+            if ((info->frame_flags & AERON_FRAME_INFO_FLAGS_KEEPALIVE) != 0) {
+                break;
+            }
+            if (info->rx_nak_count == 0) {
+                aerongaps_write(gp, "rx", pinfo, info, info->term_id, info->term_offset, info->length, NULL, NULL);
+                gp->rx_records++;
+            }
+            for (idx = 0; idx < info->rx_nak_count; idx++) {
+                aerongaps_write(gp, "rx", pinfo, info, info->term_id, info->term_offset, info->length,
+                                &(info->rx_nak_frame[idx]), &(info->rx_nak_unrecovered[idx]));
+                gp->rx_records++;
+            }
+            break;
+        case HDR_TYPE_NAK:
+            aerongaps_write(gp, "nak", pinfo, info, info->term_id, info->term_offset, info->length, NULL, &(info->nak_unrecovered));
+            gp->nak_records++;
+            break;
+        default:
+            break;
+    }
+    /* Nothing is drawn from the accumulated state, so never ask for a redraw */
+    return 0;
+}
+
+static void
+aerongaps_draw(void *tapdata)
+{
+    aerongaps_t *gp = (aerongaps_t *)tapdata;
+
+    /* Records have already been written; only summarise them */
+    if (gp->out != NULL) {
+        if (fclose(gp->out) != 0) {
+            fprintf(stderr, "tshark: Error writing aeron,gaps records to \"%s\": %s\n", gp->file_name, g_strerror(errno));
+        }
+        gp->out = NULL;
+    }
+    printf("\n");
+    printf("Aeron gaps: %u gap, %u NAK, %u RX records written to %s\n", gp->gap_records, gp->nak_records, gp->rx_records, gp->file_name);
+}
+
+static void
+aerongaps_init(const char *opt_arg, void *userdata _U_)
+{
+    aerongaps_t        *gp;
+    const char         *args;
+    const char         *filter = NULL;
+    const char         *comma;
+    char               *file_name;
+    FILE               *out;
+    aerongaps_format_t  format = AERONGAPS_FORMAT_CSV;
+    GString            *error_string;
+
+    /* aeron,gaps[,csv|json],<file>[,<filter>] */
+    if (strncmp(opt_arg, "aeron,gaps,", 11) != 0) {
+        fprintf(stderr, "tshark: aeron,gaps needs an output file: -z aeron,gaps[,csv|json],<file>[,<filter>]\n");
+        exit(1);
+    }
+    args = opt_arg + 11;
+    if ((strcmp(args, "csv") == 0) || (strcmp(args, "json") == 0)) {
+        /* A format, but no file to write it to */
+        fprintf(stderr, "tshark: aeron,gaps,%s needs an output file: -z aeron,gaps[,csv|json],<file>[,<filter>]\n", args);
+        exit(1);
+    }
+    if (strncmp(args, "csv,", 4) == 0) {
+        args += 4;
+    } else if (strncmp(args, "json,", 5) == 0) {
+        format = AERONGAPS_FORMAT_JSON;
+        args += 5;
+    }
+    comma = strchr(args, ',');
+    if (comma != NULL) {
+        file_name = g_strndup(args, comma - args);
+        if (comma[1] != '\0') {
+            filter = comma + 1;
+        }
+    } else {
+        file_name = g_strdup(args);
+    }
+    if (*file_name == '\0') {
+        fprintf(stderr, "tshark: aeron,gaps needs an output file: -z aeron,gaps[,csv|json],<file>[,<filter>]\n");
+        g_free(file_name);
+        exit(1);
+    }
+    out = ws_fopen(file_name, "w");
+    if (out == NULL) {
+        fprintf(stderr, "tshark: Couldn't open \"%s\" for the aeron,gaps records: %s\n", file_name, g_strerror(errno));
+        g_free(file_name);
+        exit(1);
+    }
+
+    gp = g_new0(aerongaps_t, 1);
+    gp->filter = g_strdup(filter);
+    gp->file_name = file_name;
+    gp->out = out;
+    gp->format = format;
+
+    error_string = register_tap_listener("aeron", gp, filter, TL_REQUIRES_NOTHING,
+                                         aerongaps_reset,
+                                         aerongaps_packet,
+                                         aerongaps_draw);
+    if (error_string) {
+        /* error, we failed to attach to the tap. clean up */
+        fclose(gp->out);
+        g_free(gp->file_name);
+        g_free(gp->filter);
+        g_free(gp);
+        fprintf(stderr, "tshark: Couldn't register aeron,gaps tap: %s\n",
+                error_string->str);
+        g_string_free(error_string, TRUE);
+        exit(1);
+    }
+}
+
+static stat_tap_ui aerongaps_ui = {
+    REGISTER_STAT_GROUP_GENERIC,
+    NULL,
+    "aeron,gaps",
+    aerongaps_init,
+    0,
+    NULL
+};
+
+void
+register_tap_listener_aerongaps(void)
+{
+    register_stat_tap_ui(&aerongaps_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,459 @@
+/* tap-aeronstat.c
+ * Aeron per-stream statistics
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <epan/packet.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+#include <epan/to_str.h>
+#include <plugins/aeron/packet-aeron.h>
+
+void register_tap_listener_aeronstat(void);
+
+/*
+ * Receiver lag histogram. Lags are counted in nanoseconds in log-scale
+ * buckets: values below AERONSTAT_LAG_SUB_BUCKETS have a bucket each, and
+ * every power of two above is split into AERONSTAT_LAG_SUB_BUCKETS buckets,
+ * so a percentile is within about 3% of the true sample. Lags of
+ * 2^AERONSTAT_LAG_MAX_SHIFT ns (about 18 minutes) and above share the last
+ * bucket.
+ */
+#define AERONSTAT_LAG_SUB_SHIFT     4
+#define AERONSTAT_LAG_SUB_BUCKETS   (1 << AERONSTAT_LAG_SUB_SHIFT)
+#define AERONSTAT_LAG_MAX_SHIFT     40
+#define AERONSTAT_LAG_BUCKETS       ((AERONSTAT_LAG_MAX_SHIFT - AERONSTAT_LAG_SUB_SHIFT + 1) * AERONSTAT_LAG_SUB_BUCKETS)
+
+typedef struct aeronstat_lag_t {
+    guint64  samples;
+    guint64  min_ns;
+    guint64  max_ns;
+    guint64  buckets[AERONSTAT_LAG_BUCKETS];
+} aeronstat_lag_t;
+
+/* Statistics for a single receiver of a stream */
+typedef struct aeronstat_receiver_t {
+    gchar   *name;              /* Receiver address and port */
+    guint32  sm_frames;
+    guint32  completed_term_id; /* Completed position and window from the latest SM */
+    guint32  completed_term_offset;
+    guint32  receiver_window;
+    guint32  max_outstanding;   /* Largest outstanding byte count seen in an SM */
+    guint32  window_full;       /* SMs which found the receiver window full */
+    guint32  slowest;           /* Stream frames at which this was the slowest receiver */
+} aeronstat_receiver_t;
+
+/* Statistics for a single (transport, stream) pair */
+typedef struct aeronstat_stream_t {
+    gint64   key;               /* (channel ID << 32) | stream ID */
+    guint64  channel_id;
+    guint32  session_id;
+    guint32  stream_id;
+    gchar   *transport;         /* Printable transport (address/port pairs) */
+    guint32  frames;            /* Aeron frames of all types */
+    guint32  data_frames;       /* DATA and PAD frames */
+    guint64  data_bytes;
+    guint32  rx_frames;         /* Retransmitted DATA/PAD frames */
+    guint64  rx_bytes;
+    guint32  nak_frames;
+    guint64  nak_bytes;
+    guint32  sm_frames;
+    guint32  window_full;       /* SMs or DATA frames which found the receiver window full */
+    guint32  term_changes;
+    gboolean data_time_valid;
+    nstime_t first_data_time;
+    nstime_t last_data_time;
+    aeronstat_lag_t receiver_lag; /* Receiver lag samples from SMs */
+    guint32  evicted_terms;     /* Sums of the evictions reported by the dissector (streaming mode) */
+    guint32  evicted_fragments;
+    guint32  evicted_messages;
+    guint32  evicted_naks;
+    GHashTable *receivers;      /* aeronstat_receiver_t, keyed by name */
+    GPtrArray  *receiver_order; /* aeronstat_receiver_t, in order of first appearance */
+    guint32  max_min_outstanding; /* Largest outstanding byte count of the slowest receiver */
+} aeronstat_stream_t;
+
+typedef struct aeronstat_t {
+    char       *filter;
+    GHashTable *streams;        /* aeronstat_stream_t, keyed by aeronstat_stream_t.key */
+    GPtrArray  *stream_order;   /* aeronstat_stream_t, in order of first appearance */
+} aeronstat_t;
+
+static void
+aeronstat_receiver_free(gpointer data)
+{
+    aeronstat_receiver_t *receiver = (aeronstat_receiver_t *)data;
+
+    g_free(receiver->name);
+    g_free(receiver);
+}
+
+static void
+aeronstat_stream_free(gpointer data)
+{
+    aeronstat_stream_t *stream = (aeronstat_stream_t *)data;
+
+    g_ptr_array_free(stream->receiver_order, TRUE);
+    g_hash_table_destroy(stream->receivers);
+    g_free(stream->transport);
+    g_free(stream);
+}
+
+static void
+aeronstat_reset(void *tapdata)
+{
+    aeronstat_t *sp = (aeronstat_t *)tapdata;
+
+    g_ptr_array_set_size(sp->stream_order, 0);
+    g_hash_table_remove_all(sp->streams);
+}
+
+static void
+aeronstat_lag_add(aeronstat_lag_t *lag, const nstime_t *delta)
+{
+    guint64 ns = 0;
+    guint   idx;
+
+    /* Frames out of time order can give a negative lag; count it as 0 */
+    if ((delta->secs > 0) || ((delta->secs == 0) && (delta->nsecs > 0))) {
+        ns = ((guint64)delta->secs * 1000000000) + (guint64)delta->nsecs;
+    }
+    if ((lag->samples == 0) || (ns < lag->min_ns)) {
+        lag->min_ns = ns;
+    }
+    if (ns > lag->max_ns) {
+        lag->max_ns = ns;
+    }
+    lag->samples++;
+
+    if (ns < AERONSTAT_LAG_SUB_BUCKETS) {
+        idx = (guint)ns;
+    } else {
+        guint shift = 0;
+
+        if (ns >= ((guint64)1 << AERONSTAT_LAG_MAX_SHIFT)) {
+            ns = ((guint64)1 << AERONSTAT_LAG_MAX_SHIFT) - 1;
+        }
+        /* Shift the value down to its AERONSTAT_LAG_SUB_SHIFT + 1 most significant bits */
+        while ((ns >> shift) >= (2 * AERONSTAT_LAG_SUB_BUCKETS)) {
+            shift++;
+        }
+        idx = ((shift + 1) * AERONSTAT_LAG_SUB_BUCKETS) + (guint)((ns >> shift) - AERONSTAT_LAG_SUB_BUCKETS);
+    }
+    lag->buckets[idx]++;
+}
+
+static aeronstat_stream_t *
+aeronstat_stream_get(aeronstat_t *sp, const aeron_tap_info_t *info)
+{
+    gint64              key = (gint64)((info->channel_id << 32) | (guint64)info->stream_id);
+    aeronstat_stream_t *stream;
+    gchar              *addr1;
+    gchar              *addr2;
+
+    stream = (aeronstat_stream_t *)g_hash_table_lookup(sp->streams, &key);
+    if (stream != NULL) {
+        return stream;
+    }
+    stream = g_new0(aeronstat_stream_t, 1);
+    stream->key = key;
+    stream->channel_id = info->channel_id;
+    stream->session_id = info->session_id;
+    stream->stream_id = info->stream_id;
+    addr1 = address_to_str(NULL, info->addr1);
+    addr2 = address_to_str(NULL, info->addr2);
+    stream->receivers = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, aeronstat_receiver_free);
+    stream->receiver_order = g_ptr_array_new();
+    stream->transport = g_strdup_printf("%s:%u-%s:%u", addr1, info->port1, addr2, info->port2);
+    wmem_free(NULL, addr1);
+    wmem_free(NULL, addr2);
+    g_hash_table_insert(sp->streams, &(stream->key), stream);
+    g_ptr_array_add(sp->stream_order, stream);
+    return stream;
+}
+
+static aeronstat_receiver_t *
+aeronstat_receiver_get(aeronstat_stream_t *stream, const gchar *name)
+{
+    aeronstat_receiver_t *receiver;
+
+    receiver = (aeronstat_receiver_t *)g_hash_table_lookup(stream->receivers, name);
+    if (receiver != NULL) {
+        return receiver;
+    }
+    receiver = g_new0(aeronstat_receiver_t, 1);
+    receiver->name = g_strdup(name);
+    g_hash_table_insert(stream->receivers, receiver->name, receiver);
+    g_ptr_array_add(stream->receiver_order, receiver);
+    return receiver;
+}
+
+static int
+aeronstat_packet(void *tapdata, packet_info *pinfo, epan_dissect_t *edt _U_, const void *data)
+{
+    aeronstat_t            *sp   = (aeronstat_t *)tapdata;
+    const aeron_tap_info_t *info = (const aeron_tap_info_t *)data;
+    aeronstat_stream_t     *stream;
+
+    switch (info->type) {
+        case HDR_TYPE_PAD:
+        case HDR_TYPE_DATA:
+        case HDR_TYPE_NAK:
+        case HDR_TYPE_SM:
+        case HDR_TYPE_SETUP:
+            break;
+        default:
+            /* Error and extension frames carry no stream */
+            return 0;
+    }
+    stream = aeronstat_stream_get(sp, info);
+    stream->frames++;
+    stream->evicted_terms += info->evicted_terms;
+    stream->evicted_fragments += info->evicted_fragments;
+    stream->evicted_messages += info->evicted_messages;
+    stream->evicted_naks += info->evicted_naks;
+    switch (info->type) {
+        case HDR_TYPE_PAD:
+        case HDR_TYPE_DATA:
+            stream->data_frames++;
+            stream->data_bytes += info->length;
+            if (((info->frame_flags & AERON_FRAME_INFO_FLAGS_RETRANSMISSION) != 0)
+                || ((info->stream_analysis_flags & AERON_STREAM_ANALYSIS_FLAGS_RX) != 0)) {
+                stream->rx_frames++;
+                stream->rx_bytes += info->length;
+            }
+            if ((info->stream_analysis_flags & AERON_STREAM_ANALYSIS_FLAGS_TERM_ID_CHANGE) != 0) {
+                stream->term_changes++;
+            }
+            if (!stream->data_time_valid) {
+                stream->first_data_time = pinfo->fd->abs_ts;
+                stream->data_time_valid = TRUE;
+            }
+            stream->last_data_time = pinfo->fd->abs_ts;
+            break;
+        case HDR_TYPE_NAK:
+            stream->nak_frames++;
+            stream->nak_bytes += info->length;
+            break;
+        case HDR_TYPE_SM:
+            stream->sm_frames++;
+            if (info->receiver_lag_valid) {
+                aeronstat_lag_add(&(stream->receiver_lag), &(info->receiver_lag));
+            }
+            if (info->receiver != NULL) {
+                aeronstat_receiver_t *receiver = aeronstat_receiver_get(stream, info->receiver);
+
+                receiver->sm_frames++;
+                receiver->completed_term_id = info->term_id;
+                receiver->completed_term_offset = info->term_offset;
+                receiver->receiver_window = info->receiver_window;
+                if (info->outstanding_bytes > receiver->max_outstanding) {
+                    receiver->max_outstanding = info->outstanding_bytes;
+                }
+                if ((info->stream_analysis_flags & AERON_STREAM_ANALYSIS_FLAGS_WINDOW_FULL) != 0) {
+                    receiver->window_full++;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+    if ((info->stream_analysis_flags & AERON_STREAM_ANALYSIS_FLAGS_WINDOW_FULL) != 0) {
+        stream->window_full++;
+    }
+    if (info->slowest_receiver != NULL) {
+        aeronstat_receiver_get(stream, info->slowest_receiver)->slowest++;
+        if (info->min_outstanding_bytes > stream->max_min_outstanding) {
+            stream->max_min_outstanding = info->min_outstanding_bytes;
+        }
+    }
+    return 1;
+}
+
+/* Nearest-rank percentile of the lag samples, in milliseconds. The
+   value is the middle of the bucket holding the sample of that rank. */
+static double
+aeronstat_lag_percentile(const aeronstat_lag_t *lag, double percentile)
+{
+    guint64 rank = (guint64)((percentile / 100.0) * (double)lag->samples + 0.999999);
+    guint64 seen = 0;
+    guint64 value = lag->max_ns;
+    guint   idx;
+
+    if (rank == 0) {
+        rank = 1;
+    }
+    for (idx = 0; idx < AERONSTAT_LAG_BUCKETS; idx++) {
+        seen += lag->buckets[idx];
+        if (seen >= rank) {
+            if (idx < AERONSTAT_LAG_SUB_BUCKETS) {
+                value = idx;
+            } else {
+                guint   shift = (idx / AERONSTAT_LAG_SUB_BUCKETS) - 1;
+                guint64 low   = (guint64)(AERONSTAT_LAG_SUB_BUCKETS + (idx % AERONSTAT_LAG_SUB_BUCKETS)) << shift;
+
+                value = low + (((guint64)1 << shift) / 2);
+            }
+            break;
+        }
+    }
+    value = CLAMP(value, lag->min_ns, lag->max_ns);
+    return (double)value / 1000000.0;
+}
+
+/* Most often slowest receiver first */
+static gint
+aeronstat_compare_receiver(gconstpointer a, gconstpointer b)
+{
+    const aeronstat_receiver_t *ra = *((const aeronstat_receiver_t * const *)a);
+    const aeronstat_receiver_t *rb = *((const aeronstat_receiver_t * const *)b);
+
+    if (ra->slowest != rb->slowest) {
+        return (ra->slowest > rb->slowest) ? -1 : 1;
+    }
+    return 0;
+}
+
+static void
+aeronstat_draw(void *tapdata)
+{
+    aeronstat_t *sp = (aeronstat_t *)tapdata;
+    guint        idx;
+
+    printf("\n");
+    printf("=========================================================================================================================\n");
+    printf("Aeron Stream Statistics:\n");
+    printf("Filter: %s\n", sp->filter ? sp->filter : "<none>");
+    printf("  Channel    Session     Stream  Frames  Data Frames   Data Bytes     Mbit/s   RX Frames    RX Bytes   NAKs   NAK Bytes      SMs  Window Full\n");
+    for (idx = 0; idx < sp->stream_order->len; idx++) {
+        aeronstat_stream_t *stream = (aeronstat_stream_t *)g_ptr_array_index(sp->stream_order, idx);
+        double              mbps   = 0.0;
+
+        if (stream->data_time_valid) {
+            nstime_t duration;
+            double   seconds;
+
+            nstime_delta(&duration, &(stream->last_data_time), &(stream->first_data_time));
+            seconds = nstime_to_sec(&duration);
+            if (seconds > 0.0) {
+                mbps = ((double)stream->data_bytes * 8.0) / (seconds * 1000000.0);
+            }
+        }
+        printf("%9" G_GINT64_MODIFIER "u 0x%08x 0x%08x %7u %12u %12" G_GINT64_MODIFIER "u %10.3f %11u %11" G_GINT64_MODIFIER "u %6u %11" G_GINT64_MODIFIER "u %8u %12u\n",
+               stream->channel_id, stream->session_id, stream->stream_id, stream->frames, stream->data_frames, stream->data_bytes, mbps,
+               stream->rx_frames, stream->rx_bytes, stream->nak_frames, stream->nak_bytes, stream->sm_frames, stream->window_full);
+        printf("    Transport: %s, term changes: %u\n", stream->transport, stream->term_changes);
+        if (stream->evicted_terms > 0) {
+            printf("    Released terms: %u (%u fragments, %u messages, %u NAKs)\n",
+                   stream->evicted_terms, stream->evicted_fragments, stream->evicted_messages, stream->evicted_naks);
+        }
+        if (stream->receiver_lag.samples > 0) {
+            printf("    Receiver lag (ms): samples %" G_GINT64_MODIFIER "u, min %.3f, p50 %.3f, p99 %.3f, p99.9 %.3f, max %.3f\n",
+                   stream->receiver_lag.samples,
+                   (double)stream->receiver_lag.min_ns / 1000000.0,
+                   aeronstat_lag_percentile(&(stream->receiver_lag), 50.0),
+                   aeronstat_lag_percentile(&(stream->receiver_lag), 99.0),
+                   aeronstat_lag_percentile(&(stream->receiver_lag), 99.9),
+                   (double)stream->receiver_lag.max_ns / 1000000.0);
+        }
+        if (stream->receiver_order->len > 0) {
+            guint ridx;
+
+            g_ptr_array_sort(stream->receiver_order, aeronstat_compare_receiver);
+            printf("    Receivers: %u, max outstanding (slowest receiver): %u\n", stream->receiver_order->len, stream->max_min_outstanding);
+            printf("      Receiver                                          SMs Completed Position        Window  Max Outstanding  Window Full    Slowest\n");
+            for (ridx = 0; ridx < stream->receiver_order->len; ridx++) {
+                aeronstat_receiver_t *receiver = (aeronstat_receiver_t *)g_ptr_array_index(stream->receiver_order, ridx);
+
+                printf("      %-46s %6u 0x%08x:%-10u %10u %16u %12u %10u\n",
+                       receiver->name, receiver->sm_frames, receiver->completed_term_id, receiver->completed_term_offset,
+                       receiver->receiver_window, receiver->max_outstanding, receiver->window_full, receiver->slowest);
+            }
+        }
+    }
+    printf("=========================================================================================================================\n");
+}
+
+static void
+aeronstat_init(const char *opt_arg, void *userdata _U_)
+{
+    aeronstat_t *sp;
+    const char  *filter = NULL;
+    GString     *error_string;
+
+    if (strncmp(opt_arg, "aeron,stat,", 11) == 0) {
+        filter = opt_arg + 11;
+    }
+
+    sp = g_new0(aeronstat_t, 1);
+    sp->filter = g_strdup(filter);
+    sp->streams = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL, aeronstat_stream_free);
+    sp->stream_order = g_ptr_array_new();
+
+    error_string = register_tap_listener("aeron", sp, filter, TL_REQUIRES_NOTHING,
+                                         aeronstat_reset,
+                                         aeronstat_packet,
+                                         aeronstat_draw);
+    if (error_string) {
+        /* error, we failed to attach to the tap. clean up */
+        g_ptr_array_free(sp->stream_order, TRUE);
+        g_hash_table_destroy(sp->streams);
+        g_free(sp->filter);
+        g_free(sp);
+        fprintf(stderr, "tshark: Couldn't register aeron,stat tap: %s\n",
+                error_string->str);
+        g_string_free(error_string, TRUE);
+        exit(1);
+    }
+}
+
+static stat_tap_ui aeronstat_ui = {
+    REGISTER_STAT_GROUP_GENERIC,
+    NULL,
+    "aeron,stat",
+    aeronstat_init,
+    0,
+    NULL
+};
+
+void
+register_tap_listener_aeronstat(void)
+{
+    register_stat_tap_ui(&aeronstat_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -45,6 +45,8 @@
 #include "wsutil/file_util.h"
 #include "wsutil/tempfile.h"
 
+#include <plugins/aeron/packet-aeron.h>
+
 #ifdef SSL_PLUGIN
 #include "packet-ssl-utils.h"
 #else
@@ -59,14 +61,16 @@ typedef enum
 {
   type_TCP,
   type_UDP,
-  type_SSL
+  type_SSL,
+  type_AERON
 } type_e;
 
 typedef enum
 {
   mode_HEX,
   mode_ASCII,
-  mode_RAW
+  mode_RAW,
+  mode_FILE
 } mode_e;
 
 typedef struct
@@ -87,16 +91,68 @@ typedef struct
   /* stream chunk file */
   FILE         *filep;
   gchar        *filenamep;
+
+  /* aeron: followed session and stream */
+  guint32       session;
+  guint32       stream;
+
+  /* aeron: next term position to write, and frames received ahead of it */
+  gboolean      started;
+  guint32       baseTermId;
+  guint32       termId;
+  guint32       termOffset;
+  guint32       termLength;
+  GTree        *pendingp;
+  guint32       pendingBytes;
+
+  /* aeron: totals */
+  guint64       bytesWritten;
+  guint32       duplicates;
+  guint32       gaps;
+  guint64       gapBytes;
+
+  /* aeron: output file (file mode) */
+  FILE         *outFilep;
+  gchar        *outFilenamep;
 } follow_t;
 
+/* A DATA or PAD frame received ahead of the next term position */
+typedef struct
+{
+  gint64        position;
+  guint32       frameLength;
+  guint32       dataLength;
+  guint32       packetNum;
+  gboolean      pad;
+  guint8       *datap;
+} follow_aeron_frame_t;
+
 #define STR_FOLLOW      "follow,"
 #define STR_FOLLOW_TCP  STR_FOLLOW "tcp"
 #define STR_FOLLOW_UDP  STR_FOLLOW "udp"
 #define STR_FOLLOW_SSL  STR_FOLLOW "ssl"
+#define STR_FOLLOW_AERON STR_FOLLOW "aeron"
 
 #define STR_HEX         ",hex"
 #define STR_ASCII       ",ascii"
 #define STR_RAW         ",raw"
+#define STR_FILE        ",file"
+
+/* Aeron term positions, ordered by term ID and then term offset. Term IDs
+ * start at a random value and wrap, so they are taken relative to the first
+ * one followed, as a signed 32-bit distance; earlier terms are negative. */
+#define AERON_POSITION(fp, term_id, term_offset) \
+  ((gint64)(gint32)((term_id) - (fp)->baseTermId) * G_GINT64_CONSTANT(0x100000000) + \
+   (gint64)(term_offset))
+#define AERON_POSITION_TERM_ID(fp, position) \
+  ((fp)->baseTermId + (guint32)((guint64)(position) >> 32))
+#define AERON_POSITION_TERM_OFFSET(position) \
+  ((guint32)((guint64)(position) & G_GUINT64_CONSTANT(0xffffffff)))
+#define AERON_ALIGN(length) (((length) + 7) & ~7)
+
+/* Payload bytes held for frames received ahead of a gap, before the gap is
+ * given up on and skipped */
+#define AERON_PENDING_MAX (16 * 1024 * 1024)
 
 static void
 followExit(
@@ -117,6 +173,7 @@ followStrType(
   case type_TCP:        return "tcp";
   case type_UDP:        return "udp";
   case type_SSL:        return "ssl";
+  case type_AERON:      return "aeron";
   }
 
   g_assert_not_reached();
@@ -134,6 +191,7 @@ followStrMode(
   case mode_HEX:        return "hex";
   case mode_ASCII:      return "ascii";
   case mode_RAW:        return "raw";
+  case mode_FILE:       return "file";
   }
 
   g_assert_not_reached();
@@ -153,7 +211,13 @@ followStrFilter(
   gchar         ip0[MAX_IP6_STR_LEN];
   gchar         ip1[MAX_IP6_STR_LEN];
 
-  if (fp->index != G_MAXUINT32)
+  if (fp->type == type_AERON)
+  {
+    len = g_snprintf(filter, sizeof filter,
+                     "aeron.data.session_id eq %u and aeron.data.stream_id eq %u",
+                     fp->session, fp->stream);
+  }
+  else if (fp->index != G_MAXUINT32)
   {
     switch (fp->type)
     {
@@ -168,6 +232,8 @@ followStrFilter(
                      "%s", udpfilter);
       g_free(udpfilter);
       break;
+    case type_AERON:
+      break;
     }
   }
   else
@@ -203,6 +269,7 @@ followStrFilter(
                      verp, ip0, fp->port[0]);
       break;
     case type_SSL:
+    case type_AERON:
       break;
     }
   }
@@ -310,6 +377,15 @@ followFree(
   )
 {
   followFileClose(fp);
+  if (fp->outFilep != NULL)
+  {
+    fclose(fp->outFilep);
+  }
+  g_free(fp->outFilenamep);
+  if (fp->pendingp != NULL)
+  {
+    g_tree_destroy(fp->pendingp);
+  }
   g_free(fp);
 }
 
@@ -419,6 +495,276 @@ followSslPacket(
   return 0;
 }
 
+static gint
+followAeronCompare(
+  gconstpointer a,
+  gconstpointer b,
+  gpointer      userdata _U_
+  )
+{
+  gint64        pa      = *(const gint64 *)a;
+  gint64        pb      = *(const gint64 *)b;
+
+  if (pa < pb)
+  {
+    return -1;
+  }
+  return (pa > pb) ? 1 : 0;
+}
+
+static void
+followAeronFrameFree(
+  gpointer data
+  )
+{
+  follow_aeron_frame_t *framep = (follow_aeron_frame_t *)data;
+
+  g_free(framep->datap);
+  g_free(framep);
+}
+
+static gboolean
+followAeronFirst(
+  gpointer key _U_,
+  gpointer value,
+  gpointer data
+  )
+{
+  *(follow_aeron_frame_t **)data = (follow_aeron_frame_t *)value;
+  return TRUE;
+}
+
+static follow_aeron_frame_t *
+followAeronPendingFirst(
+  follow_t *fp
+  )
+{
+  follow_aeron_frame_t *framep = NULL;
+
+  g_tree_foreach(fp->pendingp, followAeronFirst, &framep);
+  return framep;
+}
+
+/* Is position the next term position to be written? Without a SETUP frame
+ * the term length isn't known, so the start of the next term also counts. */
+static gboolean
+followAeronIsNext(
+  const follow_t *fp,
+  gint64          position
+  )
+{
+  if (position == AERON_POSITION(fp, fp->termId, fp->termOffset))
+  {
+    return TRUE;
+  }
+  return (fp->termLength == 0) && (fp->termOffset != 0) &&
+         (position == AERON_POSITION(fp, fp->termId + 1, 0));
+}
+
+static void
+followAeronWrite(
+  follow_t       *fp,
+  gint64          position,
+  guint32         frameLength,
+  gboolean        pad,
+  const guint8   *datap,
+  guint32         dataLength,
+  guint32         packetNum
+  )
+{
+  tcp_stream_chunk  sc;
+  size_t            size;
+
+  if (dataLength > 0)
+  {
+    if (fp->mode == mode_FILE)
+    {
+      size = fwrite(datap, 1, dataLength, fp->outFilep);
+      if (dataLength != size)
+      {
+        followExit("Error writing term data.");
+      }
+    }
+    else
+    {
+      memcpy(sc.src_addr, fp->addr[0].data, fp->addr[0].len);
+      sc.src_port   = fp->port[0];
+      sc.dlen       = dataLength;
+      sc.packet_num = packetNum;
+
+      size = fwrite(&sc, 1, sizeof sc, fp->filep);
+      if (sizeof sc != size)
+      {
+        followExit("Error writing stream chunk header.");
+      }
+
+      size = fwrite(datap, 1, dataLength, fp->filep);
+      if (dataLength != size)
+      {
+        followExit("Error writing stream chunk data.");
+      }
+    }
+    fp->bytesWritten += dataLength;
+  }
+
+  /* Padding fills the rest of the term */
+  fp->termId     = AERON_POSITION_TERM_ID(fp, position);
+  fp->termOffset = AERON_POSITION_TERM_OFFSET(position) + AERON_ALIGN(frameLength);
+  if (pad || (fp->termLength != 0 && fp->termOffset >= fp->termLength))
+  {
+    fp->termId++;
+    fp->termOffset = 0;
+  }
+}
+
+/* Write out the pending frames which have become contiguous */
+static void
+followAeronDrain(
+  follow_t *fp
+  )
+{
+  follow_aeron_frame_t *framep;
+
+  while ((framep = followAeronPendingFirst(fp)) != NULL)
+  {
+    if (framep->position < AERON_POSITION(fp, fp->termId, fp->termOffset))
+    {
+      fp->duplicates++;
+    }
+    else if (followAeronIsNext(fp, framep->position))
+    {
+      followAeronWrite(fp, framep->position, framep->frameLength, framep->pad,
+                       framep->datap, framep->dataLength, framep->packetNum);
+    }
+    else
+    {
+      break;
+    }
+    fp->pendingBytes -= framep->dataLength;
+    g_tree_remove(fp->pendingp, &framep->position);
+  }
+}
+
+/* Give up on the gap before the first pending frame */
+static void
+followAeronSkip(
+  follow_t *fp
+  )
+{
+  follow_aeron_frame_t *framep = followAeronPendingFirst(fp);
+  guint32               termId;
+  guint32               termOffset;
+
+  if (framep == NULL)
+  {
+    return;
+  }
+
+  termId     = AERON_POSITION_TERM_ID(fp, framep->position);
+  termOffset = AERON_POSITION_TERM_OFFSET(framep->position);
+  fp->gaps++;
+  if (termId == fp->termId)
+  {
+    fp->gapBytes += termOffset - fp->termOffset;
+  }
+  else if (fp->termLength != 0)
+  {
+    fp->gapBytes += (fp->termLength - fp->termOffset) +
+                    (guint64)(termId - fp->termId - 1) * fp->termLength +
+                    termOffset;
+  }
+  fp->termId     = termId;
+  fp->termOffset = termOffset;
+  followAeronDrain(fp);
+}
+
+static int
+followAeronPacket(
+  void           *contextp,
+  packet_info    *pip,
+  epan_dissect_t *edp _U_,
+  const void     *datap
+  )
+{
+  follow_t                  *fp   = (follow_t *)contextp;
+  const aeron_follow_info_t *ip   = (const aeron_follow_info_t *)datap;
+  follow_aeron_frame_t      *framep;
+  gint64                     position;
+  guint32                    dataLength;
+
+  if (ip->session_id != fp->session || ip->stream_id != fp->stream)
+  {
+    return 0;
+  }
+
+  if (ip->type == HDR_TYPE_SETUP)
+  {
+    fp->termLength = ip->term_length;
+    return 0;
+  }
+
+  dataLength = (ip->data != NULL) ? tvb_captured_length(ip->data) : 0;
+
+  if (!fp->started)
+  {
+    /* The stream starts with the first data in the capture */
+    memcpy(fp->addrBuf[0], pip->net_src.data, pip->net_src.len);
+    SET_ADDRESS(&fp->addr[0], pip->net_src.type, pip->net_src.len,
+                fp->addrBuf[0]);
+    fp->port[0] = pip->srcport;
+
+    memcpy(fp->addrBuf[1], pip->net_dst.data, pip->net_dst.len);
+    SET_ADDRESS(&fp->addr[1], pip->net_dst.type, pip->net_dst.len,
+                fp->addrBuf[1]);
+    fp->port[1] = pip->destport;
+
+    fp->baseTermId = ip->term_id;
+    fp->termId     = ip->term_id;
+    fp->termOffset = ip->term_offset;
+    fp->started    = TRUE;
+  }
+
+  position = AERON_POSITION(fp, ip->term_id, ip->term_offset);
+  if (ip->duplicate || position < AERON_POSITION(fp, fp->termId, fp->termOffset))
+  {
+    /* Retransmission of data already written */
+    fp->duplicates++;
+    return 0;
+  }
+
+  if (followAeronIsNext(fp, position))
+  {
+    followAeronWrite(fp, position, ip->frame_length, ip->type == HDR_TYPE_PAD,
+                     dataLength > 0 ? tvb_get_ptr(ip->data, 0, dataLength) : NULL,
+                     dataLength, pip->fd->num);
+    followAeronDrain(fp);
+    return 0;
+  }
+
+  /* Ahead of a gap; hold on to it until the gap is filled */
+  if (g_tree_lookup(fp->pendingp, &position) != NULL)
+  {
+    fp->duplicates++;
+    return 0;
+  }
+  framep = g_new(follow_aeron_frame_t, 1);
+  framep->position    = position;
+  framep->frameLength = ip->frame_length;
+  framep->dataLength  = dataLength;
+  framep->packetNum   = pip->fd->num;
+  framep->pad         = (ip->type == HDR_TYPE_PAD);
+  framep->datap       = dataLength > 0 ? (guint8 *)tvb_memdup(NULL, ip->data, 0, dataLength) : NULL;
+  g_tree_insert(fp->pendingp, &framep->position, framep);
+  fp->pendingBytes += dataLength;
+
+  while (fp->pendingBytes > AERON_PENDING_MAX)
+  {
+    followAeronSkip(fp);
+  }
+
+  return 0;
+}
+
 #define BYTES_PER_LINE  16
 #define OFFSET_START    0
 #define OFFSET_LEN      8
@@ -516,6 +862,35 @@ followDraw(
 
   g_assert(sizeof bin % BYTES_PER_LINE == 0);
 
+  if (fp->type == type_AERON)
+  {
+    /* Write out whatever is left after the last gap */
+    while (g_tree_nnodes(fp->pendingp) > 0)
+    {
+      followAeronSkip(fp);
+    }
+  }
+
+  if (fp->mode == mode_FILE)
+  {
+    printf("\n%s", separator);
+    printf("Follow: %s,%s\n", followStrType(fp), followStrMode(fp));
+    printf("Filter: %s\n", followStrFilter(fp));
+    printf("File: %s\n", fp->outFilenamep);
+    printf("Bytes written: %" G_GINT64_MODIFIER "u\n", fp->bytesWritten);
+    printf("Duplicate frames skipped: %u\n", fp->duplicates);
+    printf("Gaps: %u (%" G_GINT64_MODIFIER "u bytes missing)\n", fp->gaps, fp->gapBytes);
+    printf("%s", separator);
+
+    if (fclose(fp->outFilep) != 0)
+    {
+      fp->outFilep = NULL;
+      followExit("Error closing output file.");
+    }
+    fp->outFilep = NULL;
+    return;
+  }
+
   if ((fp->type == type_TCP) || (fp->type == type_UDP))
   {
     static const guint8 ip_zero[MAX_IPADDR_LEN] = {0};
@@ -604,6 +979,12 @@ followDraw(
     }
   }
 
+  if (fp->type == type_AERON)
+  {
+    printf("Duplicate frames skipped: %u, gaps: %u (%" G_GINT64_MODIFIER "u bytes missing)\n",
+           fp->duplicates, fp->gaps, fp->gapBytes);
+  }
+
   offset[0] = offset[1] = 0;
 
   while (chunk <= fp->chunkMax)
@@ -641,6 +1022,9 @@ followDraw(
           putchar('\t');
         }
         break;
+
+      case mode_FILE:
+        break;
       }
 
       while (sc.dlen > 0)
@@ -692,6 +1076,10 @@ followDraw(
           }
           data[jj] = 0;
           printf("%s", data);
+          break;
+
+        case mode_FILE:
+          break;
         }
 
         offset[node] += len;
@@ -756,6 +1144,10 @@ followArgMode(
   {
     fp->mode = mode_RAW;
   }
+  else if (fp->type == type_AERON && followArgStrncmp(opt_argp, STR_FILE))
+  {
+    fp->mode = mode_FILE;
+  }
   else
   {
     followExit("Invalid display mode.");
@@ -860,6 +1252,47 @@ followArgRange(
   }
 }
 
+static void
+followArgAeron(
+  const char **opt_argp,
+  follow_t    *fp
+  )
+{
+  char         *endp;
+
+  if (**opt_argp != ',')
+  {
+    followExit("Missing session ID.");
+  }
+  fp->session = (guint32)strtoul(*opt_argp + 1, &endp, 0);
+  if (endp == *opt_argp + 1 || *endp != ',')
+  {
+    followExit("Invalid session ID.");
+  }
+  *opt_argp = endp;
+
+  fp->stream = (guint32)strtoul(*opt_argp + 1, &endp, 0);
+  if (endp == *opt_argp + 1 || (*endp != 0 && *endp != ','))
+  {
+    followExit("Invalid stream ID.");
+  }
+  *opt_argp = endp;
+}
+
+static void
+followArgFile(
+  const char **opt_argp,
+  follow_t    *fp
+  )
+{
+  if (**opt_argp != ',' || (*opt_argp)[1] == 0)
+  {
+    followExit("Missing output file name.");
+  }
+  fp->outFilenamep = g_strdup(*opt_argp + 1);
+  *opt_argp += strlen(*opt_argp);
+}
+
 static void
 followArgDone(
   const char *opt_argp
@@ -1001,6 +1434,59 @@ followSsl(
   }
 }
 
+static void
+followAeron(
+  const char *opt_argp,
+  void       *userdata _U_
+  )
+{
+  follow_t *fp;
+  GString  *errp;
+
+  opt_argp += strlen(STR_FOLLOW_AERON);
+
+  fp = followAlloc(type_AERON);
+
+  followArgMode(&opt_argp, fp);
+  followArgAeron(&opt_argp, fp);
+  if (fp->mode == mode_FILE)
+  {
+    followArgFile(&opt_argp, fp);
+  }
+  else
+  {
+    followArgRange(&opt_argp, fp);
+  }
+  followArgDone(opt_argp);
+
+  fp->pendingp = g_tree_new_full(followAeronCompare, NULL, NULL,
+                                 followAeronFrameFree);
+
+  if (fp->mode == mode_FILE)
+  {
+    fp->outFilep = ws_fopen(fp->outFilenamep, "wb");
+    if (fp->outFilep == NULL)
+    {
+      followExit("Error opening output file.");
+    }
+  }
+  else
+  {
+    followFileOpen(fp);
+  }
+
+  /* The session and stream are matched by the listener itself, so that no
+   * filter (and so no protocol tree) is needed. */
+  errp = register_tap_listener("aeron_follow", fp, NULL, TL_REQUIRES_NOTHING,
+                               NULL, followAeronPacket, followDraw);
+  if (errp != NULL)
+  {
+    followFree(fp);
+    g_string_free(errp, TRUE);
+    followExit("Error registering Aeron tap listener.");
+  }
+}
+
 static stat_tap_ui followTcp_ui = {
   REGISTER_STAT_GROUP_GENERIC,
   NULL,
@@ -1028,12 +1514,22 @@ static stat_tap_ui followSsl_ui = {
   NULL
 };
 
+static stat_tap_ui followAeron_ui = {
+  REGISTER_STAT_GROUP_GENERIC,
+  NULL,
+  STR_FOLLOW_AERON,
+  followAeron,
+  0,
+  NULL
+};
+
 void
 register_tap_listener_follow(void)
 {
   register_stat_tap_ui(&followTcp_ui, NULL);
   register_stat_tap_ui(&followUdp_ui, NULL);
   register_stat_tap_ui(&followSsl_ui, NULL);
+  register_stat_tap_ui(&followAeron_ui, NULL);
 }
 
 /*
@@ -206,6 +206,7 @@ HEADERS_WS_C  = \
 
 FORMS += \
     about_dialog.ui \
+    aeron_events_dialog.ui \
     bluetooth_att_server_attributes_dialog.ui \
     capture_file_properties_dialog.ui \
     capture_interfaces_dialog.ui \
@@ -265,6 +266,7 @@ FORMS += \
 HEADERS += $$HEADERS_WS_C \
     about_dialog.h \
     accordion_frame.h \
+    aeron_events_dialog.h \
     bluetooth_att_server_attributes_dialog.h \
     capture_file_properties_dialog.h \
     capture_interfaces_dialog.h \
@@ -605,6 +607,7 @@ HEADERS += \
 SOURCES += \
     about_dialog.cpp \
     accordion_frame.cpp \
+    aeron_events_dialog.cpp \
     bluetooth_att_server_attributes_dialog.cpp \
     byte_view_tab.cpp \
     byte_view_text.cpp \
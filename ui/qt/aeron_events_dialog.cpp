@@ -0,0 +1,399 @@
+/* aeron_events_dialog.cpp
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Adapted from lbm_stream_dialog.cpp
+
+#include "aeron_events_dialog.h"
+#include "ui_aeron_events_dialog.h"
+
+#include "file.h"
+
+#include "qt_ui_utils.h"
+#include "wireshark_application.h"
+
+#include <QMap>
+#include <QMessageBox>
+#include <QTreeWidget>
+#include <QVector>
+#include <epan/packet_info.h>
+#include <epan/to_str.h>
+#include <epan/tap.h>
+#include <plugins/aeron/packet-aeron.h>
+
+namespace
+{
+    static const int Stream_Column = 0;
+    static const int Transport_Column = 1;
+    static const int FirstEvent_Column = 2;
+
+    // The stream analysis flags counted, in the column order of the .ui file
+    static const guint32 Event_Flag[] =
+    {
+        AERON_STREAM_ANALYSIS_FLAGS_WINDOW_FULL,
+        AERON_STREAM_ANALYSIS_FLAGS_IDLE_RX,
+        AERON_STREAM_ANALYSIS_FLAGS_PACING_RX,
+        AERON_STREAM_ANALYSIS_FLAGS_RX,
+        AERON_STREAM_ANALYSIS_FLAGS_OOO,
+        AERON_STREAM_ANALYSIS_FLAGS_OOO_GAP,
+        AERON_STREAM_ANALYSIS_FLAGS_KEEPALIVE,
+        AERON_STREAM_ANALYSIS_FLAGS_OOO_SM,
+        AERON_STREAM_ANALYSIS_FLAGS_KEEPALIVE_SM,
+        AERON_STREAM_ANALYSIS_FLAGS_WINDOW_RESIZE,
+        AERON_STREAM_ANALYSIS_FLAGS_TERM_ID_CHANGE
+    };
+    static const int Event_Count = (int)(sizeof(Event_Flag) / sizeof(Event_Flag[0]));
+}
+
+typedef QVector<guint32> AeronEventsCounts;
+typedef QMap<guint32, AeronEventsCounts> AeronEventsIntervalMap;
+typedef QMap<guint32, AeronEventsCounts>::const_iterator AeronEventsIntervalMapIterator;
+
+class AeronEventsStreamEntry
+{
+    public:
+        AeronEventsStreamEntry(const aeron_tap_info_t * tapinfo);
+        ~AeronEventsStreamEntry(void);
+        void processPacket(const aeron_tap_info_t * tapinfo, gboolean interval_valid, guint32 interval);
+        QTreeWidgetItem * createItem(guint64 interval_usec) const;
+
+    private:
+        AeronEventsStreamEntry(void) { }
+        static void fillCounts(QTreeWidgetItem * item, const AeronEventsCounts & counts);
+        guint64 m_channel_id;
+        guint32 m_session_id;
+        guint32 m_stream_id;
+        QString m_transport;
+        AeronEventsCounts m_total;
+        AeronEventsIntervalMap m_interval;
+};
+
+AeronEventsStreamEntry::AeronEventsStreamEntry(const aeron_tap_info_t * tapinfo) :
+    m_channel_id(tapinfo->channel_id),
+    m_session_id(tapinfo->session_id),
+    m_stream_id(tapinfo->stream_id),
+    m_total(Event_Count, 0),
+    m_interval()
+{
+    m_transport = QString("%1:%2-%3:%4")
+        .arg(address_to_qstring(tapinfo->addr1))
+        .arg(tapinfo->port1)
+        .arg(address_to_qstring(tapinfo->addr2))
+        .arg(tapinfo->port2);
+}
+
+AeronEventsStreamEntry::~AeronEventsStreamEntry(void)
+{
+}
+
+void AeronEventsStreamEntry::processPacket(const aeron_tap_info_t * tapinfo, gboolean interval_valid, guint32 interval)
+{
+    AeronEventsCounts * counts = NULL;
+
+    if (interval_valid)
+    {
+        AeronEventsIntervalMap::iterator it = m_interval.find(interval);
+
+        if (m_interval.end() == it)
+        {
+            it = m_interval.insert(interval, AeronEventsCounts(Event_Count, 0));
+        }
+        counts = &(it.value());
+    }
+    for (int idx = 0; idx < Event_Count; idx++)
+    {
+        if ((tapinfo->stream_analysis_flags & Event_Flag[idx]) != 0)
+        {
+            m_total[idx]++;
+            if (counts != NULL)
+            {
+                (*counts)[idx]++;
+            }
+        }
+    }
+}
+
+void AeronEventsStreamEntry::fillCounts(QTreeWidgetItem * item, const AeronEventsCounts & counts)
+{
+    for (int idx = 0; idx < Event_Count; idx++)
+    {
+        item->setData(FirstEvent_Column + idx, Qt::DisplayRole, QVariant((uint)counts[idx]));
+    }
+}
+
+QTreeWidgetItem * AeronEventsStreamEntry::createItem(guint64 interval_usec) const
+{
+    QTreeWidgetItem * item = new QTreeWidgetItem();
+    AeronEventsIntervalMapIterator it;
+
+    item->setText(Stream_Column, QString("%1 / 0x%2 / 0x%3")
+        .arg(m_channel_id)
+        .arg(m_session_id, 8, 16, QChar('0'))
+        .arg(m_stream_id, 8, 16, QChar('0')));
+    item->setText(Transport_Column, m_transport);
+    fillCounts(item, m_total);
+    for (it = m_interval.constBegin(); it != m_interval.constEnd(); it++)
+    {
+        QTreeWidgetItem * child = new QTreeWidgetItem();
+        double start = ((double)it.key() * (double)interval_usec) / 1000000.0;
+        double end = start + ((double)interval_usec / 1000000.0);
+
+        child->setText(Stream_Column, QString("%1 - %2").arg(start, 0, 'f', 3).arg(end, 0, 'f', 3));
+        fillCounts(child, it.value());
+        item->addChild(child);
+    }
+    return (item);
+}
+
+typedef QMap<guint64, AeronEventsStreamEntry *> AeronEventsStreamMap;
+typedef QMap<guint64, AeronEventsStreamEntry *>::iterator AeronEventsStreamMapIterator;
+
+class AeronEventsDialogInfo
+{
+    public:
+        AeronEventsDialogInfo(void);
+        ~AeronEventsDialogInfo(void);
+        void setDialog(AeronEventsDialog * dialog);
+        AeronEventsDialog * getDialog(void);
+        void setInterval(guint64 interval_usec);
+        void processPacket(const packet_info * pinfo, const aeron_tap_info_t * tapinfo);
+        void resetStreams(void);
+        void fillTree(QTreeWidget * tree);
+
+    private:
+        AeronEventsDialog * m_dialog;
+        guint64 m_interval_usec;
+        AeronEventsStreamMap m_streams;
+};
+
+AeronEventsDialogInfo::AeronEventsDialogInfo(void) :
+    m_dialog(NULL),
+    m_interval_usec(0),
+    m_streams()
+{
+}
+
+AeronEventsDialogInfo::~AeronEventsDialogInfo(void)
+{
+    resetStreams();
+}
+
+void AeronEventsDialogInfo::setDialog(AeronEventsDialog * dialog)
+{
+    m_dialog = dialog;
+}
+
+AeronEventsDialog * AeronEventsDialogInfo::getDialog(void)
+{
+    return (m_dialog);
+}
+
+void AeronEventsDialogInfo::setInterval(guint64 interval_usec)
+{
+    m_interval_usec = interval_usec;
+}
+
+void AeronEventsDialogInfo::processPacket(const packet_info * pinfo, const aeron_tap_info_t * tapinfo)
+{
+    AeronEventsStreamEntry * stream = NULL;
+    AeronEventsStreamMapIterator it;
+    guint64 key = (tapinfo->channel_id << 32) | (guint64)tapinfo->stream_id;
+    gboolean interval_valid = FALSE;
+    guint32 interval = 0;
+
+    if (tapinfo->stream_analysis_flags == 0)
+    {
+        return;
+    }
+    it = m_streams.find(key);
+    if (m_streams.end() == it)
+    {
+        stream = new AeronEventsStreamEntry(tapinfo);
+        m_streams.insert(key, stream);
+    }
+    else
+    {
+        stream = it.value();
+    }
+    if ((m_interval_usec > 0) && (pinfo->rel_ts.secs >= 0))
+    {
+        guint64 relative_time = ((guint64)pinfo->rel_ts.secs * G_GUINT64_CONSTANT(1000000)) +
+                                ((guint64)((pinfo->rel_ts.nsecs + 500) / 1000));
+
+        interval = (guint32)(relative_time / m_interval_usec);
+        interval_valid = TRUE;
+    }
+    stream->processPacket(tapinfo, interval_valid, interval);
+}
+
+void AeronEventsDialogInfo::resetStreams(void)
+{
+    AeronEventsStreamMapIterator it = m_streams.begin();
+
+    while (it != m_streams.end())
+    {
+        delete *it;
+        it++;
+    }
+    m_streams.clear();
+}
+
+void AeronEventsDialogInfo::fillTree(QTreeWidget * tree)
+{
+    AeronEventsStreamMapIterator it;
+
+    // The items are only built once the retap is done, rather than updated for every packet.
+    tree->clear();
+    for (it = m_streams.begin(); it != m_streams.end(); it++)
+    {
+        tree->addTopLevelItem((*it)->createItem(m_interval_usec));
+    }
+    for (int column = 0; column < tree->columnCount(); column++)
+    {
+        tree->resizeColumnToContents(column);
+    }
+}
+
+AeronEventsDialog::AeronEventsDialog(QWidget * parent, capture_file * cfile) :
+    QDialog(parent),
+    m_ui(new Ui::AeronEventsDialog),
+    m_dialog_info(NULL),
+    m_capture_file(cfile)
+{
+    m_ui->setupUi(this);
+    m_dialog_info = new AeronEventsDialogInfo();
+    connect(this, SIGNAL(accepted()), this, SLOT(closeDialog()));
+    connect(this, SIGNAL(rejected()), this, SLOT(closeDialog()));
+    fillTree();
+}
+
+AeronEventsDialog::~AeronEventsDialog(void)
+{
+    delete m_ui;
+    if (m_dialog_info != NULL)
+    {
+        delete m_dialog_info;
+    }
+}
+
+void AeronEventsDialog::setCaptureFile(capture_file * cfile)
+{
+    if (cfile == NULL) // We only want to know when the file closes.
+    {
+        m_capture_file = NULL;
+        m_ui->displayFilterLineEdit->setEnabled(false);
+        m_ui->intervalSpinBox->setEnabled(false);
+        m_ui->applyFilterButton->setEnabled(false);
+    }
+}
+
+void AeronEventsDialog::fillTree(void)
+{
+    GString * error_string;
+    QByteArray filter = m_ui->displayFilterLineEdit->text().toUtf8();
+
+    if (m_capture_file == NULL)
+    {
+        return;
+    }
+    m_dialog_info->setDialog(this);
+    m_dialog_info->setInterval((guint64)((m_ui->intervalSpinBox->value() * 1000000.0) + 0.5));
+
+    // Without a filter the tap needs no protocol tree, so the retap only runs the Aeron analysis.
+    error_string = register_tap_listener("aeron",
+        (void *)m_dialog_info,
+        filter.isEmpty() ? NULL : filter.constData(),
+        TL_REQUIRES_NOTHING,
+        resetTap,
+        tapPacket,
+        drawTreeItems);
+    if (error_string)
+    {
+        QMessageBox::critical(this, tr("Aeron Stream Events failed to attach to tap"),
+            error_string->str);
+        g_string_free(error_string, TRUE);
+        reject();
+        return;
+    }
+
+    cf_retap_packets(m_capture_file);
+    drawTreeItems((void *)m_dialog_info);
+    remove_tap_listener((void *)m_dialog_info);
+}
+
+void AeronEventsDialog::resetTap(void * tap_data)
+{
+    AeronEventsDialogInfo * info = (AeronEventsDialogInfo *)tap_data;
+    AeronEventsDialog * dialog = info->getDialog();
+    if (dialog == NULL)
+    {
+        return;
+    }
+    info->resetStreams();
+    dialog->m_ui->aeron_events_TreeWidget->clear();
+}
+
+gboolean AeronEventsDialog::tapPacket(void * tap_data, packet_info * pinfo, epan_dissect_t * edt, const void * tap_info)
+{
+    Q_UNUSED(edt)
+
+    if (pinfo->fd->flags.passed_dfilter == 1)
+    {
+        const aeron_tap_info_t * tapinfo = (const aeron_tap_info_t *)tap_info;
+        AeronEventsDialogInfo * info = (AeronEventsDialogInfo *)tap_data;
+
+        info->processPacket(pinfo, tapinfo);
+    }
+    return (TRUE);
+}
+
+void AeronEventsDialog::drawTreeItems(void * tap_data)
+{
+    AeronEventsDialogInfo * info = (AeronEventsDialogInfo *)tap_data;
+    AeronEventsDialog * dialog = info->getDialog();
+    if (dialog == NULL)
+    {
+        return;
+    }
+    info->fillTree(dialog->m_ui->aeron_events_TreeWidget);
+}
+
+void AeronEventsDialog::on_applyFilterButton_clicked(void)
+{
+    fillTree();
+}
+
+void AeronEventsDialog::closeDialog(void)
+{
+    delete this;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 4
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=4 expandtab:
+ * :indentSize=4:tabSize=4:noTabs=true:
+ */
@@ -436,6 +436,7 @@ private slots:
     void on_actionStatistics29WestUIM_Stream_Flow_Graph_triggered();
     void on_actionStatistics29WestLBTRM_triggered();
     void on_actionStatistics29WestLBTRU_triggered();
+    void on_actionStatisticsAeronEvents_triggered();
     void on_actionStatisticsANCP_triggered();
     void on_actionStatisticsBACappInstanceId_triggered();
     void on_actionStatisticsBACappIP_triggered();
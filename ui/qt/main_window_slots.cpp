@@ -73,6 +73,7 @@
 #endif
 
 #include "about_dialog.h"
+#include "aeron_events_dialog.h"
 #include "bluetooth_att_server_attributes_dialog.h"
 #include "capture_file_dialog.h"
 #include "capture_file_properties_dialog.h"
@@ -2465,6 +2466,14 @@ void MainWindow::on_actionStatistics29WestLBTRU_triggered()
     lbtru_dialog->show();
 }
 
+void MainWindow::on_actionStatisticsAeronEvents_triggered()
+{
+    AeronEventsDialog * events_dialog = new AeronEventsDialog(this, capture_file_.capFile());
+    connect(this, SIGNAL(setCaptureFile(capture_file*)),
+            events_dialog, SLOT(setCaptureFile(capture_file*)));
+    events_dialog->show();
+}
+
 void MainWindow::on_actionStatisticsANCP_triggered()
 {
     openStatisticsTreeDialog("ancp");